@@ -2,30 +2,46 @@
 #define AABB_H
 
 // 자식 노드 또는 primitive를 감싸는 Axis-Aligned Bounding Box
-class aabb {
+// 스칼라 타입으로 매개화 (aabb = basic_aabb<double>), float 박스는 메시 BVH 노드 저장용
+template <typename T>
+class basic_aabb {
 private:
     // Quad는 한 차원의 두께가 0이 될 수 있으므로
     // 두께가 델타보다 작은 경우 padding을 추가
     void pad_to_minimums() {
-	double delta = 0.0001; // 두께 최소값
+	T delta = T(0.0001); // 두께 최소값
 	if (x.size() < delta) x = x.expand(delta);
 	if (y.size() < delta) y = y.expand(delta);
 	if (z.size() < delta) z = z.expand(delta);
     }
+
+    // 다른 정밀도의 경계값을 반드시 감싸도록 바깥쪽으로 반올림
+    template <typename U>
+    static T round_down(U v) {
+	T r = T(v);
+	return U(r) > v ? std::nextafter(r, T(-infinity)) : r;
+    }
+
+    template <typename U>
+    static T round_up(U v) {
+	T r = T(v);
+	return U(r) < v ? std::nextafter(r, T(infinity)) : r;
+    }
 public:
-    interval x, y, z; // 각 축의 interval
+    basic_interval<T> x, y, z; // 각 축의 interval
 
-    aabb() {}
+    basic_aabb() {}
 
     // 생성자 - 3개의 interval을 받음
-    aabb(const interval& x, const interval& y, const interval& z)
+    basic_aabb(const basic_interval<T>& x, const basic_interval<T>& y, const basic_interval<T>& z)
 	: x(x), y(y), z(z)
     {
 	pad_to_minimums();
     }
 
     // 생성자 - 바운딩 박스의 양 끝 점을 받아 각 축의 interval 계산
-    aabb(const point3& a, const point3& b) {
+    basic_aabb(const basic_vec3<T>& a, const basic_vec3<T>& b) {
+	typedef basic_interval<T> interval;
 	x = (a[0] < b[0]) ? interval(a[0], b[0]) : interval(b[0], a[0]);
 	y = (a[1] < b[1]) ? interval(a[1], b[1]) : interval(b[1], a[1]);
 	z = (a[2] < b[2]) ? interval(a[2], b[2]) : interval(b[2], a[2]);
@@ -34,14 +50,21 @@ public:
     }
 
     // 생성자 - 두 바운딩 박스를 모두 포함하는 새로운 바운딩 박스
-    aabb(const aabb& bbox1, const aabb& bbox2) {
-	x = interval(bbox1.x, bbox2.x);
-	y = interval(bbox1.y, bbox2.y);
-	z = interval(bbox1.z, bbox2.z);
+    basic_aabb(const basic_aabb& bbox1, const basic_aabb& bbox2) {
+	x = basic_interval<T>(bbox1.x, bbox2.x);
+	y = basic_interval<T>(bbox1.y, bbox2.y);
+	z = basic_interval<T>(bbox1.z, bbox2.z);
     }
 
+    // 다른 정밀도의 박스에서 변환 (double -> float은 원래 박스를 감싸도록 바깥쪽으로 반올림)
+    template <typename U>
+    explicit basic_aabb(const basic_aabb<U>& box)
+	: x(round_down(box.x.min), round_up(box.x.max)),
+	  y(round_down(box.y.min), round_up(box.y.max)),
+	  z(round_down(box.z.min), round_up(box.z.max)) {}
+
     // n에 따라 각 축의 interval 리턴하는 getter 함수
-    const interval& get_axis_interval(int n) const {
+    const basic_interval<T>& get_axis_interval(int n) const {
 	if (n == 2)
 	    return z;
 	else if (n == 1)
@@ -68,21 +91,23 @@ public:
     }
 
     // ray가 각 축의 slab에 모두 겹치는지 확인하는 hit 함수
-    bool hit(const ray& r, interval ray_t) const {
+    // 계산은 레이의 정밀도로 함 (float 박스도 double 레이로 검사하면 경계값만 float)
+    template <typename R>
+    bool hit(const basic_ray<R>& r, basic_interval<R> ray_t) const {
 	// 레이가 각 평면과 만나는 두 지점 t0, t1 찾기
-	double t0, t1;
-	const point3& ray_start = r.origin();
-	const vec3& ray_dir = r.direction();
+	R t0, t1;
+	const basic_vec3<R>& ray_start = r.origin();
+	const basic_vec3<R>& ray_dir = r.direction();
 
 	// x, y, z에 대해 검사
 	for (int axis = 0; axis <= 2; axis++) {
-	    const interval& axis_interval = get_axis_interval(axis);
-	    const double& ray_dir_axis_inv = 1.0 / ray_dir[axis];
+	    const basic_interval<T>& axis_interval = get_axis_interval(axis);
+	    const R ray_dir_axis_inv = R(1) / ray_dir[axis];
 
 	    // (x0 - Qx) / dx
-	    t0 = (axis_interval.min - ray_start[axis]) * ray_dir_axis_inv;
+	    t0 = (R(axis_interval.min) - ray_start[axis]) * ray_dir_axis_inv;
 	    // (x1 - Qx) / dx
-	    t1 = (axis_interval.max - ray_start[axis]) * ray_dir_axis_inv;
+	    t1 = (R(axis_interval.max) - ray_start[axis]) * ray_dir_axis_inv;
 
 	    // ray_t는 지금까지 검사해온 bbox의 t가 담겨있음
 	    // 만약 ray_t의 min보다 방금 검사한 t0가 더 크다면
@@ -108,11 +133,16 @@ public:
     }
 };
 
-aabb operator+(const aabb& bbox, const vec3& offset) {
-    return aabb(bbox.x + offset.x(), bbox.y + offset.y(), bbox.z + offset.z());
+using aabb = basic_aabb<double>;
+using aabbf = basic_aabb<float>;
+
+template <typename T>
+inline basic_aabb<T> operator+(const basic_aabb<T>& bbox, const basic_vec3<T>& offset) {
+    return basic_aabb<T>(bbox.x + offset.x(), bbox.y + offset.y(), bbox.z + offset.z());
 }
 
-aabb operator+(const vec3& offset, const aabb& bbox) {
+template <typename T>
+inline basic_aabb<T> operator+(const basic_vec3<T>& offset, const basic_aabb<T>& bbox) {
     return bbox + offset;
 }
 
@@ -0,0 +1,226 @@
+#ifndef ANIMATION_H
+#define ANIMATION_H
+
+// 키프레임 애니메이션 시퀀스 렌더
+// 카메라 위치 / 바라보는 곳, 물체 이동 / 회전 / 크기를 키프레임 사이 선형 보간으로 움직이며 N 프레임 렌더
+//
+// 월드 BVH는 한 번만 만들고 모든 프레임에서 재사용
+// -> 움직이는 물체(animated_transform)의 bbox를 모든 키프레임 사이 값을 감싸도록 잡아서
+//    어느 프레임에서도 BVH가 유효하게 함
+// 프레임 k를 파일로 쓰는 동안 프레임 k + 1을 렌더 (저장은 별도 스레드)
+
+#include <future>
+#include <string>
+#include <utility>
+
+// 시간 -> 값 키프레임 (시간순 정렬 유지)
+template <typename T>
+class keyframe_track {
+public:
+    void add(double time, const T& value) {
+	auto it = keys.begin();
+	while (it != keys.end() && it->first <= time)
+	    ++it;
+	keys.insert(it, std::make_pair(time, value));
+    }
+
+    bool empty() const { return keys.empty(); }
+
+    // 양 끝 밖에서는 첫 / 마지막 키 값 유지
+    T at(double time) const {
+	if (time <= keys.front().first)
+	    return keys.front().second;
+	if (time >= keys.back().first)
+	    return keys.back().second;
+
+	size_t i = 1;
+	while (keys[i].first < time)
+	    i++;
+	const auto& a = keys[i - 1];
+	const auto& b = keys[i];
+	double t = (time - a.first) / (b.first - a.first);
+	return (1 - t) * a.second + t * b.second;
+    }
+
+    const std::vector<std::pair<double, T>>& get_keys() const { return keys; }
+
+private:
+    std::vector<std::pair<double, T>> keys;
+};
+
+// 물체의 이동 / 회전 / 크기 키프레임 (비어 있는 트랙은 이동 0, 회전 0, 크기 1)
+// 회전은 x, y, z축 각도(도)를 그 순서로 적용하고 각도 자체를 보간하므로 0 -> 360처럼 한 바퀴 이상 도는 턴테이블도 표현 가능
+struct transform_keys {
+    keyframe_track<vec3> translation;
+    keyframe_track<vec3> rotation;
+    keyframe_track<vec3> scale;
+
+    // 물체 공간 -> 월드 공간 (크기 -> 회전 -> 이동 순서)
+    matrix4 matrix_at(double time) const {
+	matrix4 m = matrix4::identity();
+	if (!scale.empty())
+	    m = matrix4::scaling(scale.at(time));
+	if (!rotation.empty()) {
+	    vec3 degrees = rotation.at(time);
+	    m = matrix4::rotation(vec3(0, 0, 1), degrees.z()) * matrix4::rotation(vec3(0, 1, 0), degrees.y())
+		* matrix4::rotation(vec3(1, 0, 0), degrees.x()) * m;
+	}
+	if (!translation.empty())
+	    m = matrix4::translation(translation.at(time)) * m;
+	return m;
+    }
+};
+
+// 키프레임을 따라 움직이는 물체 (transform의 애니메이션 버전)
+// shutter > 0이면 레이의 시간 [0, 1]을 [frame_time, frame_time + shutter]로 매핑해서 모션 블러
+// shutter = 0이면 프레임 안에서 행렬이 같으므로 set_time()에서 한 번만 계산
+class animated_transform : public hittable {
+public:
+    animated_transform(shared_ptr<hittable> object, const transform_keys& keys, double shutter = 0)
+	: object(object), keys(keys), shutter(shutter)
+    {
+	// 보간한 값은 축마다 키 값들의 최소 ~ 최대 안에 있으므로 구간 연산으로 감쌈
+	// 회전이 없으면 축마다 [크기] * [물체 bbox] + [이동]
+	// 회전이 있으면 (크기를 바꾼) 물체를 원점 중심 구로 감싼 뒤 이동 (구는 어느 방향으로 돌려도 그대로)
+	aabb box = object->bounding_box();
+	interval range[3];
+	if (keys.rotation.empty()) {
+	    for (int axis = 0; axis < 3; axis++) {
+		interval s = key_range(keys.scale, axis, 1.0);
+		const interval& x = box.get_axis_interval(axis);
+		double a = s.min * x.min, b = s.min * x.max, c = s.max * x.min, d = s.max * x.max;
+		range[axis] = interval(std::min(std::min(a, b), std::min(c, d)), std::max(std::max(a, b), std::max(c, d)));
+	    }
+	}
+	else {
+	    double corner = 0;
+	    for (int i = 0; i < 8; i++) {
+		vec3 p((i & 1) ? box.x.max : box.x.min, (i & 2) ? box.y.max : box.y.min, (i & 4) ? box.z.max : box.z.min);
+		corner = std::max(corner, p.length());
+	    }
+	    double stretch = 0;
+	    for (int axis = 0; axis < 3; axis++) {
+		interval s = key_range(keys.scale, axis, 1.0);
+		stretch = std::max(stretch, std::max(std::fabs(s.min), std::fabs(s.max)));
+	    }
+	    for (int axis = 0; axis < 3; axis++)
+		range[axis] = interval(-corner * stretch, corner * stretch);
+	}
+	for (int axis = 0; axis < 3; axis++) {
+	    interval t = key_range(keys.translation, axis, 0.0);
+	    range[axis] = interval(range[axis].min + t.min, range[axis].max + t.max);
+	}
+	bbox = aabb(range[0], range[1], range[2]);
+
+	set_time(0);
+    }
+
+    // 렌더할 프레임의 시간 (초)
+    void set_time(double time) {
+	frame_time = time;
+	frame_m = keys.matrix_at(time);
+	frame_inv = frame_m.inverse();
+    }
+
+    bool hit(const ray& r, interval ray_t, hit_record& rec) const override {
+	if (shutter == 0)
+	    return transform::hit_transformed(*object, frame_m, frame_inv, r, ray_t, rec);
+	matrix4 m = keys.matrix_at(frame_time + r.time() * shutter);
+	return transform::hit_transformed(*object, m, m.inverse(), r, ray_t, rec);
+    }
+
+    bool occluded(const ray& r, interval ray_t) const override {
+	return object->occluded(local_ray(r), ray_t);
+    }
+
+    // 안쪽이 참여 매질이면 기본 구현(occluded -> 0 / 1) 대신 그 매질의 투과율
+    double transmittance(const ray& r, interval ray_t) const override {
+	return object->transmittance(local_ray(r), ray_t);
+    }
+
+    aabb bounding_box() const override { return bbox; }
+
+private:
+    shared_ptr<hittable> object;
+    transform_keys keys;
+    double shutter;
+    double frame_time = 0;
+    matrix4 frame_m, frame_inv; // frame_time의 행렬 (shutter = 0일 때 사용)
+    aabb bbox;
+
+    // 레이를 물체 공간으로 (충돌 지점 / 법선을 되돌릴 필요가 없는 가시성 검사용)
+    ray local_ray(const ray& r) const {
+	if (shutter == 0)
+	    return ray(frame_inv.transform_point(r.origin()), frame_inv.transform_vector(r.direction()), r.time());
+	matrix4 inv = keys.matrix_at(frame_time + r.time() * shutter).inverse();
+	return ray(inv.transform_point(r.origin()), inv.transform_vector(r.direction()), r.time());
+    }
+
+    // 트랙의 axis 성분이 가지는 최소 ~ 최대 (비어 있으면 기본값 하나)
+    static interval key_range(const keyframe_track<vec3>& track, int axis, double empty_value) {
+	if (track.empty())
+	    return interval(empty_value, empty_value);
+	interval range(infinity, -infinity);
+	for (const auto& key : track.get_keys())
+	    range = interval(std::min(range.min, key.second[axis]), std::max(range.max, key.second[axis]));
+	return range;
+    }
+};
+
+class animation {
+public:
+    // 비어 있으면 카메라 설정을 그대로 사용
+    keyframe_track<point3> lookfrom;
+    keyframe_track<point3> lookat;
+
+    std::vector<shared_ptr<animated_transform>> objects;
+
+    double fps = 24;
+    std::string frame_prefix = "frame_"; // frame_0000.ppm, frame_0001.ppm, ...
+
+    // world는 모든 프레임에서 재사용 (미리 BVH로 만들어 둘 것)
+    void render(camera& cam, const hittable& world, int frames) {
+	auto start = std::chrono::system_clock::now();
+	std::future<void> pending_write;
+
+	for (int k = 0; k < frames; k++) {
+	    double time = k / fps;
+	    if (!lookfrom.empty()) cam.lookfrom = lookfrom.at(time);
+	    if (!lookat.empty()) cam.lookat = lookat.at(time);
+	    for (auto& object : objects)
+		object->set_time(time);
+
+	    std::vector<color> image = cam.render_frame(world);
+	    std::clog << "\rFrame " << k + 1 << " / " << frames << " : "
+		<< cam.last_render_time << " s      " << std::flush;
+
+	    // 앞 프레임 저장이 끝나야 다음 저장 시작 (저장은 렌더보다 훨씬 빠름)
+	    if (pending_write.valid())
+		pending_write.wait();
+	    pending_write = std::async(std::launch::async, write_frame,
+		frame_name(k), cam.image_width, cam.get_image_height(), std::move(image));
+	}
+	if (pending_write.valid())
+	    pending_write.wait();
+
+	std::chrono::duration<double> sec = std::chrono::system_clock::now() - start;
+	std::clog << "\nFrames: " << frames << ", " << sec.count() << " s, "
+	    << (sec.count() > 0 ? frames / sec.count() * 3600.0 : 0) << " frames/hour\n";
+    }
+
+private:
+    std::string frame_name(int k) const {
+	std::string number = std::to_string(k);
+	if (number.size() < 4)
+	    number = std::string(4 - number.size(), '0') + number;
+	return frame_prefix + number + ".ppm";
+    }
+
+    static void write_frame(std::string filename, int width, int height, std::vector<color> image) {
+	std::ofstream out(filename);
+	out << "P3\n" << width << " " << height << "\n255\n";
+	write_color(image, out);
+    }
+};
+
+#endif
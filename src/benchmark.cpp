@@ -0,0 +1,1610 @@
+﻿#define _CRT_SECURE_NO_WARNINGS
+#include "rtWeekend.h"
+#include "scene_info.h"
+#include "interval.h"
+#include "aabb.h"
+#include "hittable.h"
+#include "hittable_list.h"
+#include "bvh.h"
+#include "sphere.h"
+#include "sphere_group.h"
+#include "volume.h"
+#include "triangle.h"
+#include "compressed_mesh.h"
+#include "polygon_mesh.h"
+#include "mesh_simplify.h"
+#include "quad.h"
+#include "image_opener.h"
+#include "camera.h"
+#include "render_session.h"
+#include "material.h"
+#include "texture.h"
+
+#include <string>
+#include <cstring>
+#include <functional>
+
+// 교차 커널과 BVH 빌드/순회 마이크로벤치마크
+// 사용법: benchmark [--format csv|json] [--out 파일] [--res 리소스 경로]
+//                   [--seed N] [--min-time 초] [--repeats N] [--rays N]
+// 결과는 CSV(기본) 또는 JSON으로 출력해 실행 결과끼리 비교할 수 있게 함
+
+// 벤치마크 결과 한 줄
+struct bench_result {
+    std::string name;       // 벤치마크 이름
+    size_t primitives = 0;  // primitive(삼각형, 구 등) 개수
+    double build_ms = 0;    // BVH 빌드 시간 (빌드가 없으면 0)
+    double ns_per_op = 0;   // 레이 1개당 시간 (반복 측정의 median)
+    double mops_per_sec = 0; // 초당 처리한 레이 수 (백만 단위)
+    double hit_rate = 0;    // 충돌한 레이 비율
+    double bytes_per_primitive = 0; // 가속 구조 + 기하 데이터 메모리 / primitive (측정하지 않으면 0)
+    double rmse = 0;        // 기준 이미지와의 선형 RMSE (수렴 벤치마크만)
+    double render_ms = 0;   // 이미지 렌더 시간 (렌더 벤치마크만)
+    int tiles_total = 0;    // 이미지의 타일 수 (타일 렌더 벤치마크만)
+    int tiles_rendered = 0; // 그중 렌더한 타일 수
+    double spp = 0;         // 픽셀당 샘플 수 (수렴 벤치마크만, equal_error 줄은 보간한 값)
+};
+
+struct bench_options {
+    std::string format = "csv";
+    std::string out_path;       // 비어 있으면 stdout
+    std::string res_dir = "../res/";
+    unsigned int seed = 1;      // 레이, 씬 생성용 시드 -> 실행마다 같은 입력
+    double min_time = 0.2;      // 반복 1회당 최소 측정 시간 (초)
+    int repeats = 5;            // 반복 측정 횟수
+    size_t ray_count = 1 << 14; // 측정에 사용할 레이 개수
+};
+
+// 측정 루프가 최적화로 사라지지 않도록 결과를 모아두는 변수
+static volatile size_t bench_sink = 0;
+
+using bench_clock = std::chrono::steady_clock;
+
+static double elapsed_seconds(bench_clock::time_point start) {
+    return std::chrono::duration<double>(bench_clock::now() - start).count();
+}
+
+static double median(std::vector<double> values) {
+    std::sort(values.begin(), values.end());
+    size_t n = values.size();
+    if (n == 0) return 0;
+    return (n % 2 == 1) ? values[n / 2] : 0.5 * (values[n / 2 - 1] + values[n / 2]);
+}
+
+// target bbox 바깥의 구면에서 bbox 내부의 랜덤한 점을 향하는 레이 생성
+static std::vector<ray> make_rays(const aabb& target, size_t count, bool moving = false) {
+    point3 center(
+	0.5 * (target.x.min + target.x.max),
+	0.5 * (target.y.min + target.y.max),
+	0.5 * (target.z.min + target.z.max)
+    );
+    double radius = 1.5 * vec3(target.x.size(), target.y.size(), target.z.size()).length();
+
+    std::vector<ray> rays;
+    rays.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+	point3 origin = center + radius * random_unit_vector();
+	point3 aim(
+	    random_double(target.x.min, target.x.max),
+	    random_double(target.y.min, target.y.max),
+	    random_double(target.z.min, target.z.max)
+	);
+	rays.push_back(ray(origin, aim - origin, moving ? random_double() : 0.0));
+    }
+    return rays;
+}
+
+// rays 전체에 대해 f(ray)를 min_time 이상 반복 호출해 레이 1개당 시간 측정
+// f는 충돌 여부(bool)를 리턴
+template <typename F>
+static void measure_rays(const std::vector<ray>& rays, F&& f, const bench_options& opt,
+    bench_result& result)
+{
+    // warm-up 겸 충돌 비율 계산
+    size_t hits = 0;
+    for (const auto& r : rays)
+	hits += f(r) ? 1 : 0;
+    result.hit_rate = double(hits) / rays.size();
+
+    std::vector<double> samples;
+    for (int rep = 0; rep < opt.repeats; rep++) {
+	size_t ops = 0;
+	size_t local_hits = 0;
+	double elapsed = 0;
+	auto start = bench_clock::now();
+	do {
+	    for (const auto& r : rays)
+		local_hits += f(r) ? 1 : 0;
+	    ops += rays.size();
+	    elapsed = elapsed_seconds(start);
+	} while (elapsed < opt.min_time);
+	bench_sink = bench_sink + local_hits;
+	samples.push_back(elapsed * 1e9 / ops);
+    }
+
+    result.ns_per_op = median(samples);
+    result.mops_per_sec = 1e3 / result.ns_per_op;
+}
+
+// build()를 repeats번 실행해 빌드 시간(ms)의 median 리턴
+template <typename F>
+static double measure_build(F&& build, const bench_options& opt) {
+    std::vector<double> samples;
+    for (int rep = 0; rep < opt.repeats; rep++) {
+	auto start = bench_clock::now();
+	build();
+	samples.push_back(elapsed_seconds(start) * 1e3);
+    }
+    return median(samples);
+}
+
+// ---------------------------------------------------------------------
+// 개별 primitive 교차 커널
+
+static void bench_primitives(const bench_options& opt, std::vector<bench_result>& results) {
+    auto mat = make_shared<lambertian>(color(0.5, 0.5, 0.5));
+    interval ray_t(0.0001, infinity);
+
+    // aabb::hit
+    {
+	aabb box(point3(-1, -1, -1), point3(1, 1, 1));
+	auto rays = make_rays(aabb(point3(-2, -2, -2), point3(2, 2, 2)), opt.ray_count);
+	bench_result result;
+	result.name = "aabb_hit";
+	result.primitives = 1;
+	measure_rays(rays, [&](const ray& r) { return box.hit(r, ray_t); }, opt, result);
+	results.push_back(result);
+    }
+
+    // sphere::hit (정적인 구)
+    {
+	sphere s(point3(0, 0, 0), 1.0, mat);
+	auto rays = make_rays(aabb(point3(-2, -2, -2), point3(2, 2, 2)), opt.ray_count);
+	bench_result result;
+	result.name = "sphere_hit";
+	result.primitives = 1;
+	hit_record rec;
+	measure_rays(rays, [&](const ray& r) { return s.hit(r, ray_t, rec); }, opt, result);
+	results.push_back(result);
+    }
+
+    // sphere::hit (움직이는 구)
+    {
+	sphere s(point3(-0.5, 0, 0), point3(0.5, 0, 0), 1.0, mat);
+	auto rays = make_rays(aabb(point3(-2, -2, -2), point3(2, 2, 2)), opt.ray_count, true);
+	bench_result result;
+	result.name = "sphere_moving_hit";
+	result.primitives = 1;
+	hit_record rec;
+	measure_rays(rays, [&](const ray& r) { return s.hit(r, ray_t, rec); }, opt, result);
+	results.push_back(result);
+    }
+
+    // quad::hit
+    {
+	quad q(point3(-1, -1, 0), vec3(2, 0, 0), vec3(0, 2, 0), mat);
+	auto rays = make_rays(aabb(point3(-2, -2, -2), point3(2, 2, 2)), opt.ray_count);
+	bench_result result;
+	result.name = "quad_hit";
+	result.primitives = 1;
+	hit_record rec;
+	measure_rays(rays, [&](const ray& r) { return q.hit(r, ray_t, rec); }, opt, result);
+	results.push_back(result);
+    }
+
+    // triangle::hit
+    {
+	triangle tri(point3(-1, -1, 0), point3(1, -1, 0), point3(0, 1, 0), mat);
+	auto rays = make_rays(aabb(point3(-2, -2, -2), point3(2, 2, 2)), opt.ray_count);
+	bench_result result;
+	result.name = "triangle_hit";
+	result.primitives = 1;
+	hit_record rec;
+	measure_rays(rays, [&](const ray& r) { return tri.hit(r, ray_t, rec); }, opt, result);
+	results.push_back(result);
+    }
+}
+
+// ---------------------------------------------------------------------
+// bvh_node: 랜덤한 구 N개로 빌드 & 순회
+
+static void bench_bvh_spheres(const bench_options& opt, std::vector<bench_result>& results) {
+    auto mat = make_shared<lambertian>(color(0.5, 0.5, 0.5));
+    interval ray_t(0.0001, infinity);
+
+    for (size_t count : { size_t(1000), size_t(10000), size_t(100000) }) {
+	std::clog << "bvh_node spheres: " << count << "\n";
+
+	// 구가 많아져도 밀도가 비슷하도록 공간 크기를 조절
+	double extent = 10.0 * std::cbrt(count / 1000.0);
+	hittable_list list;
+	for (size_t i = 0; i < count; i++) {
+	    point3 center = vec3::random(-extent, extent);
+	    list.add(make_shared<sphere>(center, random_double(0.05, 0.2), mat));
+	}
+
+	bench_result result;
+	result.name = "bvh_node_spheres";
+	result.primitives = count;
+
+	shared_ptr<bvh_node> root;
+	result.build_ms = measure_build([&]() { root = make_shared<bvh_node>(list); }, opt);
+
+	auto rays = make_rays(root->bounding_box(), opt.ray_count);
+	hit_record rec;
+	measure_rays(rays, [&](const ray& r) { return root->hit(r, ray_t, rec); }, opt, result);
+	results.push_back(result);
+
+	// 같은 구와 BVH 노드를 scene_arena에서 할당 (객체 + control block이 연속)
+	// arena는 해제하지 않으므로 빌드를 반복하면 계속 커짐 -> 메모리는 첫 빌드 직후 값으로 계산
+	{
+	    scene_arena arena;
+	    arena_scope scope(arena);
+	    hittable_list arena_list;
+	    for (const auto& object : list.objects)
+		arena_list.add(arena_make_shared<sphere>(*std::static_pointer_cast<sphere>(object)));
+
+	    shared_ptr<bvh_node> arena_root = arena_make_shared<bvh_node>(arena_list);
+	    size_t arena_bytes = arena.get_bytes_allocated();
+	    size_t arena_allocations = arena.get_allocation_count();
+
+	    bench_result arena_result;
+	    arena_result.name = "bvh_node_spheres:arena";
+	    arena_result.primitives = count;
+	    arena_result.bytes_per_primitive = double(arena_bytes) / count;
+	    arena_result.build_ms = measure_build([&]() { arena_root = arena_make_shared<bvh_node>(arena_list); }, opt);
+	    measure_rays(rays, [&](const ray& r) { return arena_root->hit(r, ray_t, rec); }, opt, arena_result);
+	    results.push_back(arena_result);
+	    std::clog << "  arena: " << arena_allocations << " allocations, " << arena_bytes / 1024 << " KB\n";
+	}
+    }
+}
+
+// ---------------------------------------------------------------------
+// sphere_group vs 구마다 sphere 객체 + bvh_node
+// 같은 구 배치(일부는 움직이는 구)에서 빌드 / 순회 비교, 충돌 거리가 같은지도 확인
+
+static void bench_sphere_group(const bench_options& opt, std::vector<bench_result>& results) {
+    auto mat = make_shared<lambertian>(color(0.5, 0.5, 0.5));
+    interval ray_t(0.0001, infinity);
+
+    for (size_t count : { size_t(1000), size_t(10000), size_t(100000) }) {
+	std::clog << "sphere_group: " << count << "\n";
+
+	double extent = 10.0 * std::cbrt(count / 1000.0);
+	struct sphere_desc { point3 center1, center2; double radius; };
+	std::vector<sphere_desc> descs;
+	for (size_t i = 0; i < count; i++) {
+	    point3 center = vec3::random(-extent, extent);
+	    // 10%는 움직이는 구
+	    point3 center2 = (i % 10 == 0) ? center + vec3::random(-0.3, 0.3) : center;
+	    descs.push_back({ center, center2, random_double(0.05, 0.2) });
+	}
+
+	hittable_list list;
+	for (const auto& d : descs) {
+	    if (!(d.center2 - d.center1).near_zero())
+		list.add(make_shared<sphere>(d.center1, d.center2, d.radius, mat));
+	    else
+		list.add(make_shared<sphere>(d.center1, d.radius, mat));
+	}
+
+	shared_ptr<sphere_group> group;
+	auto build_group = [&]() {
+	    group = make_shared<sphere_group>();
+	    for (const auto& d : descs)
+		group->add(d.center1, d.center2, d.radius, mat);
+	    group->build();
+	};
+
+	bench_result bvh_result;
+	bvh_result.name = "sphere_group:bvh_node";
+	bvh_result.primitives = count;
+	shared_ptr<bvh_node> root;
+	bvh_result.build_ms = measure_build([&]() { root = make_shared<bvh_node>(list); }, opt);
+
+	bench_result group_result;
+	group_result.name = "sphere_group:simd";
+	group_result.primitives = count;
+	group_result.build_ms = measure_build(build_group, opt);
+	group_result.bytes_per_primitive = double(group->memory_bytes()) / count;
+
+	auto rays = make_rays(root->bounding_box(), opt.ray_count, true);
+
+	// 두 구조가 같은 구를 찾는지 확인
+	size_t mismatches = 0;
+	for (const auto& r : rays) {
+	    hit_record a, b;
+	    bool hit_a = root->hit(r, ray_t, a);
+	    bool hit_b = group->hit(r, ray_t, b);
+	    if (hit_a != hit_b || (hit_a && std::fabs(a.t - b.t) > 1e-9 * std::fmax(1.0, a.t)))
+		mismatches++;
+	}
+	if (mismatches > 0)
+	    std::clog << "  warning: " << mismatches << " rays differ from bvh_node\n";
+
+	hit_record rec;
+	measure_rays(rays, [&](const ray& r) { return root->hit(r, ray_t, rec); }, opt, bvh_result);
+	measure_rays(rays, [&](const ray& r) { return group->hit(r, ray_t, rec); }, opt, group_result);
+	results.push_back(bvh_result);
+	results.push_back(group_result);
+    }
+}
+
+// ---------------------------------------------------------------------
+// translate / transform 래퍼 체인: 그대로 vs collapse_transforms로 합친 결과
+// 작은 상자 여러 개에 회전 / 이동 래퍼를 depth 단계 씌운 씬 (bvh_node로 감쌈)
+
+static void bench_transform_chain(const bench_options& opt, std::vector<bench_result>& results) {
+    auto mat = make_shared<lambertian>(color(0.5, 0.5, 0.5));
+    interval ray_t(0.0001, infinity);
+    const int count = 200;
+
+    for (int depth : { 1, 2, 4, 8 }) {
+	std::clog << "transform chain: depth " << depth << "\n";
+
+	hittable_list list;
+	for (int i = 0; i < count; i++) {
+	    shared_ptr<hittable> object = (i % 2 == 0)
+		? shared_ptr<hittable>(box(point3(0, 0, 0), point3(0.5, 0.5, 0.5), mat))
+		: shared_ptr<hittable>(make_shared<sphere>(point3(0, 0, 0), 0.3, mat));
+	    vec3 position = vec3::random(-10, 10);
+	    for (int level = 0; level < depth; level++) {
+		if (level % 2 == 0)
+		    object = make_shared<transform>(object,
+			matrix4::rotation(vec3::random(-1, 1), random_double(0, 360)));
+		else
+		    object = make_shared<translate>(object, vec3::random(-0.5, 0.5));
+	    }
+	    list.add(make_shared<translate>(object, position));
+	}
+
+	hittable_list collapsed;
+	for (const auto& object : list.objects)
+	    collapsed.add(object);
+	collapse_transforms(collapsed);
+
+	auto chained_root = make_shared<bvh_node>(list);
+	auto collapsed_root = make_shared<bvh_node>(collapsed);
+	auto rays = make_rays(chained_root->bounding_box(), opt.ray_count);
+	hit_record rec;
+
+	bench_result chained;
+	chained.name = "transform_chain:depth" + std::to_string(depth);
+	chained.primitives = count;
+	measure_rays(rays, [&](const ray& r) { return chained_root->hit(r, ray_t, rec); }, opt, chained);
+	results.push_back(chained);
+
+	bench_result folded;
+	folded.name = "transform_chain:depth" + std::to_string(depth) + ":collapsed";
+	folded.primitives = count;
+	folded.build_ms = measure_build([&]() {
+	    hittable_list copy;
+	    for (const auto& object : list.objects)
+		copy.add(object);
+	    collapse_transforms(copy);
+	}, opt);
+	measure_rays(rays, [&](const ray& r) { return collapsed_root->hit(r, ray_t, rec); }, opt, folded);
+	results.push_back(folded);
+    }
+}
+
+// ---------------------------------------------------------------------
+// grid_medium: majorant 블록 크기별 delta tracking(hit) / ratio tracking(transmittance)
+// block = 격자 전체면 상한 하나 (빈 공간 건너뛰기 없음)
+// hit_rate: hit은 충돌 비율, transmittance는 평균 투과율 (블록 크기와 상관없이 같아야 함)
+
+static void bench_media(const bench_options& opt, std::vector<bench_result>& results) {
+    const int n = 64;
+    std::vector<float> density = procedural_smoke(n, 12, opt.seed);
+    aabb box(point3(-2, -2, -2), point3(2, 2, 2));
+    auto rays = make_rays(box, opt.ray_count);
+    interval ray_t(0.0001, infinity);
+
+    for (int block : { 4, 8, 16, n }) {
+	std::clog << "grid_medium: block " << block << "\n";
+	grid_medium medium(box, n, n, n, density, 6.0, color(1, 1, 1), block);
+	std::string suffix = ":block" + std::to_string(block);
+
+	bench_result hit_result;
+	hit_result.name = "grid_medium:delta" + suffix;
+	hit_result.primitives = size_t(n) * n * n;
+	hit_result.bytes_per_primitive = double(medium.memory_bytes()) / hit_result.primitives;
+	hit_record rec;
+	measure_rays(rays, [&](const ray& r) { return medium.hit(r, ray_t, rec); }, opt, hit_result);
+	results.push_back(hit_result);
+
+	bench_result ratio_result = hit_result;
+	ratio_result.name = "grid_medium:ratio" + suffix;
+	double sum = 0;
+	size_t count = 0;
+	measure_rays(rays, [&](const ray& r) {
+	    sum += medium.transmittance(r, ray_t);
+	    count++;
+	    return true;
+	}, opt, ratio_result);
+	ratio_result.hit_rate = sum / count;
+	results.push_back(ratio_result);
+    }
+
+    // 월드 BVH에 넣은 매질 (물체 1개라 left = right인 리프): 충돌 비율 / 투과율이 매질만 검사할 때와 같아야 함
+    {
+	auto medium = make_shared<grid_medium>(box, n, n, n, density, 6.0, color(1, 1, 1), 8);
+	hittable_list list;
+	list.add(medium);
+	bvh_node root(list);
+	hit_record rec;
+
+	bench_result bare;
+	bare.name = "grid_medium:delta:block8:bare";
+	bare.primitives = size_t(n) * n * n;
+	measure_rays(rays, [&](const ray& r) { return medium->hit(r, ray_t, rec); }, opt, bare);
+	results.push_back(bare);
+
+	bench_result in_bvh = bare;
+	in_bvh.name = "grid_medium:delta:block8:bvh";
+	measure_rays(rays, [&](const ray& r) { return root.hit(r, ray_t, rec); }, opt, in_bvh);
+	results.push_back(in_bvh);
+
+	// 두 비율 모두 레이 수만큼의 베르누이 시행이므로 표준편차의 5배 넘게 차이 나면 경고
+	double p = bare.hit_rate;
+	double sigma = std::sqrt(2 * p * (1 - p) / double(rays.size()));
+	if (std::fabs(in_bvh.hit_rate - p) > 5 * sigma + 1e-9)
+	    std::cerr << "media: bvh_node 안의 grid_medium 충돌 비율 " << in_bvh.hit_rate << " != 매질만 " << p << "\n";
+
+	// 균일 매질의 투과율은 정확히 계산하므로 레이마다 같아야 함
+	constant_medium fog(make_shared<sphere>(point3(0, 0, 0), 1.5, nullptr), 0.5, color(1, 1, 1));
+	hittable_list fog_list;
+	fog_list.add(make_shared<constant_medium>(fog));
+	bvh_node fog_root(fog_list);
+	size_t mismatches = 0;
+	for (const auto& r : rays)
+	    if (std::fabs(fog.transmittance(r, ray_t) - fog_root.transmittance(r, ray_t)) > 1e-12)
+		mismatches++;
+	if (mismatches > 0)
+	    std::cerr << "media: bvh_node 안의 constant_medium 투과율이 다른 레이 " << mismatches << "개\n";
+    }
+}
+
+// ---------------------------------------------------------------------
+// 그림자 레이: hit (가장 가까운 교차 + hit_record) vs occluded (아무 교차나 하나)
+// main.cpp의 Cornell box 씬들과 같은 배치 (상자 / 구: scene15, 메시: scene8)
+// 카메라 레이가 맞은 지점에서 천장 광원 위의 랜덤한 점까지의 선분을 검사
+// hit_rate는 가려진 비율 (두 방식이 같아야 함)
+
+static void bench_cornell_walls(hittable_list& world) {
+    auto mat_white = make_shared<lambertian>(color(0.73, 0.73, 0.73));
+    auto mat_light = make_shared<diffuse_light>(color(15, 15, 15));
+    world.add(make_shared<quad>(point3(-2, -2, 2), vec3(0, 0, -4), vec3(0, 4, 0), mat_white));  // left
+    world.add(make_shared<quad>(point3(2, -2, 2), vec3(0, 0, -4), vec3(0, 4, 0), mat_white));   // right
+    world.add(make_shared<quad>(point3(-2, -2, 2), vec3(4, 0, 0), vec3(0, 0, -4), mat_white));  // floor
+    world.add(make_shared<quad>(point3(-2, 2, 2), vec3(4, 0, 0), vec3(0, 0, -4), mat_white));   // ceil
+    world.add(make_shared<quad>(point3(-2, -2, -2), vec3(4, 0, 0), vec3(0, 4, 0), mat_white));  // back
+    world.add(make_shared<quad>(point3(-0.5, 1.99, -.25), vec3(1.0, 0, 0), vec3(0, 0, -1.0), mat_light));
+}
+
+// 씬의 primitive 개수 (리스트 / 변환 래퍼는 펼치고, 메시는 삼각형 수)
+static size_t count_primitives(const shared_ptr<hittable>& object) {
+    if (auto list = std::dynamic_pointer_cast<hittable_list>(object)) {
+	size_t count = 0;
+	for (const auto& child : list->objects)
+	    count += count_primitives(child);
+	return count;
+    }
+    if (auto t = std::dynamic_pointer_cast<translate>(object))
+	return count_primitives(t->get_object());
+    if (auto t = std::dynamic_pointer_cast<transform>(object))
+	return count_primitives(t->get_object());
+    if (auto mesh = std::dynamic_pointer_cast<polygon_mesh>(object))
+	return mesh->get_faces().size();
+    return 1;
+}
+
+static void bench_occlusion(const bench_options& opt, std::vector<bench_result>& results) {
+    auto mat = make_shared<lambertian>(color(0.73, 0.73, 0.73));
+    hittable_list dummy; // polygon_mesh 생성자 인자용 (사용하지 않음)
+
+    struct scene { std::string name; hittable_list world; };
+    std::vector<scene> scenes(2);
+
+    scenes[0].name = "cornell_boxes";
+    bench_cornell_walls(scenes[0].world);
+    {
+	hittable_list& world = scenes[0].world;
+	shared_ptr<hittable> tall_box = box(point3(0, 0, 0), point3(1.1, 2.4, 1.1), mat);
+	tall_box = make_shared<transform>(tall_box, matrix4::rotation(vec3(0, 1, 0), 15));
+	world.add(make_shared<translate>(tall_box, vec3(-1.4, -2, -1.3)));
+	shared_ptr<hittable> short_box = box(point3(0, 0, 0), point3(1.1, 1.1, 1.1), mat);
+	short_box = make_shared<transform>(short_box, matrix4::rotation(vec3(0, 1, 0), -18));
+	world.add(make_shared<translate>(short_box, vec3(0.3, -2, 0.1)));
+	world.add(make_shared<sphere>(point3(0.85, -0.45, 0.65), 0.45, mat));
+	collapse_transforms(world);
+    }
+
+    scenes[1].name = "cornell_meshes";
+    bench_cornell_walls(scenes[1].world);
+    {
+	hittable_list& world = scenes[1].world;
+	std::string teapot = opt.res_dir + "teapot.obj", bunny = opt.res_dir + "stanford-bunny.obj";
+	if (std::ifstream(teapot).good() && std::ifstream(bunny).good()) {
+	    world.add(make_shared<polygon_mesh>(teapot, mat, dummy, point3(0, -2, 0), vec3(0.3, 0.3, 0.3)));
+	    world.add(make_shared<polygon_mesh>(teapot, mat, dummy, point3(-1, -1, 0), vec3(0.3, 0.3, 0.3)));
+	    world.add(make_shared<polygon_mesh>(bunny, mat, dummy, point3(1, -1, 0), vec3(10, 10, 10)));
+	    world.add(make_shared<sphere>(point3(0.6, -0.5, 0.7), 0.4, mat));
+	}
+	else {
+	    std::cerr << "벤치마크 모델 없음, 건너뜀: " << teapot << ", " << bunny << "\n";
+	    scenes.pop_back();
+	}
+    }
+
+    for (auto& s : scenes) {
+	std::clog << "occlusion: " << s.name << "\n";
+	size_t primitives = 0;
+	for (const auto& object : s.world.objects)
+	    primitives += count_primitives(object);
+	auto root = make_shared<bvh_node>(std::move(s.world));
+
+	// 카메라 (0, 0, 5)에서 방 안으로 쏜 레이가 맞은 지점 -> 광원 위의 점
+	std::vector<ray> rays;
+	rays.reserve(opt.ray_count);
+	hit_record rec;
+	while (rays.size() < opt.ray_count) {
+	    point3 eye(0, 0, 5);
+	    point3 aim(random_double(-2, 2), random_double(-2, 2), random_double(-2, 2));
+	    if (!root->hit(ray(eye, aim - eye, 0.0), interval(0.0001, infinity), rec))
+		continue;
+	    point3 light(random_double(-0.5, 0.5), 1.99, random_double(-1.25, -0.25));
+	    rays.push_back(ray(rec.p, light - rec.p, 0.0));
+	}
+	interval segment(0.0001, 0.9999); // 광원 자체는 제외
+
+	bench_result hit_result;
+	hit_result.name = "occlusion:" + s.name + ":hit";
+	hit_result.primitives = primitives;
+	measure_rays(rays, [&](const ray& r) { return root->hit(r, segment, rec); }, opt, hit_result);
+	results.push_back(hit_result);
+
+	bench_result occluded_result;
+	occluded_result.name = "occlusion:" + s.name + ":occluded";
+	occluded_result.primitives = primitives;
+	measure_rays(rays, [&](const ray& r) { return root->occluded(r, segment); }, opt, occluded_result);
+	results.push_back(occluded_result);
+
+	size_t mismatches = 0;
+	for (const auto& r : rays)
+	    if (root->hit(r, segment, rec) != root->occluded(r, segment))
+		mismatches++;
+	if (mismatches > 0)
+	    std::cerr << "occlusion " << s.name << ": hit과 결과가 다른 레이 " << mismatches << "개\n";
+    }
+}
+
+// ---------------------------------------------------------------------
+// Perlin noise / fBm: 인라인 스칼라 vs 8개 꼭짓점 SIMD 커널, marble 텍스처 직접 계산 vs bake() 캐시
+// ns_per_ray 자리에 점 1개당 시간, rmse 자리에 직접 계산과의 차이 (RMSE)
+
+static void bench_noise(const bench_options& opt, std::vector<bench_result>& results) {
+    const size_t count = 1 << 14;
+    std::vector<point3> points(count);
+    for (auto& p : points)
+	p = point3(random_double(-2, 2), random_double(-2, 2), random_double(-2, 2));
+
+    auto measure = [&](const std::string& name, const std::function<double(const point3&)>& f,
+	const std::function<double(const point3&)>& reference, size_t bytes) {
+	std::vector<double> samples;
+	for (int rep = 0; rep < opt.repeats; rep++) {
+	    size_t ops = 0;
+	    double elapsed = 0;
+	    double sum = 0;
+	    auto start = bench_clock::now();
+	    do {
+		for (const auto& p : points)
+		    sum += f(p);
+		ops += count;
+		elapsed = elapsed_seconds(start);
+	    } while (elapsed < opt.min_time);
+	    bench_sink = bench_sink + size_t(sum);
+	    samples.push_back(elapsed * 1e9 / ops);
+	}
+
+	double error = 0;
+	for (const auto& p : points) {
+	    double d = f(p) - reference(p);
+	    error += d * d;
+	}
+
+	bench_result result;
+	result.name = name;
+	result.primitives = count;
+	result.ns_per_op = median(samples);
+	result.mops_per_sec = 1e3 / result.ns_per_op;
+	result.bytes_per_primitive = double(bytes) / count;
+	result.rmse = std::sqrt(error / count);
+	results.push_back(result);
+    };
+
+    perlin noise(opt.seed);
+    auto scalar = [&](const point3& p) { return noise.noise(p); };
+    measure("perlin:scalar", scalar, scalar, sizeof(perlin));
+    measure("perlin:simd", [&](const point3& p) { return noise.fbm(p, 1); }, scalar, sizeof(perlin));
+    auto turb_scalar = [&](const point3& p) { return noise.turb_scalar(p); };
+    measure("turbulence:scalar", turb_scalar, turb_scalar, sizeof(perlin));
+    measure("turbulence:simd", [&](const point3& p) { return noise.turb(p); }, turb_scalar, sizeof(perlin));
+
+    noise_texture marble(4.0, noise_texture::pattern::marble, color(1, 1, 1), opt.seed);
+    auto direct = [&](const point3& p) { return marble.evaluate(p); };
+    measure("marble:direct", direct, direct, marble.memory_bytes());
+
+    for (int res : { 64, 128 }) {
+	noise_texture baked(4.0, noise_texture::pattern::marble, color(1, 1, 1), opt.seed);
+	baked.bake(aabb(point3(-2, -2, -2), point3(2, 2, 2)), res);
+	measure("marble:baked" + std::to_string(res), [&](const point3& p) { return baked.intensity(p); },
+	    direct, baked.memory_bytes());
+    }
+}
+
+// ---------------------------------------------------------------------
+// mesh_bvh_node: stanford-bunny LOD별 빌드 & 순회
+// 삼각형 개수에 따른 빌드 시간, 초당 레이 수 변화를 확인
+
+static void bench_mesh_lods(const bench_options& opt, std::vector<bench_result>& results) {
+    auto mat = make_shared<lambertian>(color(0.5, 0.5, 0.5));
+    interval ray_t(0.0001, infinity);
+    hittable_list world; // polygon_mesh 생성자 인자용 (사용하지 않음)
+
+    const char* lods[] = {
+	"stanford-bunny-01.obj",
+	"stanford-bunny-02.obj",
+	"stanford-bunny-04.obj",
+	"stanford-bunny-06.obj",
+	"stanford-bunny-08.obj",
+	"stanford-bunny.obj",
+    };
+
+    for (const char* lod : lods) {
+	std::string path = opt.res_dir + lod;
+	if (!std::ifstream(path).good()) {
+	    std::cerr << "벤치마크 모델 없음, 건너뜀: " << path << "\n";
+	    continue;
+	}
+
+	// 파싱 + 빌드
+	bench_result load_result;
+	load_result.name = std::string("mesh_load:") + lod;
+	shared_ptr<polygon_mesh> mesh;
+	load_result.build_ms = measure_build([&]() {
+	    mesh = make_shared<polygon_mesh>(path, mat, world, point3(0, 0, 0), vec3(20, 20, 20));
+	}, opt);
+	load_result.primitives = mesh->get_faces().size();
+
+	// 빌드만 따로 측정
+	// mesh_bvh_node는 면 배열을 정렬하므로 매번 복사본으로 빌드
+	const auto& vertices = mesh->get_vertices();
+	std::vector<point3> vertex_copy(vertices.begin(), vertices.end());
+	std::vector<triangle_face> face_copy;
+	shared_ptr<mesh_bvh_node> root;
+	bench_result build_result;
+	build_result.name = std::string("mesh_bvh_node:") + lod;
+	build_result.primitives = load_result.primitives;
+	build_result.build_ms = measure_build([&]() {
+	    face_copy = mesh->get_faces();
+	    root = make_shared<mesh_bvh_node>(vertex_copy, face_copy, mat);
+	}, opt);
+
+	auto rays = make_rays(mesh->bounding_box(), opt.ray_count);
+	hit_record rec;
+	measure_rays(rays, [&](const ray& r) { return root->hit(r, ray_t, rec); }, opt, build_result);
+	load_result.ns_per_op = build_result.ns_per_op;
+	load_result.mops_per_sec = build_result.mops_per_sec;
+	load_result.hit_rate = build_result.hit_rate;
+	load_result.bytes_per_primitive = double(mesh->memory_bytes()) / load_result.primitives;
+
+	results.push_back(load_result);
+	results.push_back(build_result);
+
+	// 양자화 BVH: 같은 레이로 비교
+	bench_result compressed_result;
+	compressed_result.name = std::string("mesh_compressed:") + lod;
+	compressed_result.primitives = load_result.primitives;
+	std::vector<compressed_mesh_bvh::triangle_corners> corners;
+	for (const auto& f : mesh->get_faces())
+	    corners.push_back({ vertices[f.face[0]], vertices[f.face[1]], vertices[f.face[2]] });
+	shared_ptr<compressed_mesh_bvh> compressed;
+	compressed_result.build_ms = measure_build([&]() {
+	    compressed = make_shared<compressed_mesh_bvh>(corners, mat);
+	}, opt);
+	measure_rays(rays, [&](const ray& r) { return compressed->hit(r, ray_t, rec); }, opt, compressed_result);
+	compressed_result.bytes_per_primitive = double(compressed->memory_bytes()) / compressed_result.primitives;
+	results.push_back(compressed_result);
+    }
+}
+
+// ---------------------------------------------------------------------
+// 메시 저장 정밀도: basic_mesh_bvh_node<double> vs <float>
+// 같은 레이로 순회 시간과 삼각형당 메모리 비교, rmse 자리에 충돌 지점 차이 (RMS 거리)
+// 렌더 비교는 Cornell box + 메시 씬을 같은 seed로 렌더해서 double 메시 이미지와의 RMSE (ns_per_ray 자리에 픽셀 샘플 1개당 시간)
+// 원점 근처와 원점에서 멀리 옮긴 씬 둘 다 렌더 (멀리 있을수록 float 반올림 오차가 커져서 self-intersection이 생기기 쉬움)
+// double 줄의 rmse는 double끼리 seed만 바꾼 RMSE (잡음 수준 기준값)
+
+template <typename T>
+static shared_ptr<basic_mesh_bvh_node<T>> build_mesh_bvh(const polygon_mesh& mesh, const vec3& offset,
+    shared_ptr<material> mat)
+{
+    std::vector<point3> vertices(mesh.get_vertices());
+    for (auto& v : vertices)
+	v += offset;
+    std::vector<triangle_face> faces;
+    faces.reserve(mesh.get_faces().size());
+    for (const auto& f : mesh.get_faces()) {
+	std::vector<int> face = f.face;
+	faces.push_back(triangle_face(face, f.bbox + offset));
+    }
+    return make_shared<basic_mesh_bvh_node<T>>(vertices, faces, mat);
+}
+
+template <typename T>
+static std::vector<color> render_precision_scene(const std::vector<shared_ptr<polygon_mesh>>& meshes,
+    const vec3& offset, uint32_t seed, bench_result* result = nullptr)
+{
+    hittable_list walls;
+    bench_cornell_walls(walls);
+
+    hittable_list objects;
+    objects.add(make_shared<translate>(make_shared<bvh_node>(walls), offset));
+    auto glass = make_shared<dielectric>(1.5);
+    auto diffuse = make_shared<lambertian>(color(0.1, 0.2, 0.5));
+    auto gold = make_shared<metal>(color(0.8, 0.6, 0.2), 0.4);
+    shared_ptr<material> mats[] = { diffuse, glass, gold };
+    for (size_t i = 0; i < meshes.size(); i++)
+	objects.add(build_mesh_bvh<T>(*meshes[i], offset, mats[i % 3]));
+    bvh_node world(objects);
+
+    camera cam;
+    cam.aspect_ratio = 1.0;
+    cam.image_width = 64;
+    cam.samples_per_pixel = 64;
+    cam.max_depth = 8;
+    cam.vfov = 45;
+    cam.lookfrom = point3(0, 0, 6.5) + offset;
+    cam.lookat = point3(0, 0, 0) + offset;
+    cam.vup = vec3(0, 1, 0);
+    cam.background = color(0, 0, 0);
+    cam.sampler_seed = seed;
+    std::vector<color> image = cam.render_frame(world);
+    if (result) {
+	result->primitives = objects.objects.size();
+	result->ns_per_op = cam.last_render_time * 1e9 / (double(image.size()) * cam.samples_per_pixel);
+	result->mops_per_sec = 1e3 / result->ns_per_op;
+    }
+    return image;
+}
+
+static void bench_precision(const bench_options& opt, std::vector<bench_result>& results) {
+    auto mat = make_shared<lambertian>(color(0.5, 0.5, 0.5));
+    interval ray_t(0.0001, infinity);
+    hittable_list dummy; // polygon_mesh 생성자 인자용 (사용하지 않음)
+
+    std::string teapot = opt.res_dir + "teapot.obj", bunny = opt.res_dir + "stanford-bunny.obj";
+    if (!std::ifstream(teapot).good() || !std::ifstream(bunny).good()) {
+	std::cerr << "벤치마크 모델 없음, 건너뜀: " << teapot << ", " << bunny << "\n";
+	return;
+    }
+
+    // main.cpp scene8과 같은 배치
+    std::vector<shared_ptr<polygon_mesh>> meshes = {
+	make_shared<polygon_mesh>(teapot, mat, dummy, point3(0, -2, 0), vec3(0.3, 0.3, 0.3)),
+	make_shared<polygon_mesh>(teapot, mat, dummy, point3(-1, -1, 0), vec3(0.3, 0.3, 0.3)),
+	make_shared<polygon_mesh>(bunny, mat, dummy, point3(1, -1, 0), vec3(10, 10, 10)),
+    };
+
+    // 순회: 원점 근처 버니, 멀리 옮긴 버니
+    for (double distance : { 0.0, 10000.0 }) {
+	const polygon_mesh& mesh = *meshes[2];
+	vec3 offset(distance, distance, distance);
+	auto root64 = build_mesh_bvh<double>(mesh, offset, mat);
+	auto root32 = build_mesh_bvh<float>(mesh, offset, mat);
+	auto rays = make_rays(root64->bounding_box(), opt.ray_count);
+	std::string suffix = distance > 0 ? ":far" : "";
+	size_t primitives = mesh.get_faces().size();
+
+	bench_result result64;
+	result64.name = "precision:bunny:double" + suffix;
+	result64.primitives = primitives;
+	hit_record rec;
+	measure_rays(rays, [&](const ray& r) { return root64->hit(r, ray_t, rec); }, opt, result64);
+	result64.bytes_per_primitive = double(root64->memory_bytes()) / primitives;
+	results.push_back(result64);
+
+	bench_result result32;
+	result32.name = "precision:bunny:float" + suffix;
+	result32.primitives = primitives;
+	measure_rays(rays, [&](const ray& r) { return root32->hit(r, ray_t, rec); }, opt, result32);
+	result32.bytes_per_primitive = double(root32->memory_bytes()) / primitives;
+
+	// 두 정밀도가 모두 맞은 레이의 충돌 지점 거리
+	double sum = 0;
+	size_t both = 0, mismatches = 0;
+	for (const auto& r : rays) {
+	    hit_record rec64, rec32;
+	    bool hit64 = root64->hit(r, ray_t, rec64);
+	    bool hit32 = root32->hit(r, ray_t, rec32);
+	    if (hit64 != hit32)
+		mismatches++;
+	    else if (hit64) {
+		sum += (rec64.p - rec32.p).length_squared();
+		both++;
+	    }
+	}
+	result32.rmse = both > 0 ? std::sqrt(sum / both) : 0;
+	results.push_back(result32);
+	if (mismatches > 0)
+	    std::clog << "precision: float / double 충돌 여부가 다른 레이 " << mismatches << "개 (모서리 근처)\n";
+    }
+
+    // 렌더 이미지 비교
+    auto rmse = [](const std::vector<color>& a, const std::vector<color>& b) {
+	double sum = 0;
+	for (size_t i = 0; i < a.size(); i++)
+	    sum += (a[i] - b[i]).length_squared();
+	return std::sqrt(sum / (3 * a.size()));
+    };
+    for (double distance : { 0.0, 10000.0 }) {
+	vec3 offset(distance, distance, distance);
+	std::string suffix = distance > 0 ? ":far" : "";
+	std::clog << "precision: cornell" << suffix << "\n";
+
+	bench_result result64;
+	result64.name = "precision:cornell:double" + suffix;
+	std::vector<color> reference = render_precision_scene<double>(meshes, offset, opt.seed, &result64);
+	result64.rmse = rmse(render_precision_scene<double>(meshes, offset, opt.seed + 1), reference);
+	results.push_back(result64);
+
+	bench_result result32;
+	result32.name = "precision:cornell:float" + suffix;
+	result32.rmse = rmse(render_precision_scene<float>(meshes, offset, opt.seed, &result32), reference);
+	results.push_back(result32);
+    }
+}
+
+// ---------------------------------------------------------------------
+// QEM 단순화: 원본 버니에서 목표 면 개수까지 줄이는 시간 (캐시 없이)
+// build_ms = 단순화 시간, primitives = 결과 면 개수
+
+static void bench_mesh_simplify(const bench_options& opt, std::vector<bench_result>& results) {
+    indexed_mesh source;
+    std::string path = opt.res_dir + "stanford-bunny.obj";
+    if (!read_obj(path, source)) {
+	std::cerr << "벤치마크 모델 없음, 건너뜀: " << path << "\n";
+	return;
+    }
+
+    const size_t targets[] = { 35000, 14000, 7000 };
+    for (size_t target : targets) {
+	indexed_mesh reduced;
+	bench_result result;
+	result.name = "mesh_simplify:" + std::to_string(target);
+	result.build_ms = measure_build([&]() {
+	    mesh_simplifier simplifier(source);
+	    simplifier.simplify(target);
+	    reduced = simplifier.extract();
+	}, opt);
+	result.primitives = reduced.faces.size();
+	results.push_back(result);
+    }
+}
+
+// ---------------------------------------------------------------------
+// 출력 변환 커널: 선형 RGB -> 감마 2 -> 바이트
+
+static void bench_tonemap(const bench_options& opt, std::vector<bench_result>& results) {
+    const size_t pixels = 1 << 20;
+    std::vector<color> image(pixels);
+    for (auto& c : image)
+	c = color::random(0, 1.2);
+    std::vector<unsigned char> bytes(pixels * 3);
+
+    std::vector<double> samples;
+    for (int rep = 0; rep < opt.repeats; rep++) {
+	size_t ops = 0;
+	double elapsed = 0;
+	auto start = bench_clock::now();
+	do {
+	    simd().linear_to_gamma_bytes(image[0].e, bytes.size(), bytes.data());
+	    ops += pixels;
+	    elapsed = elapsed_seconds(start);
+	} while (elapsed < opt.min_time);
+	bench_sink = bench_sink + bytes[ops % bytes.size()];
+	samples.push_back(elapsed * 1e9 / ops);
+    }
+
+    bench_result result;
+    result.name = "linear_to_gamma_bytes";
+    result.primitives = pixels;
+    result.ns_per_op = median(samples);
+    result.mops_per_sec = 1e3 / result.ns_per_op;
+    results.push_back(result);
+}
+
+// ---------------------------------------------------------------------
+// ppm 본문 포맷팅: ostream << (예전 write_color 방식) vs 숫자 문자열 테이블
+// ns_per_ray 자리에 픽셀 1개당 시간
+
+static void bench_ppm_format(const bench_options& opt, std::vector<bench_result>& results) {
+    const size_t pixels = 1 << 18;
+    std::vector<color> image(pixels);
+    for (auto& c : image)
+	c = color::random(0, 1.2);
+    std::vector<unsigned char> bytes(pixels * 3);
+    simd().linear_to_gamma_bytes(image[0].e, bytes.size(), bytes.data());
+
+    auto measure = [&](const char* name, const std::function<size_t()>& format) {
+	std::vector<double> samples;
+	for (int rep = 0; rep < opt.repeats; rep++) {
+	    size_t ops = 0;
+	    double elapsed = 0;
+	    auto start = bench_clock::now();
+	    do {
+		bench_sink = bench_sink + format();
+		ops += pixels;
+		elapsed = elapsed_seconds(start);
+	    } while (elapsed < opt.min_time);
+	    samples.push_back(elapsed * 1e9 / ops);
+	}
+
+	bench_result result;
+	result.name = name;
+	result.primitives = pixels;
+	result.ns_per_op = median(samples);
+	result.mops_per_sec = 1e3 / result.ns_per_op;
+	results.push_back(result);
+    };
+
+    measure("ppm_format:ostream", [&]() {
+	std::ostringstream out;
+	for (size_t i = 0; i < bytes.size(); i += 3)
+	    out << int(bytes[i]) << " " << int(bytes[i + 1]) << " " << int(bytes[i + 2]) << "\n";
+	return out.str().size();
+    });
+
+    std::string text;
+    measure("ppm_format:lut", [&]() {
+	text.clear();
+	format_ppm_bytes(bytes.data(), bytes.size(), text);
+	return text.size();
+    });
+}
+
+// ---------------------------------------------------------------------
+// 방향 / 점 샘플링 1개당 비용: 예전 rejection sampling vs 닫힌 형태 매핑
+// 양쪽 모두 같은 xorshift 난수를 써서 난수 생성 비용을 맞춤
+// hit_rate 자리에 샘플 1개당 쓴 난수 개수
+
+struct bench_rng {
+    uint64_t state = 0x9e3779b97f4a7c15ULL;
+    double next() {
+	state ^= state << 13;
+	state ^= state >> 7;
+	state ^= state << 17;
+	return (state >> 11) * (1.0 / 9007199254740992.0);
+    }
+};
+
+static void bench_sampling(const bench_options& opt, std::vector<bench_result>& results) {
+    const size_t count = 1 << 16;
+
+    auto measure = [&](const char* name, const std::function<vec3(bench_rng&, size_t&)>& sample) {
+	bench_rng rng;
+	std::vector<double> samples;
+	size_t numbers = 0, total = 0;
+	for (int rep = 0; rep < opt.repeats; rep++) {
+	    size_t ops = 0;
+	    double elapsed = 0;
+	    vec3 sum(0, 0, 0);
+	    auto start = bench_clock::now();
+	    do {
+		for (size_t i = 0; i < count; i++)
+		    sum += sample(rng, numbers);
+		ops += count;
+		elapsed = elapsed_seconds(start);
+	    } while (elapsed < opt.min_time);
+	    bench_sink = bench_sink + size_t(sum.length_squared() > 0);
+	    samples.push_back(elapsed * 1e9 / ops);
+	    total += ops;
+	}
+
+	bench_result result;
+	result.name = name;
+	result.primitives = count;
+	result.ns_per_op = median(samples);
+	result.mops_per_sec = 1e3 / result.ns_per_op;
+	result.hit_rate = double(numbers) / total;
+	results.push_back(result);
+    };
+
+    measure("sampling:sphere_rejection", [](bench_rng& rng, size_t& numbers) {
+	while (true) {
+	    vec3 p(2 * rng.next() - 1, 2 * rng.next() - 1, 2 * rng.next() - 1);
+	    numbers += 3;
+	    double lensq = p.length_squared();
+	    if (1e-160 < lensq && lensq <= 1)
+		return p / std::sqrt(lensq);
+	}
+    });
+    measure("sampling:sphere_closed_form", [](bench_rng& rng, size_t& numbers) {
+	numbers += 2;
+	double u1 = rng.next();
+	return sample_sphere(u1, rng.next());
+    });
+    measure("sampling:disk_rejection", [](bench_rng& rng, size_t& numbers) {
+	while (true) {
+	    vec3 p(2 * rng.next() - 1, 2 * rng.next() - 1, 0);
+	    numbers += 2;
+	    if (p.length_squared() < 1)
+		return p;
+	}
+    });
+    measure("sampling:disk_concentric", [](bench_rng& rng, size_t& numbers) {
+	numbers += 2;
+	double u1 = rng.next();
+	return sample_concentric_disk(u1, rng.next());
+    });
+
+    // lambertian 산란 방향: 법선 + 구 위 방향 (rejection / 닫힌 형태) vs cosine 반구 매핑
+    vec3 normal = unit_vector(vec3(0.3, 0.8, -0.5));
+    measure("sampling:lambertian_rejection", [normal](bench_rng& rng, size_t& numbers) {
+	while (true) {
+	    vec3 p(2 * rng.next() - 1, 2 * rng.next() - 1, 2 * rng.next() - 1);
+	    numbers += 3;
+	    double lensq = p.length_squared();
+	    if (1e-160 < lensq && lensq <= 1) {
+		vec3 d = normal + p / std::sqrt(lensq);
+		return d.near_zero() ? normal : d;
+	    }
+	}
+    });
+    measure("sampling:lambertian_closed_form", [normal](bench_rng& rng, size_t& numbers) {
+	numbers += 2;
+	double u1 = rng.next();
+	vec3 d = normal + sample_sphere(u1, rng.next());
+	return d.near_zero() ? normal : d;
+    });
+    measure("sampling:cosine_hemisphere", [normal](bench_rng& rng, size_t& numbers) {
+	numbers += 2;
+	double u1 = rng.next();
+	return sample_cosine_hemisphere(normal, u1, rng.next());
+    });
+}
+
+// ---------------------------------------------------------------------
+// 샘플러 수렴: 같은 씬을 spp를 바꿔가며 렌더하고 기준 이미지와의 오차 비교
+// 기준 이미지는 다른 seed의 owen_sobol 4096spp (테스트 샘플과 겹치지 않게)
+// ns_per_ray 자리에 픽셀 샘플 1개당 시간
+//
+// 씬 두 개: spheres는 카메라 / 렌즈 / 첫 반사가 오차 대부분인 열린 씬,
+// cornell은 닫힌 방이라 여러 번의 diffuse 반사가 오차 대부분 -> 뒤쪽 차원(2D 쌍마다 따로 섞은 padding)은
+// 차원끼리 층화되지 않아 random에 가까워지므로 저차원 수열의 이득이 얼마나 남는지 확인
+// equal_error 줄: random 256spp의 RMSE에 도달하는 데 필요한 spp (spp 열, 측정한 spp 사이를 log-log 보간)
+//                 render_ms는 그 spp를 그 샘플러의 256spp 샘플당 시간으로 렌더할 때의 예상 시간
+
+static void bench_sampler_convergence(const bench_options& opt, std::vector<bench_result>& results) {
+    const int spp_steps[] = { 1, 4, 16, 64, 256 };
+    const int step_count = int(sizeof(spp_steps) / sizeof(spp_steps[0]));
+    const sampler_type types[] = { sampler_type::random, sampler_type::owen_sobol, sampler_type::blue_noise };
+
+    blue_noise(); // 마스크 생성 시간이 측정에 들어가지 않게 미리 만듦
+
+    auto converge = [&](const std::string& scene, const hittable& world, size_t primitives, camera& cam) {
+	std::clog << "sampler convergence: " << scene << " reference\n";
+	cam.sampling = sampler_type::owen_sobol;
+	cam.sampler_seed = 0x5eed;
+	cam.samples_per_pixel = 4096;
+	std::vector<color> reference = cam.render_frame(world);
+
+	auto rmse = [&](const std::vector<color>& image) {
+	    double sum = 0;
+	    for (size_t i = 0; i < image.size(); i++)
+		sum += (image[i] - reference[i]).length_squared();
+	    return std::sqrt(sum / (3 * image.size()));
+	};
+
+	double errors[3][step_count];
+	double sample_ns[3] = {};
+	for (int t = 0; t < 3; t++) {
+	    for (int k = 0; k < step_count; k++) {
+		int spp = spp_steps[k];
+		std::clog << "sampler convergence: " << scene << " " << sampler_name(types[t]) << " " << spp << "spp\n";
+		cam.sampling = types[t];
+		cam.sampler_seed = opt.seed;
+		cam.samples_per_pixel = spp;
+		std::vector<color> image = cam.render_frame(world);
+
+		bench_result result;
+		result.name = "convergence:" + scene + ":" + sampler_name(types[t]) + ":" + std::to_string(spp);
+		result.primitives = primitives;
+		result.ns_per_op = cam.last_render_time * 1e9 / (double(image.size()) * spp);
+		result.mops_per_sec = 1e3 / result.ns_per_op;
+		result.rmse = errors[t][k] = rmse(image);
+		result.spp = spp;
+		sample_ns[t] = result.ns_per_op;
+		results.push_back(result);
+	    }
+	}
+
+	// 오차 곡선을 구간마다 rmse = c * spp^-a로 보고 target이 되는 spp를 구함
+	// target이 측정 범위 밖이면 가장 가까운 구간의 기울기로 연장
+	double target = errors[0][step_count - 1];
+	for (int t = 0; t < 3; t++) {
+	    int k = 1;
+	    while (k < step_count - 1 && errors[t][k] > target)
+		k++;
+	    double x0 = std::log(double(spp_steps[k - 1])), x1 = std::log(double(spp_steps[k]));
+	    double y0 = std::log(errors[t][k - 1]), y1 = std::log(errors[t][k]);
+	    double x = y1 != y0 ? x0 + (std::log(target) - y0) * (x1 - x0) / (y1 - y0) : x1;
+
+	    bench_result result;
+	    result.name = "convergence:" + scene + ":" + sampler_name(types[t]) + ":equal_error";
+	    result.primitives = primitives;
+	    result.rmse = target;
+	    result.spp = std::exp(x);
+	    result.render_ms = sample_ns[t] * result.spp * double(cam.image_width) * cam.get_image_height() * 1e-6;
+	    results.push_back(result);
+	    std::clog << "sampler convergence: " << scene << " " << sampler_name(types[t])
+		<< " reaches random 256spp error at " << result.spp << "spp\n";
+	}
+    };
+
+    {
+	hittable_list objects;
+	objects.add(make_shared<sphere>(point3(0, -1000, 0), 1000,
+	    make_shared<lambertian>(make_shared<checker_texture>(0.5, color(.2, .3, .1), color(.9, .9, .9)))));
+	objects.add(make_shared<sphere>(point3(-2.2, 1, 0), 1, make_shared<lambertian>(color(0.7, 0.3, 0.2))));
+	objects.add(make_shared<sphere>(point3(0, 1, 0), 1, make_shared<dielectric>(1.5)));
+	objects.add(make_shared<sphere>(point3(2.2, 1, 0), 1, make_shared<metal>(color(0.8, 0.8, 0.9), 0.3)));
+	bvh_node world(objects);
+
+	camera cam;
+	cam.aspect_ratio = 1.0;
+	cam.image_width = 48;
+	cam.max_depth = 8;
+	cam.vfov = 40;
+	cam.lookfrom = point3(0, 2.5, 8);
+	cam.lookat = point3(0, 0.8, 0);
+	cam.vup = vec3(0, 1, 0);
+	cam.background = color(0.70, 0.80, 1.00);
+	cam.defocus_angle = 2.0;
+	cam.focus_dist = 8.0;
+	converge("spheres", world, objects.objects.size(), cam);
+    }
+
+    {
+	hittable_list objects;
+	bench_cornell_walls(objects);
+	auto mat_white = make_shared<lambertian>(color(0.73, 0.73, 0.73));
+	shared_ptr<hittable> tall_box = box(point3(0, 0, 0), point3(1.1, 2.4, 1.1), mat_white);
+	tall_box = make_shared<transform>(tall_box, matrix4::rotation(vec3(0, 1, 0), 15));
+	objects.add(make_shared<translate>(tall_box, vec3(-1.4, -2, -1.3)));
+	shared_ptr<hittable> short_box = box(point3(0, 0, 0), point3(1.1, 1.1, 1.1), mat_white);
+	short_box = make_shared<transform>(short_box, matrix4::rotation(vec3(0, 1, 0), -18));
+	objects.add(make_shared<translate>(short_box, vec3(0.3, -2, 0.1)));
+	collapse_transforms(objects);
+	bvh_node world(objects);
+
+	camera cam;
+	cam.aspect_ratio = 1.0;
+	cam.image_width = 48;
+	cam.max_depth = 8;
+	cam.vfov = 40;
+	cam.lookfrom = point3(0, 0, 7.5);
+	cam.lookat = point3(0, 0, 0);
+	cam.vup = vec3(0, 1, 0);
+	cam.background = color(0, 0, 0);
+	converge("cornell", world, objects.objects.size(), cam);
+    }
+}
+
+// ---------------------------------------------------------------------
+// 디노이저: 낮은 spp + à-trous 디노이즈 vs 1000spp (denoiser.h)
+// 기준 이미지는 다른 seed의 1000spp, raw:1000 줄은 같은 spp를 seed만 바꾼 것 (기준 이미지 자체의 노이즈 수준)
+// render_ms = 렌더 시간 (denoised 줄은 디노이즈 시간 포함), rmse = 기준 이미지와의 차이
+
+static void bench_denoise(const bench_options& opt, std::vector<bench_result>& results) {
+    hittable_list objects;
+    bench_cornell_walls(objects);
+    auto mat_red = make_shared<lambertian>(color(0.65, 0.05, 0.05));
+    auto mat_checker = make_shared<lambertian>(make_shared<checker_texture>(0.2, color(0.2, 0.3, 0.1), color(0.9, 0.9, 0.9)));
+    shared_ptr<hittable> tall_box = box(point3(0, 0, 0), point3(1.1, 2.4, 1.1), mat_red);
+    tall_box = make_shared<transform>(tall_box, matrix4::rotation(vec3(0, 1, 0), 15));
+    objects.add(make_shared<translate>(tall_box, vec3(-1.4, -2, -1.3)));
+    objects.add(make_shared<sphere>(point3(0.7, -1.3, 0.2), 0.7, mat_checker));
+    collapse_transforms(objects);
+    bvh_node world(objects);
+
+    camera cam;
+    cam.aspect_ratio = 1.0;
+    cam.image_width = 64;
+    cam.max_depth = 8;
+    cam.vfov = 40;
+    cam.lookfrom = point3(0, 0, 7.5);
+    cam.lookat = point3(0, 0, 0);
+    cam.vup = vec3(0, 1, 0);
+    cam.background = color(0, 0, 0);
+
+    std::clog << "denoise: reference\n";
+    cam.sampler_seed = 0x5eed;
+    cam.samples_per_pixel = 1000;
+    std::vector<color> reference = cam.render_frame(world);
+
+    auto rmse = [&](const std::vector<color>& image) {
+	double sum = 0;
+	for (size_t i = 0; i < image.size(); i++)
+	    sum += (image[i] - reference[i]).length_squared();
+	return std::sqrt(sum / (3 * image.size()));
+    };
+
+    bench_result result;
+    result.primitives = objects.objects.size();
+    result.name = "denoise:cornell:reference:1000";
+    result.render_ms = cam.last_render_time * 1e3;
+    results.push_back(result);
+
+    cam.sampler_seed = opt.seed;
+    double raw_64 = 0, denoised_64 = 0, raw_1000 = 0;
+    for (int spp : { 16, 64, 256, 1000 }) {
+	std::clog << "denoise: " << spp << "spp\n";
+	cam.samples_per_pixel = spp;
+	aov_buffers aovs;
+	std::vector<color> image = cam.render_frame(world, &aovs);
+	double render_ms = cam.last_render_time * 1e3;
+
+	result.name = "denoise:cornell:raw:" + std::to_string(spp);
+	result.render_ms = render_ms;
+	result.rmse = rmse(image);
+	results.push_back(result);
+	if (spp == 64) raw_64 = result.rmse;
+	if (spp == 1000) raw_1000 = result.rmse;
+
+	if (spp > 64)
+	    continue;
+	auto start = bench_clock::now();
+	std::vector<color> denoised = atrous_denoise(image, aovs, cam.image_width, cam.get_image_height());
+	result.name = "denoise:cornell:denoised:" + std::to_string(spp);
+	result.render_ms = render_ms + elapsed_seconds(start) * 1e3;
+	result.rmse = rmse(denoised);
+	results.push_back(result);
+	if (spp == 64) denoised_64 = result.rmse;
+    }
+
+    std::clog << "denoise: RMSE vs 1000spp reference: 64spp " << raw_64 << ", 64spp + denoise " << denoised_64
+	<< ", 1000spp (other seed) " << raw_1000 << "\n";
+}
+
+// ---------------------------------------------------------------------
+// 렌더 스레드 배치: CPU 고정 정책별로 같은 씬을 렌더 (render_threads.h)
+// 메시 씬이라 BVH / 프레임버퍼 메모리 접근이 많음, NUMA 노드가 여럿인 머신에서 차이가 남
+// ns_per_ray 자리에 픽셀 샘플 1개당 시간, primitives 자리에 스레드 수
+
+static void bench_threading(const bench_options& opt, std::vector<bench_result>& results) {
+    hittable_list objects;
+    bench_cornell_walls(objects);
+    auto mat = make_shared<lambertian>(color(0.73, 0.73, 0.73));
+    hittable_list dummy; // polygon_mesh 생성자 인자용 (사용하지 않음)
+    std::string bunny = opt.res_dir + "stanford-bunny.obj";
+    if (std::ifstream(bunny).good())
+	objects.add(make_shared<polygon_mesh>(bunny, mat, dummy, point3(0, -2.3, 0), vec3(20, 20, 20)));
+    bvh_node world(objects);
+
+    camera cam;
+    cam.aspect_ratio = 1.0;
+    cam.image_width = 128;
+    cam.samples_per_pixel = 16;
+    cam.max_depth = 8;
+    cam.vfov = 45;
+    cam.lookfrom = point3(0, 0, 6.5);
+    cam.lookat = point3(0, 0, 0);
+    cam.vup = vec3(0, 1, 0);
+    cam.background = color(0, 0, 0);
+    cam.sampler_seed = opt.seed;
+
+    const numa_topology& topology = numa_topology::system();
+    std::clog << "threading: " << topology.node_count() << " NUMA node(s), " << topology.cpu_count() << " CPUs\n";
+
+    for (thread_pinning pinning : { thread_pinning::none, thread_pinning::compact, thread_pinning::spread }) {
+	cam.threading.pinning = pinning;
+	std::vector<double> samples;
+	for (int rep = 0; rep < opt.repeats; rep++) {
+	    std::vector<color> image = cam.render_frame(world);
+	    samples.push_back(cam.last_render_time * 1e9 / (double(image.size()) * cam.samples_per_pixel));
+	}
+
+	bench_result result;
+	result.name = std::string("threading:") + thread_pinning_name(pinning);
+	result.primitives = render_team(cam.threading, 1).size();
+	result.ns_per_op = median(samples);
+	result.mops_per_sec = 1e3 / result.ns_per_op;
+	results.push_back(result);
+    }
+}
+
+// ---------------------------------------------------------------------
+// render_session(타일 스트리밍) vs render_frame(한 번에 전체 이미지)
+// build_ms 자리에 첫 결과가 나오기까지 걸린 시간 (render_frame은 전체 렌더 시간)
+// rmse 자리에 render_frame 이미지와의 차이 (같은 샘플을 쓰므로 0이어야 함)
+
+static void bench_session(const bench_options& opt, std::vector<bench_result>& results) {
+    hittable_list objects;
+    bench_cornell_walls(objects);
+    auto mat = make_shared<lambertian>(color(0.73, 0.73, 0.73));
+    objects.add(make_shared<sphere>(point3(0, -1, 0), 1.0, mat));
+    auto world = make_shared<bvh_node>(objects);
+
+    camera cam;
+    cam.aspect_ratio = 1.0;
+    cam.image_width = 128;
+    cam.samples_per_pixel = 16;
+    cam.max_depth = 8;
+    cam.vfov = 45;
+    cam.lookfrom = point3(0, 0, 6.5);
+    cam.lookat = point3(0, 0, 0);
+    cam.vup = vec3(0, 1, 0);
+    cam.background = color(0, 0, 0);
+    cam.sampler_seed = opt.seed;
+
+    double samples_total = double(cam.image_width) * cam.image_width * cam.samples_per_pixel;
+
+    std::vector<color> reference;
+    std::vector<double> frame_times;
+    for (int rep = 0; rep < opt.repeats; rep++) {
+	reference = cam.render_frame(*world);
+	frame_times.push_back(cam.last_render_time);
+    }
+
+    bench_result result;
+    result.name = "session:render_frame";
+    result.primitives = reference.size();
+    result.build_ms = median(frame_times) * 1e3;
+    result.ns_per_op = median(frame_times) * 1e9 / samples_total;
+    result.mops_per_sec = 1e3 / result.ns_per_op;
+    results.push_back(result);
+
+    render_session session(world, cam);
+    std::vector<double> first_tile_times, total_times;
+    for (int rep = 0; rep < opt.repeats; rep++) {
+	std::atomic<bool> got_first{ false };
+	std::atomic<double> first_tile{ 0 };
+	auto start = bench_clock::now();
+	session.set_tile_callback([&](const render_tile&) {
+	    if (!got_first.exchange(true))
+		first_tile = elapsed_seconds(start);
+	});
+	session.start();
+	session.wait();
+	total_times.push_back(elapsed_seconds(start));
+	first_tile_times.push_back(first_tile);
+    }
+
+    std::vector<color> image = session.image();
+    double error = 0;
+    for (size_t i = 0; i < image.size(); i++) {
+	vec3 d = image[i] - reference[i];
+	error += dot(d, d) / 3;
+    }
+
+    result.name = "session:tiles";
+    result.build_ms = median(first_tile_times) * 1e3;
+    result.ns_per_op = median(total_times) * 1e9 / samples_total;
+    result.mops_per_sec = 1e3 / result.ns_per_op;
+    result.rmse = std::sqrt(error / double(image.size()));
+    results.push_back(result);
+}
+
+// ---------------------------------------------------------------------
+// 씬 편집 후 다시 렌더: 영향받는 타일만 (tile_dependencies.h) vs 전체
+// render_ms = 렌더 시간, tiles_rendered / tiles_total = 렌더한 타일 수 / 전체 타일 수
+// tiles 줄의 rmse는 편집한 씬을 처음부터 렌더한 이미지와의 차이 (추적하지 않는 두 번째 반사 이후의 간접광만큼)
+
+static void bench_incremental(const bench_options& opt, std::vector<bench_result>& results) {
+    // 하늘 아래 바닥 + 5x5 구 (구마다 자기 재질 / 텍스처)
+    // 닫힌 방(코넬 박스)은 거의 모든 타일의 첫 반사가 모든 물체를 보므로 편집하면 전부 다시 렌더하게 됨
+    hittable_list objects;
+    objects.add(make_shared<quad>(point3(-20, 0, -20), vec3(40, 0, 0), vec3(0, 0, 40), make_shared<lambertian>(color(0.5, 0.5, 0.5))));
+    std::vector<shared_ptr<solid_color>> albedo;
+    std::vector<shared_ptr<material>> materials;
+    std::vector<shared_ptr<hittable>> spheres;
+    for (int a = 0; a < 5; a++) {
+	for (int b = 0; b < 5; b++) {
+	    albedo.push_back(make_shared<solid_color>(color(0.2 + 0.15 * a, 0.5, 0.8 - 0.15 * b)));
+	    materials.push_back(make_shared<lambertian>(albedo.back()));
+	    spheres.push_back(make_shared<sphere>(point3(-4 + 2 * a, 0.4, -4 + 2 * b), 0.4, materials.back()));
+	    objects.add(spheres.back());
+	}
+    }
+
+    camera cam;
+    cam.aspect_ratio = 1.0;
+    cam.image_width = 128;
+    cam.samples_per_pixel = 16;
+    cam.max_depth = 8;
+    cam.vfov = 45;
+    cam.lookfrom = point3(0, 12, 6);
+    cam.lookat = point3(0, 0, 0);
+    cam.vup = vec3(0, 1, 0);
+    cam.background = color(0.70, 0.80, 1.00);
+    cam.sampler_seed = opt.seed;
+
+    const int tile_size = 16;
+    std::atomic<bool> cancel{ false };
+
+    // edited: 편집한 씬, edit: 편집 내용 (objects는 편집 전 BVH 리프 = 구 포인터), apply: 씬을 제자리에서 고침
+    auto measure = [&](const char* name, const hittable_list& edited, const scene_edit& edit, const std::function<void()>& apply) {
+	bvh_node before(objects);
+
+	// 편집 전 이미지를 만들어 두고, 다시 렌더한 타일만 덮어씀
+	std::vector<color> image(size_t(cam.image_width) * cam.image_width);
+	auto keep_tile = [&](int x, int y, int w, int h, const std::vector<color>& pixels) {
+	    for (int row = 0; row < h; row++)
+		std::copy(pixels.begin() + size_t(row) * w, pixels.begin() + size_t(row + 1) * w,
+		    image.begin() + size_t(y + row) * cam.image_width + x);
+	};
+	camera::tile_frame frame;
+	cam.render_tiles(before, frame, tile_size, cancel, keep_tile);
+
+	apply();
+	bvh_node after(edited);
+	int rerendered = 0;
+	cam.rerender_tiles(after, frame, edit, cancel, keep_tile, &rerendered);
+	double incremental_ms = cam.last_render_time * 1e3;
+
+	std::vector<color> reference = cam.render_frame(after);
+	double full_ms = cam.last_render_time * 1e3;
+
+	double error = 0;
+	for (size_t i = 0; i < image.size(); i++) {
+	    vec3 d = image[i] - reference[i];
+	    error += dot(d, d) / 3;
+	}
+
+	bench_result result;
+	result.name = std::string("incremental:") + name + ":full";
+	result.primitives = edited.objects.size();
+	result.render_ms = full_ms;
+	result.tiles_total = frame.tile_count();
+	result.tiles_rendered = frame.tile_count();
+	results.push_back(result);
+
+	result.name = std::string("incremental:") + name + ":tiles";
+	result.render_ms = incremental_ms;
+	result.tiles_rendered = rerendered;
+	result.rmse = std::sqrt(error / double(image.size()));
+	results.push_back(result);
+    };
+
+    // 가운데 구의 색만 바꿈 (lambertian이 텍스처를 참조하므로 텍스처 값을 바꿈)
+    {
+	scene_edit edit;
+	edit.materials.push_back(materials[12].get());
+	color old_albedo = albedo[12]->value(0, 0, point3(0, 0, 0));
+	measure("material", objects, edit, [&] { *albedo[12] = solid_color(color(0.9, 0.1, 0.1)); });
+	*albedo[12] = solid_color(old_albedo);
+    }
+
+    // 구석의 구를 옆으로 옮김
+    {
+	auto moved = make_shared<sphere>(point3(-3, 0.4, -4), 0.4, materials[0]);
+	hittable_list edited;
+	for (const auto& object : objects.objects)
+	    edited.add(object == spheres[0] ? moved : object);
+
+	scene_edit edit;
+	edit.objects.push_back(spheres[0].get());
+	edit.regions.push_back(moved->bounding_box());
+	measure("move", edited, edit, [] {});
+    }
+}
+
+// ---------------------------------------------------------------------
+// 결과 출력
+
+static void write_csv(const std::vector<bench_result>& results, std::ostream& out) {
+    out << "benchmark,primitives,build_ms,ns_per_ray,mrays_per_sec,hit_rate,bytes_per_primitive,rmse,"
+	"render_ms,tiles_total,tiles_rendered,spp\n";
+    for (const auto& r : results) {
+	out << r.name << "," << r.primitives << "," << r.build_ms << ","
+	    << r.ns_per_op << "," << r.mops_per_sec << "," << r.hit_rate << ","
+	    << r.bytes_per_primitive << "," << r.rmse << ","
+	    << r.render_ms << "," << r.tiles_total << "," << r.tiles_rendered << "," << r.spp << "\n";
+    }
+}
+
+static void write_json(const std::vector<bench_result>& results, const bench_options& opt,
+    std::ostream& out)
+{
+    out << "{\n  \"simd\": \"" << simd().name << "\",\n  \"seed\": " << opt.seed
+	<< ",\n  \"rays\": " << opt.ray_count
+	<< ",\n  \"repeats\": " << opt.repeats << ",\n  \"results\": [\n";
+    for (size_t i = 0; i < results.size(); i++) {
+	const auto& r = results[i];
+	out << "    { \"benchmark\": \"" << r.name << "\", \"primitives\": " << r.primitives
+	    << ", \"build_ms\": " << r.build_ms << ", \"ns_per_ray\": " << r.ns_per_op
+	    << ", \"mrays_per_sec\": " << r.mops_per_sec << ", \"hit_rate\": " << r.hit_rate
+	    << ", \"bytes_per_primitive\": " << r.bytes_per_primitive
+	    << ", \"rmse\": " << r.rmse << ", \"render_ms\": " << r.render_ms
+	    << ", \"tiles_total\": " << r.tiles_total << ", \"tiles_rendered\": " << r.tiles_rendered
+	    << ", \"spp\": " << r.spp << " }" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+}
+
+static bool parse_args(int argc, char** argv, bench_options& opt) {
+    for (int i = 1; i < argc; i++) {
+	std::string arg = argv[i];
+	bool has_value = i + 1 < argc;
+	if (arg == "--format" && has_value) opt.format = argv[++i];
+	else if (arg == "--out" && has_value) opt.out_path = argv[++i];
+	else if (arg == "--res" && has_value) opt.res_dir = argv[++i];
+	else if (arg == "--seed" && has_value) opt.seed = unsigned(std::stoul(argv[++i]));
+	else if (arg == "--min-time" && has_value) opt.min_time = std::stod(argv[++i]);
+	else if (arg == "--repeats" && has_value) opt.repeats = std::stoi(argv[++i]);
+	else if (arg == "--rays" && has_value) opt.ray_count = std::stoul(argv[++i]);
+	else {
+	    std::cerr << "알 수 없는 인자: " << arg << "\n";
+	    return false;
+	}
+    }
+
+    if (!opt.res_dir.empty() && opt.res_dir.back() != '/' && opt.res_dir.back() != '\\')
+	opt.res_dir += '/';
+    if (opt.repeats < 1) opt.repeats = 1;
+    return opt.format == "csv" || opt.format == "json";
+}
+
+int main(int argc, char** argv) {
+    bench_options opt;
+    if (!parse_args(argc, argv, opt)) {
+	std::cerr << "usage: benchmark [--format csv|json] [--out file] [--res dir]"
+	    " [--seed N] [--min-time sec] [--repeats N] [--rays N]\n";
+	return 1;
+    }
+
+    // 같은 시드 -> 같은 레이와 씬으로 측정
+    std::srand(opt.seed);
+
+    std::clog << "SIMD kernels: " << simd().name << "\n";
+
+    std::vector<bench_result> results;
+    bench_primitives(opt, results);
+    bench_bvh_spheres(opt, results);
+    bench_sphere_group(opt, results);
+    bench_transform_chain(opt, results);
+    bench_media(opt, results);
+    bench_noise(opt, results);
+    bench_occlusion(opt, results);
+    bench_mesh_lods(opt, results);
+    bench_precision(opt, results);
+    bench_mesh_simplify(opt, results);
+    bench_tonemap(opt, results);
+    bench_ppm_format(opt, results);
+    bench_sampling(opt, results);
+    bench_sampler_convergence(opt, results);
+    bench_denoise(opt, results);
+    bench_threading(opt, results);
+    bench_session(opt, results);
+    bench_incremental(opt, results);
+
+    std::ofstream file;
+    if (!opt.out_path.empty()) {
+	file.open(opt.out_path);
+	if (!file.is_open()) {
+	    std::cerr << "결과 파일 열기 실패: " << opt.out_path << "\n";
+	    return 1;
+	}
+    }
+    std::ostream& out = file.is_open() ? static_cast<std::ostream&>(file) : std::cout;
+
+    if (opt.format == "json")
+	write_json(results, opt, out);
+    else
+	write_csv(results, out);
+
+    return 0;
+}
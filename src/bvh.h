@@ -10,11 +10,27 @@ private:
     // 왼쪽, 오른쪽 자식 노드 가리키는 포인터
     shared_ptr<hittable> left;
     shared_ptr<hittable> right;
+    // 자식이 bvh_node가 아닌 씬 오브젝트면 true -> 그 자식과 충돌하면 rec.object에 기록
+    // 오브젝트 안쪽에 BVH가 또 있어도 바깥 BVH가 나중에 덮어쓰므로 가장 바깥 리프가 남음
+    bool left_leaf = false;
+    bool right_leaf = false;
+
+    void mark_leaves() {
+	left_leaf = dynamic_cast<const bvh_node*>(left.get()) == nullptr;
+	right_leaf = dynamic_cast<const bvh_node*>(right.get()) == nullptr;
+    }
 
 public:
-    // hittable_list를 implicit하게 복사하는 생성자
-    bvh_node(hittable_list list) 
-	: bvh_node(list.objects, 0, list.objects.size()) 
+    // 빌드하면서 리스트를 정렬하므로 직접 쓸 수 있는 리스트가 필요
+    // rvalue로 넘기면(std::move(world)) shared_ptr 벡터를 복사하지 않고 그 자리에서 정렬
+    bvh_node(hittable_list&& list)
+	: bvh_node(list.objects, 0, list.objects.size())
+    {
+    }
+
+    // lvalue는 복사본을 만들어서 정렬 (원래 리스트 순서 유지)
+    bvh_node(const hittable_list& list)
+	: bvh_node(hittable_list(list))
     {
     }
 
@@ -53,12 +69,14 @@ public:
 	if (size == 1) {
 	    left = right = objects[start];
 	    bbox = left->bounding_box();
+	    mark_leaves();
 	    return;
 	}
 	else if (size == 2) {
 	    left = objects[start];
 	    right = objects[start + 1];
 	    bbox = aabb(left->bounding_box(), right->bounding_box());
+	    mark_leaves();
 	    return;
 	}
 
@@ -81,8 +99,8 @@ public:
 	// 그리고 그 interval의 min을 기준으로 정렬
 	// 정리하자면, 각 물체의 bbox 최소점의 좌표 기준으로 정렬
 	auto interval_comp = [&]( // 람다 표현식
-	    shared_ptr<hittable> obj_a,
-	    shared_ptr<hittable> obj_b
+	    const shared_ptr<hittable>& obj_a, // 참조로 받아서 비교마다 참조 카운트를 바꾸지 않음
+	    const shared_ptr<hittable>& obj_b
 	)
 	{
 	    auto bbox_a = obj_a->bounding_box();
@@ -97,28 +115,64 @@ public:
 
 	// 리스트 분할
 	size_t mid = start + (size / 2); // 전체 object에서의 절대적 위치
-	left = make_shared<bvh_node>(objects, start, mid);
-	right = make_shared<bvh_node>(objects, mid, end);
+	left = arena_make_shared<bvh_node>(objects, start, mid);
+	right = arena_make_shared<bvh_node>(objects, mid, end);
 
 	// 현재 노드의 bbox 계산
 	bbox = aabb(left->bounding_box(), right->bounding_box());
     }
 
     bool hit(const ray& r, interval ray_t, hit_record& rec) const override {
+	RT_STAT_INC(bvh_nodes_visited);
+	RT_STAT_INC(box_tests);
+
 	// 만약 현재 노드가 레이에 부딪히지 않으면
 	if (!bbox.hit(r, ray_t))
 	    return false;
 
 	// 왼쪽과 오른쪽 노드 or primitive에 충돌 검사
 	bool hit_left = left->hit(r, ray_t, rec);
+	if (hit_left && left_leaf)
+	    rec.object = left.get();
+	// 물체가 1개인 리프는 left = right라 다시 검사하지 않음
+	// (매질의 hit은 부를 때마다 거리를 새로 샘플링하므로 두 번 부르면 가까운 쪽이 남아 밀도가 두 배가 됨)
+	if (right == left)
+	    return hit_left;
+
 	// 왼쪽 자식에서 교차점을 찾은 경우, 오른쪽 자식 노드에서는
 	// 그보다 더 가까운 교차점만 찾음
 	auto right_ray_t = interval(ray_t.min, hit_left ? rec.t : ray_t.max);
 	bool hit_right = right->hit(r, right_ray_t, rec);
+	if (hit_right && right_leaf)
+	    rec.object = right.get();
 
 	return hit_left || hit_right; // 둘 중 하나라도 hit 하는 경우에만 true
     }
 
+    // 아무 교차나 하나 찾으면 끝나므로 오른쪽 자식의 구간을 줄이지 않고 가까운 쪽 순서도 따지지 않음
+    bool occluded(const ray& r, interval ray_t) const override {
+	RT_STAT_INC(bvh_nodes_visited);
+	RT_STAT_INC(box_tests);
+
+	if (!bbox.hit(r, ray_t))
+	    return false;
+	return left->occluded(r, ray_t) || (right != left && right->occluded(r, ray_t));
+    }
+
+    // 가장 가까운 교차가 아니라 구간 전체의 투과율이 필요하므로 양쪽 자식을 모두 곱함
+    double transmittance(const ray& r, interval ray_t) const override {
+	RT_STAT_INC(bvh_nodes_visited);
+	RT_STAT_INC(box_tests);
+
+	if (!bbox.hit(r, ray_t))
+	    return 1.0;
+
+	double left_t = left->transmittance(r, ray_t);
+	if (left_t == 0 || right == left) // 물체 1개인 리프의 투과율을 두 번 곱하지 않음
+	    return left_t;
+	return left_t * right->transmittance(r, ray_t);
+    }
+
     aabb bounding_box() const {
 	return bbox;
     }
@@ -1,4 +1,7 @@
-﻿// 레이 트레이싱 기본 흐름
+﻿#ifndef CAMERA_H
+#define CAMERA_H
+
+// 레이 트레이싱 기본 흐름
 // 1. 카메라(eye)에서 화면의 픽셀 통과하는 ray 계산
 // 2. 그 ray가 scene의 어떤 오브젝트와 교차하는지 판단
 // 3. 가장 가까운 교차 지점에서 색상 계산
@@ -14,11 +17,16 @@
 
 #include "hittable.h"
 #include "material.h"
+#include "heatmap.h"
+#include "denoiser.h"
+#include "environment.h"
+#include "image_writer.h"
+#include "render_threads.h"
+#include "tile_dependencies.h"
 
 class camera {
 private:
     int image_height;	    // 렌더 이미지 높이
-    double pixel_samples_scale; // 픽셀 샘플의 누적합에 더할 Color scale factor
     point3 center;	    // 카메라 센터
     point3 pixel00_loc;    // (0, 0) 픽셀의 위치
     vec3 pixel_delta_u;	    // 뷰포트 오른쪽 가리키는 벡터
@@ -39,8 +47,6 @@ private:
 	image_height = int(image_width / aspect_ratio);
 	image_height = (image_height < 1) ? 1 : image_height; // 높이 1 이상
 
-	pixel_samples_scale = 1.0 / samples_per_pixel;
-
 	// 카메라 속성
 	center = lookfrom;
 	//auto focal_length = (lookfrom - lookat).length();
@@ -85,16 +91,45 @@ private:
 	defocus_disk_v = v * defocus_radius;
     }
 
-    color ray_color(const ray& r, int depth, const hittable& world) const {
+    // aov가 nullptr가 아니면 첫 충돌 지점의 albedo, 법선, 깊이를 기록 (primary ray에서만 넘김)
+    // scatter_pdf: 이 레이를 만든 산란의 방향 밀도 (환경 맵 MIS 가중치용, 0이면 카메라 레이 / 거울 반사)
+    color ray_color(const ray& r, int depth, const hittable& world, sampler& s,
+	aov_sample* aov = nullptr, double scatter_pdf = 0) const
+    {
+	sampler_scope scope(s); // 매질의 거리 샘플링도 같은 sampler에서
 	// 최대 depth 이상으로 반사되지 않게 함
-	if (depth <= 0)
+	// 경로 길이 = 지금까지 추적한 레이 개수
+	if (depth <= 0) {
+	    RT_STAT_PATH_LENGTH(max_depth - depth);
 	    return color(0, 0, 0);
+	}
 
 	hit_record rec;
+	// primary ray와 첫 반사 레이가 본 것만 타일 의존성으로 기록 (타일 렌더 중일 때만)
+	tile_dependencies* deps = depth >= max_depth - 1 ? dependency_recorder() : nullptr;
+
+	// 레이가 아무 물체에도 충돌하지 않으면 배경색 (환경 맵이 있으면 그 방향의 값) 리턴
+	if (!world.hit(r, interval(0.0001, infinity), rec)) {
+	    RT_STAT_PATH_LENGTH(max_depth - depth + 1);
+	    if (deps)
+		deps->background = true;
+	    if (!environment)
+		return background;
+	    // 직전 충돌 지점에서 환경 맵을 직접 샘플링했으면 MIS 가중치만큼만 더함
+	    color env = environment->value(r.direction());
+	    if (scatter_pdf > 0)
+		env = env * power_heuristic(scatter_pdf, environment->pdf(r.direction()));
+	    return env;
+	}
 
-	// 레이가 아무 물체에도 충돌하지 않으면 배경색 리턴
-	if (!world.hit(r, interval(0.0001, infinity), rec))
-	    return background;
+	if (deps)
+	    deps->add(rec);
+
+	if (aov) {
+	    aov->albedo = rec.mat->surface_albedo(rec);
+	    aov->normal = rec.normal;
+	    aov->depth = rec.t * r.direction().length();
+	}
 
 	ray scattered;
 	color attenuation;
@@ -105,43 +140,350 @@ private:
 
 	// 만약 물체가 빛을 반사하지 않으면
 	// 방출된 빛 그대로 표시
-	if (!rec.mat->scatter(r, rec, attenuation, scattered))
+	if (!rec.mat->scatter(r, rec, attenuation, scattered, s)) {
+	    RT_STAT_PATH_LENGTH(max_depth - depth + 1);
 	    return color_from_emission;
+	}
+
+	RT_STAT_INC(secondary_rays);
+
+	// 난반사 재질이면 환경 맵을 직접 샘플링 (next event estimation)
+	double pdf = environment ? rec.mat->scattering_pdf(r, rec, scattered.direction()) : 0;
+	color color_from_environment(0, 0, 0);
+	if (pdf > 0) {
+	    color_from_environment = sample_environment(r, rec, world, s);
+	    if (deps)
+		deps->background = true;
+	}
 
 	// 재질이 빛을 반사한다면, 재귀적으로 ray_color 호출해
 	// 반사된 광선이 가져오는 빛의 색 계산
-	color color_from_scatter = attenuation * ray_color(scattered, depth - 1, world);
+	color color_from_scatter = attenuation * ray_color(scattered, depth - 1, world, s, nullptr, pdf);
 
 	// 방출된 빛과 반사된 빛을 더해 최종 색상 결정
-	return color_from_scatter + color_from_emission;
+	return color_from_scatter + color_from_environment + color_from_emission;
     }
 
-    ray get_ray(int i, int j) const {
+    // 환경 맵에서 밝기에 비례해 방향 하나를 골라 가림 검사 후 직접광 계산
+    // BSDF 샘플링(scatter)으로도 같은 방향을 고를 수 있으므로 power heuristic으로 가중치
+    color sample_environment(const ray& r, const hit_record& rec, const hittable& world, sampler& s) const {
+	vec3 direction;
+	double light_pdf;
+	color light = environment->sample(s.get_2d(), direction, light_pdf);
+	if (light_pdf <= 0)
+	    return color(0, 0, 0);
+
+	color f = rec.mat->scattering_value(r, rec, direction);
+	if (f.length_squared() == 0)
+	    return color(0, 0, 0);
+
+	// 표면은 가리면 0, 참여 매질은 투과율만큼 줄어듦
+	RT_STAT_INC(shadow_rays);
+	double visibility = world.transmittance(rec.spawn_ray(direction, r.time()), interval(0.0001, infinity));
+	if (visibility <= 0)
+	    return color(0, 0, 0);
+
+	double weight = power_heuristic(light_pdf, rec.mat->scattering_pdf(r, rec, direction));
+	return f * light * (visibility * weight / light_pdf);
+    }
+
+    ray get_ray(int i, int j, sampler& s) const {
 	// 카메라에서 시작해 픽셀 (i, j) 주변의 
 	// 랜덤한 샘플 포인트로 향하는 레이 리턴
+	// 차원 순서: 픽셀 안 위치(2D), 렌즈(2D), 시간(1D)
 
 	// x와 y가 각각 [-0.5, +0.5] 값을 가지는 오프셋 벡터
-	auto offset = sample_square();
+	auto offset = sample_square(s);
 	auto pixel_sample = pixel00_loc
 	    + ((i + offset.x()) * pixel_delta_u)
 	    + ((j + offset.y()) * pixel_delta_v);
 	//auto ray_origin = center; // 레이 시작은 카메라 센터
 	// defocus angle이 0이면 핀홀 방식 -> 항상 선명한 이미지
 	// 1 초과하면 레이 시작 지점이 렌즈 디스크 임의의 한 점
-	auto ray_origin = (defocus_angle <= 0) ? center : defocus_disk_sample();
+	// 핀홀이어도 렌즈 차원은 소비해서 뒤 차원 번호가 바뀌지 않게 함
+	auto lens_sample = s.get_2d();
+	auto ray_origin = (defocus_angle <= 0) ? center : defocus_disk_sample(lens_sample);
 	auto ray_direction = pixel_sample - ray_origin; // 샘플링 지점으로
-	auto ray_time = random_double(); // [0, 1] 범위 랜덤 시간으로 레이 생성
+	auto ray_time = s.get_1d(); // [0, 1] 범위 랜덤 시간으로 레이 생성
 	return ray(ray_origin, ray_direction, ray_time);
     }
 
-    vec3 sample_square() const {
+    vec3 sample_square(sampler& s) const {
 	// [-0.5, +0.5] 범위의 x, y 값을 가지는 벡터 리턴
-	return vec3(random_double() - 0.5, random_double() - 0.5, 0);
+	auto square = s.get_2d();
+	return vec3(square.u - 0.5, square.v - 0.5, 0);
+    }
+
+#ifdef RT_TRAVERSAL_COST
+    // 픽셀 (i, j) 중심을 지나는 primary ray의 BVH 순회 비용 (방문한 노드 + primitive 검사 수)
+    // RT_ENABLE_STATS / RT_ENABLE_HEATMAP 빌드에만 있음, 측정용 레이는 레이 통계에 넣지 않음
+    double primary_ray_cost(int i, int j, const hittable& world) const {
+	auto pixel_center = pixel00_loc + (i * pixel_delta_u) + (j * pixel_delta_v);
+	ray r(center, pixel_center - center, 0.0);
+	hit_record rec;
+
+	RT_STATS_SAVE(saved_stats);
+	traversal_cost_state& probe = traversal_cost();
+	probe.counting = true;
+	probe.cost = 0;
+	world.hit(r, interval(0.0001, infinity), rec);
+	probe.counting = false;
+	RT_STATS_RESTORE(saved_stats);
+	return double(probe.cost);
+    }
+#endif
+
+    // 월드 공간 bbox가 화면에 보일 수 있는 픽셀 범위 (샘플 지터 / defocus 번짐 포함)
+    // bbox가 카메라 평면 뒤쪽에 걸치면 false
+    bool project_region(const aabb& box, double& i_min, double& i_max, double& j_min, double& j_max) const {
+	i_min = j_min = infinity;
+	i_max = j_max = -infinity;
+	double pixel_size = std::min(pixel_delta_u.length(), pixel_delta_v.length());
+	double defocus_radius = defocus_disk_u.length();
+
+	for (int corner = 0; corner < 8; corner++) {
+	    point3 p(corner & 1 ? box.x.max : box.x.min,
+		corner & 2 ? box.y.max : box.y.min,
+		corner & 4 ? box.z.max : box.z.min);
+	    vec3 d = p - center;
+	    double z = -dot(d, w); // 시선 방향 거리
+	    if (z <= 1e-8)
+		return false;
+
+	    // 초점 평면에 투영한 위치 -> 픽셀 좌표
+	    vec3 q = center + d * (focus_dist / z) - pixel00_loc;
+	    double i = dot(q, pixel_delta_u) / pixel_delta_u.length_squared();
+	    double j = dot(q, pixel_delta_v) / pixel_delta_v.length_squared();
+	    // 렌즈 위의 다른 점에서 보면 초점 평면에서 defocus_radius * |1 - focus_dist / z|만큼 옮겨짐
+	    double margin = 1 + defocus_radius * std::fabs(1 - focus_dist / z) / pixel_size;
+
+	    i_min = std::min(i_min, i - margin);
+	    i_max = std::max(i_max, i + margin);
+	    j_min = std::min(j_min, j - margin);
+	    j_max = std::max(j_max, j + margin);
+	}
+	return true;
+    }
+
+    // outputFilename에서 확장자 앞에 suffix를 붙인 파일 이름
+    std::string output_name_with(const std::string& suffix) const {
+	auto dot = outputFilename.rfind('.');
+	if (dot == std::string::npos)
+	    return outputFilename + suffix;
+	return outputFilename.substr(0, dot) + suffix + outputFilename.substr(dot);
+    }
+
+    // 픽셀별 샘플 누적 버퍼
+    // 시간 예산 모드에서는 픽셀마다 샘플 수가 다를 수 있으므로 각 픽셀의 샘플 수로 나눔
+    // 색 합은 rt_real 정밀도로 저장 (RT_FLOAT32면 float, 프레임버퍼 메모리 절반)
+    // 색 합 / 샘플 수는 렌더할 스레드가 band별로 처음 채워서 그 NUMA 노드 메모리에 놓임 (prepare_buffers)
+    struct sample_buffers {
+	typedef basic_vec3<rt_real> color_accum;
+	first_touch_buffer<color_accum> color_sum;
+	first_touch_buffer<int> samples;
+	aov_buffers aov_sum;                 // AOV 합 (AOV / 디노이즈 모드일 때만)
+	std::vector<double> luminance_sum;    // 분산 계산용
+	std::vector<double> luminance_sq_sum;
+    };
+
+    // 픽셀 (i, j)에 샘플 하나 추가
+    // 샘플 번호는 지금까지 이 픽셀에 더한 샘플 수 -> 고정 spp / 시간 예산 모드 모두 0, 1, 2, ... 순서
+    void add_sample(int i, int j, const hittable& world, sample_buffers& buffers, sampler& s) const {
+	size_t p = size_t(j) * image_width + i;
+	s.start_pixel_sample(i, j, buffers.samples[p]);
+	ray r = get_ray(i, j, s); // 픽셀 정사각형 내에서 샘플링
+	RT_STAT_INC(primary_rays);
+	path_lod_sample() = s.get_1d();
+	buffers.samples[p]++;
+
+	if (buffers.aov_sum.empty()) {
+	    buffers.color_sum[p] += sample_buffers::color_accum(ray_color(r, max_depth, world, s));
+	    return;
+	}
+
+	aov_sample aov;
+	color sample_color = ray_color(r, max_depth, world, s, &aov);
+	buffers.color_sum[p] += sample_buffers::color_accum(sample_color);
+	double l = luminance(sample_color);
+	buffers.luminance_sum[p] += l;
+	buffers.luminance_sq_sum[p] += l * l;
+	buffers.aov_sum.albedo[p] += aov.albedo;
+	buffers.aov_sum.normal[p] += aov.normal;
+	buffers.aov_sum.depth[p] += aov.depth;
+    }
+
+    // 누적 버퍼 -> 픽셀 평균 (aovs가 nullptr면 색만)
+    void resolve(const sample_buffers& buffers, std::vector<color>& images, aov_buffers* aovs) const {
+	size_t pixel_count = buffers.color_sum.size();
+	images.resize(pixel_count);
+	bool with_aovs = aovs && !buffers.aov_sum.empty();
+	if (with_aovs)
+	    aovs->resize(pixel_count);
+
+	for (size_t p = 0; p < pixel_count; p++) {
+	    double scale = 1.0 / std::max(1, buffers.samples[p]); // 평균 구하기
+	    images[p] = color(buffers.color_sum[p]) * scale;
+
+	    if (with_aovs) {
+		aovs->albedo[p] = buffers.aov_sum.albedo[p] * scale;
+		aovs->normal[p] = buffers.aov_sum.normal[p] * scale;
+		aovs->depth[p] = buffers.aov_sum.depth[p] * scale;
+		double mean = buffers.luminance_sum[p] * scale;
+		double sample_variance = std::max(0.0, buffers.luminance_sq_sum[p] * scale - mean * mean);
+		aovs->variance[p] = sample_variance * scale;
+	    }
+	}
+    }
+
+    // 누적 버퍼 할당 + first touch
+    // 색 합 / 샘플 수는 team의 band마다 그 band를 렌더할 노드의 스레드가 채움 (다른 band는 건드리지 않음)
+    void prepare_buffers(render_team& team, sample_buffers& buffers, bool with_aovs) const {
+	size_t pixel_count = size_t(image_height) * image_width;
+	buffers.color_sum.allocate(pixel_count);
+	buffers.samples.allocate(pixel_count);
+
+	// 스레드 하나면 병렬 구간 없이 이 스레드에서 채움
+	team.reset();
+	#pragma omp parallel num_threads(team.size()) if(team.size() > 1)
+	{
+	    thread_affinity_guard affinity;
+	    int band = team.join(affinity);
+	    for (int j; (j = team.next_row(band, false)) >= 0; ) {
+		size_t row_begin = size_t(j) * image_width, row_end = row_begin + image_width;
+		buffers.color_sum.fill(row_begin, row_end, sample_buffers::color_accum());
+		buffers.samples.fill(row_begin, row_end, 0);
+	    }
+	}
+	// OpenMP가 요청보다 적은 스레드를 준 경우 등 아무도 채우지 않은 줄
+	for (int b = 0; b < team.bands_total(); b++) {
+	    for (int j; (j = team.next_row(b, false)) >= 0; ) {
+		size_t row_begin = size_t(j) * image_width, row_end = row_begin + image_width;
+		buffers.color_sum.fill(row_begin, row_end, sample_buffers::color_accum());
+		buffers.samples.fill(row_begin, row_end, 0);
+	    }
+	}
+
+	// AOV / 디노이즈 모드일 때만 사용 (디버그 / 후처리용이라 일반 vector)
+	if (with_aovs) {
+	    buffers.aov_sum.resize(pixel_count);
+	    buffers.luminance_sum.assign(pixel_count, 0.0);
+	    buffers.luminance_sq_sum.assign(pixel_count, 0.0);
+	}
+    }
+
+    // band를 렌더하는 스레드가 읽을 씬 (노드별 복제본이 있으면 그 노드의 것)
+    const hittable& scene_for(const render_team& team, int band, const hittable& world) const {
+	if (team.pinned() && band < int(scene_replicas.size()) && scene_replicas[band])
+	    return *scene_replicas[band];
+	return world;
+    }
+
+    // 픽셀마다 samples_per_pixel개 샘플
+    // time_map이 있으면 픽셀당 시간 heatmap을 기록 (nullptr면 측정하지 않음)
+    // writer가 있으면 끝난 줄을 바로 넘겨서 렌더와 동시에 저장
+    void render_fixed(const hittable& world, render_team& team, sample_buffers& buffers,
+	std::vector<double>* time_map, async_image_writer* writer = nullptr) const
+    {
+	// band 안에서 위 -> 아래, 왼쪽 -> 오른쪽으로 그림
+	team.reset();
+	#pragma omp parallel num_threads(team.size())
+	{
+	    thread_affinity_guard affinity;
+	    int band = team.join(affinity);
+	    const hittable& local_world = scene_for(team, band, world);
+
+	    for (int j; (j = team.next_row(band)) >= 0; ) {
+		// 남은 스캔 라인 표시
+		std::clog << "\rScanlines remaining: " << (image_height - j)
+		    << " / " << image_height << " " << std::flush;
+		auto s = make_sampler(sampling, sampler_seed);
+		for (int i = 0; i < image_width; i++) {
+		    uint64_t pixel_start = time_map ? read_tsc() : 0;
+
+		    for (int sample = 0; sample < samples_per_pixel; sample++)
+			add_sample(i, j, local_world, buffers, *s);
+
+		    if (time_map)
+			(*time_map)[j * image_width + i] = double(read_tsc() - pixel_start);
+		}
+
+		if (writer) {
+		    std::vector<color> row(image_width);
+		    for (int i = 0; i < image_width; i++) {
+			size_t p = size_t(j) * image_width + i;
+			row[i] = color(buffers.color_sum[p]) / double(std::max(1, buffers.samples[p]));
+		    }
+		    writer->submit(j, 1, row.data());
+		}
+	    }
+	}
+    }
+
+    // 시간 예산 모드: 이미지 전체에 1spp씩 패스를 반복하다가 time_budget이 지나면 멈춤
+    // 마지막 패스는 중간에 끊길 수 있으므로 픽셀마다 실제 샘플 수로 나눔
+    // 첫 패스는 모든 픽셀이 샘플을 하나는 가지도록 시간과 상관없이 끝까지 돌림
+    void render_progressive(const hittable& world, render_team& team, sample_buffers& buffers,
+	std::vector<double>* time_map, std::chrono::system_clock::time_point start) const
+    {
+	typedef std::chrono::system_clock clock;
+	auto deadline = start + std::chrono::duration_cast<clock::duration>(
+	    std::chrono::duration<double>(time_budget));
+	auto last_write = start;
+
+	int pass = 0;
+	while (pass < samples_per_pixel) {
+	    bool first_pass = pass == 0;
+
+	    team.reset();
+	    #pragma omp parallel num_threads(team.size())
+	    {
+		thread_affinity_guard affinity;
+		int band = team.join(affinity);
+		const hittable& local_world = scene_for(team, band, world);
+
+		for (int j; (j = team.next_row(band)) >= 0; ) {
+		    if (!first_pass && clock::now() >= deadline)
+			continue;
+		    auto s = make_sampler(sampling, sampler_seed);
+		    for (int i = 0; i < image_width; i++) {
+			uint64_t pixel_start = time_map ? read_tsc() : 0;
+			add_sample(i, j, local_world, buffers, *s);
+			if (time_map)
+			    (*time_map)[j * image_width + i] += double(read_tsc() - pixel_start);
+		    }
+		}
+	    }
+	    pass++;
+
+	    auto now = clock::now();
+	    std::chrono::duration<double> elapsed = now - start;
+	    std::clog << "\rPass " << pass << " / " << samples_per_pixel << " (" << elapsed.count()
+		<< " / " << time_budget << " s)   " << std::flush;
+	    if (now >= deadline)
+		break;
+
+	    // 중간 결과 저장
+	    std::chrono::duration<double> since_write = now - last_write;
+	    if (progress_interval > 0 && since_write.count() >= progress_interval) {
+		std::vector<color> images;
+		resolve(buffers, images, nullptr);
+		write_image(images, outputFilename);
+		last_write = now;
+	    }
+	}
+
+	// 픽셀당 샘플 수 분포
+	int min_samples = *std::min_element(buffers.samples.begin(), buffers.samples.end());
+	int max_samples = *std::max_element(buffers.samples.begin(), buffers.samples.end());
+	double total = 0;
+	for (int n : buffers.samples) total += n;
+	std::clog << "\nSamples per pixel: " << min_samples << " ~ " << max_samples
+	    << " (avg " << total / buffers.samples.size() << ")\n";
     }
 
-    point3 defocus_disk_sample() const {
+    point3 defocus_disk_sample(const sample2& lens_sample) const {
 	// 카메라 defocus 디스크에서 랜덤 포인트 리턴
-	auto p = random_in_unit_disk();
+	auto p = sample_concentric_disk(lens_sample.u, lens_sample.v);
 	return center + (p[0] * defocus_disk_u) + (p[1] * defocus_disk_v);
     }
 public:
@@ -150,9 +492,14 @@ public:
     double aspect_ratio = 16.0 / 9.0; // 종횡비
     int image_width = 4096; // 가로 픽셀 개수
     int samples_per_pixel = 10; // 픽셀 당 랜덤 샘플 개수
+    // 샘플 난수 생성 방식 (sampler.h)
+    sampler_type sampling = sampler_type::owen_sobol;
+    uint32_t sampler_seed = 0; // 같은 seed면 같은 샘플 패턴
     int max_depth = 10; // 레이 반사 재귀호출 최대 depth
     double vfov = 90; // 수직 시야각 (Field of View)
     color background; // 씬 배경 색상
+    // 있으면 background 대신 사용하고, 난반사 표면에서 직접 샘플링 (environment.h)
+    shared_ptr<environment_map> environment;
 
     point3 lookfrom; // 카메라의 위치
     point3 lookat; // 카메라가 바라보는 곳
@@ -163,45 +510,369 @@ public:
     double defocus_angle = 0;
     double focus_dist = 10; // 카메라에서 focus plane까지 거리
 
+    double last_render_time = 0; // 마지막 render()의 렌더 루프 시간 (초)
+
+    // 렌더 스레드 수 / CPU 고정 정책 (render_threads.h)
+    thread_options threading;
+    // NUMA 노드별 씬 복제본 (비어 있으면 모든 스레드가 render()에 넘긴 world 사용)
+    // pinning을 켠 경우에만 사용, i번째는 노드 i의 메모리에 만든 같은 씬 (run_on_each_numa_node)
+    std::vector<const hittable*> scene_replicas;
+
+    // 0보다 크면 시간 예산 모드 (초)
+    // 1spp 패스를 시간이 다 될 때까지 반복 (samples_per_pixel은 최대 패스 수)
+    double time_budget = 0;
+    // 시간 예산 모드에서 중간 결과를 outputFilename에 저장하는 간격 (초, 0이면 마지막에만 저장)
+    double progress_interval = 0;
+
+    // 디버그 heatmap 출력 여부
+    // true면 beauty 이미지와 함께 아래 두 이미지를 저장
+    // *_cost.ppm: 픽셀 중심 primary ray의 BVH 노드 방문 + primitive 검사 수
+    // *_time.ppm: 픽셀 하나를 렌더하는 데 걸린 TSC 사이클
+    bool write_heatmaps = false;
+
+    // AOV(albedo, 법선, 깊이) 이미지 저장 여부 (*_albedo.ppm, *_normal.ppm, *_depth.ppm)
+    bool write_aovs = false;
+    // true면 AOV를 사용해 à-trous 디노이저를 돌린 *_denoised.ppm도 저장 (원본 이미지는 그대로)
+    bool denoise = false;
+    atrous_params denoise_params;
+    // 비어 있지 않으면 이 ppm(예: 1000spp 렌더)과의 RMSE를 출력
+    std::string reference_image;
+
     // 렌더 준비 & 렌더 루프 실행
     void render(const hittable& world) {
 	initialize(); // 초기화
 
-	std::ofstream out("image.ppm");
-	// ppm 파일 헤더 설정
-	out << "P3\n" << image_width << " " << image_height << "\n255\n";
+	RT_STATS_RESET();
 
 	// 렌더 시간 표시
 	std::chrono::system_clock::time_point start = std::chrono::system_clock::now();
-	// 이미지를 저장해서 출력할 1차원 벡터
-	std::vector<color>images(image_height * image_width);
-
-	// 위 -> 아래, 왼쪽 -> 오른쪽으로 그림
-	#pragma omp parallel for schedule(dynamic)
-	for (int j = 0; j < image_height; j++) {
-	    // 남은 스캔 라인 표시
-	    std::clog << "\rScanlines remaining: " << (image_height - j)
-		<< " / " << image_height << " " << std::flush;
-	    for (int i = 0; i < image_width; i++) {
-		color pixel_color(0, 0, 0);
-		for (int sample = 0; sample < samples_per_pixel; sample++) {
-		    ray r = get_ray(i, j); // 픽셀 정사각형 내에서 랜덤 샘플링
-		    pixel_color += ray_color(r, max_depth, world);
-		}
-		pixel_color *= pixel_samples_scale; // 평균 구하기
-		images[j * image_width + i] = pixel_color;
-	    }
+
+	size_t pixel_count = size_t(image_height) * image_width;
+	render_team team(threading, image_height);
+	std::clog << "Threads: " << team.size() << " (pinning " << thread_pinning_name(threading.pinning)
+	    << ", " << team.bands_total() << " band" << (team.bands_total() > 1 ? "s" : "")
+	    << (team.pinned() && !scene_replicas.empty() ? ", scene per node" : "") << ")\n";
+	sample_buffers buffers;
+	prepare_buffers(team, buffers, write_aovs || denoise);
+
+	// heatmap 모드일 때만 사용
+	std::vector<double> cost_map(write_heatmaps ? pixel_count : 0);
+	std::vector<double> time_map(write_heatmaps ? pixel_count : 0);
+
+	// 고정 spp 모드는 끝난 줄부터 바로 저장
+	// 시간 예산 모드는 마지막 패스가 끝나야 값이 정해지므로 마지막에 한 번에 저장
+	std::unique_ptr<async_image_writer> writer;
+	if (time_budget > 0) {
+	    render_progressive(world, team, buffers, write_heatmaps ? &time_map : nullptr, start);
+	}
+	else {
+	    writer.reset(new async_image_writer(outputFilename, image_width, image_height));
+	    render_fixed(world, team, buffers, write_heatmaps ? &time_map : nullptr, writer.get());
 	}
 
 	std::chrono::duration<double>sec = std::chrono::system_clock::now() - start;
 	std::cout << "Render time : " << sec.count() << "seconds" << std::endl;
-
-	// images 벡터에 색상 값 다 넣어놓고 한 번에 쓰기
-	write_color(images, out);
+	last_render_time = sec.count();
 
 	std::clog << "\rDone                    \n";
 
-	out.close();
-	openImage(outputFilename); // 이미지 자동 실행
+	// 이미지를 저장해서 출력할 1차원 벡터
+	std::vector<color> images;
+	aov_buffers aovs;
+	resolve(buffers, images, &aovs);
+
+	if (writer)
+	    writer->finish(); // 남은 줄 저장
+	else
+	    write_image(images, outputFilename);
+
+	if (write_heatmaps) {
+#ifdef RT_TRAVERSAL_COST
+	    #pragma omp parallel for schedule(dynamic)
+	    for (int j = 0; j < image_height; j++)
+		for (int i = 0; i < image_width; i++)
+		    cost_map[j * image_width + i] = primary_ray_cost(i, j, world);
+#endif
+	    write_heatmap_images(cost_map, time_map);
+	}
+
+	if (write_aovs)
+	    write_aov_images(aovs);
+
+	std::vector<color> denoised;
+	if (denoise) {
+	    auto denoise_start = std::chrono::system_clock::now();
+	    denoised = atrous_denoise(images, aovs, image_width, image_height, denoise_params);
+	    std::chrono::duration<double> denoise_sec = std::chrono::system_clock::now() - denoise_start;
+	    std::clog << "Denoise time : " << denoise_sec.count() << "seconds\n";
+	    write_image(denoised, output_name_with("_denoised"));
+	}
+
+	if (!reference_image.empty())
+	    report_rmse(images, denoised);
     }
-};
\ No newline at end of file
+
+    void write_image(const std::vector<color>& pixels, const std::string& filename) const {
+	std::ofstream file(filename);
+	file << "P3\n" << image_width << " " << image_height << "\n255\n";
+	std::vector<color> copy(pixels);
+	write_color(copy, file);
+    }
+
+    // 법선은 [-1, 1] -> [0, 1], 깊이는 가장 먼 값으로 나눠서 저장
+    void write_aov_images(const aov_buffers& aovs) const {
+	write_image(aovs.albedo, output_name_with("_albedo"));
+
+	std::vector<color> normals(aovs.normal.size());
+	for (size_t i = 0; i < normals.size(); i++)
+	    normals[i] = 0.5 * (aovs.normal[i] + vec3(1, 1, 1));
+	write_image(normals, output_name_with("_normal"));
+
+	double max_depth_value = 0;
+	for (double d : aovs.depth)
+	    max_depth_value = std::max(max_depth_value, d);
+	std::vector<color> depths(aovs.depth.size());
+	for (size_t i = 0; i < depths.size(); i++) {
+	    double d = max_depth_value > 0 ? aovs.depth[i] / max_depth_value : 0;
+	    depths[i] = color(d, d, d);
+	}
+	write_image(depths, output_name_with("_depth"));
+    }
+
+    // 기준 이미지와의 RMSE 출력 (denoised가 비어 있으면 원본만)
+    void report_rmse(const std::vector<color>& raw, const std::vector<color>& denoised) const {
+	int width, height;
+	std::vector<unsigned char> reference;
+	if (!read_ppm(reference_image, width, height, reference)
+	    || width != image_width || height != image_height) {
+	    std::clog << "기준 이미지를 읽을 수 없거나 크기가 다름: " << reference_image << "\n";
+	    return;
+	}
+
+	std::clog << "RMSE vs " << reference_image << " : raw " << image_rmse(raw, reference);
+	if (!denoised.empty())
+	    std::clog << ", denoised " << image_rmse(denoised, reference);
+	std::clog << "\n";
+    }
+
+    // 타일 단위 렌더 상태: begin_tiles()로 준비하고 타일 번호(0 ~ tile_count() - 1)마다 render_tile() 한 번씩
+    // 타일 번호는 위 -> 아래, 왼쪽 -> 오른쪽 순서
+    // dependencies: 타일마다 마지막으로 렌더할 때 본 오브젝트 / 재질 (rerender_tiles에서 사용)
+    struct tile_frame {
+	sample_buffers buffers;
+	int tile_size = 0, tiles_x = 0, tiles_y = 0;
+	std::vector<tile_dependencies> dependencies;
+
+	int tile_count() const { return tiles_x * tiles_y; }
+    };
+
+    // parallel이 false면 누적 버퍼를 호출한 스레드 혼자 채움 (OpenMP 병렬 구간을 열지 않음)
+    // -> 자기 렌더 스레드를 따로 가진 렌더 서버의 연결 스레드처럼 OpenMP 팀을 만들면 안 되는 곳에서 사용
+    void begin_tiles(tile_frame& frame, int tile_size, bool parallel = true) {
+	initialize();
+	thread_options serial;
+	serial.threads = 1;
+	render_team row_team(parallel ? threading : serial, image_height);
+	prepare_buffers(row_team, frame.buffers, false);
+
+	frame.tile_size = tile_size;
+	frame.tiles_x = (image_width + tile_size - 1) / tile_size;
+	frame.tiles_y = (image_height + tile_size - 1) / tile_size;
+	frame.dependencies.assign(frame.tile_count(), tile_dependencies());
+    }
+
+    // 타일 하나를 고정 spp로 렌더하고 픽셀 평균(width * height개, 위 -> 아래)을 pixels에 씀
+    // 타일끼리는 픽셀이 겹치지 않으므로 서로 다른 타일은 여러 스레드에서 동시에 렌더 가능
+    void render_tile(const hittable& world, tile_frame& frame, int tile, int& x0, int& y0,
+	int& width, int& height, std::vector<color>& pixels) const
+    {
+	x0 = (tile % frame.tiles_x) * frame.tile_size;
+	y0 = (tile / frame.tiles_x) * frame.tile_size;
+	width = std::min(frame.tile_size, image_width - x0);
+	height = std::min(frame.tile_size, image_height - y0);
+	pixels.resize(size_t(width) * height);
+
+	tile_dependencies& deps = frame.dependencies[tile];
+	deps.clear();
+	dependency_recorder() = &deps;
+
+	auto s = make_sampler(sampling, sampler_seed);
+	for (int j = y0; j < y0 + height; j++) {
+	    for (int i = x0; i < x0 + width; i++) {
+		for (int sample = 0; sample < samples_per_pixel; sample++)
+		    add_sample(i, j, world, frame.buffers, *s);
+
+		// resolve()와 같은 식 (render_frame과 같은 값)
+		size_t p = size_t(j) * image_width + i;
+		double scale = 1.0 / std::max(1, frame.buffers.samples[p]);
+		pixels[size_t(j - y0) * width + (i - x0)] = color(frame.buffers.color_sum[p]) * scale;
+	    }
+	}
+
+	dependency_recorder() = nullptr;
+	deps.finish();
+    }
+
+    // 씬을 편집한 뒤 다시 렌더해야 하는 타일 번호 (위 -> 아래 순서)
+    // 의존성이 겹치는 타일 + edit.regions를 화면에 투영한 범위에 걸치는 타일
+    // frame은 같은 카메라 설정으로 begin_tiles / render_tile 한 것이어야 함
+    std::vector<int> affected_tiles(const tile_frame& frame, const scene_edit& edit) const {
+	std::vector<char> affected(frame.tile_count(), 0);
+	for (int tile = 0; tile < frame.tile_count(); tile++)
+	    affected[tile] = edit.affects(frame.dependencies[tile]);
+
+	for (const aabb& region : edit.regions) {
+	    double i_min, i_max, j_min, j_max;
+	    if (!project_region(region, i_min, i_max, j_min, j_max)) {
+		// 카메라 뒤쪽에 걸친 영역은 화면 어디에나 보일 수 있으므로 전체
+		std::fill(affected.begin(), affected.end(), 1);
+		break;
+	    }
+	    int tx0 = std::max(0, int(std::floor(i_min)) / frame.tile_size);
+	    int tx1 = std::min(frame.tiles_x - 1, int(std::floor(std::min(i_max, 1e9))) / frame.tile_size);
+	    int ty0 = std::max(0, int(std::floor(j_min)) / frame.tile_size);
+	    int ty1 = std::min(frame.tiles_y - 1, int(std::floor(std::min(j_max, 1e9))) / frame.tile_size);
+	    for (int ty = ty0; ty <= ty1; ty++)
+		for (int tx = tx0; tx <= tx1; tx++)
+		    affected[ty * frame.tiles_x + tx] = 1;
+	}
+
+	std::vector<int> tiles;
+	for (int tile = 0; tile < frame.tile_count(); tile++)
+	    if (affected[tile])
+		tiles.push_back(tile);
+	return tiles;
+    }
+
+    // 타일의 누적 샘플을 지움 (다시 렌더하면 처음부터 같은 샘플 순서로 다시 쌓임)
+    void reset_tile(tile_frame& frame, int tile) const {
+	int x0 = (tile % frame.tiles_x) * frame.tile_size;
+	int y0 = (tile / frame.tiles_x) * frame.tile_size;
+	int width = std::min(frame.tile_size, image_width - x0);
+	int height = std::min(frame.tile_size, image_height - y0);
+	for (int j = y0; j < y0 + height; j++) {
+	    size_t begin = size_t(j) * image_width + x0;
+	    frame.buffers.color_sum.fill(begin, begin + width, sample_buffers::color_accum());
+	    frame.buffers.samples.fill(begin, begin + width, 0);
+	}
+	frame.dependencies[tile].clear();
+    }
+
+    // tiles에 있는 타일만 렌더 (render_tiles, rerender_tiles)
+    // 목록 순서는 위 -> 아래라서 band로 나누면 노드마다 이미지의 연속된 부분을 맡음
+    template <typename F>
+    bool render_tile_list(const hittable& world, tile_frame& frame, const std::vector<int>& tiles,
+	const std::atomic<bool>& cancel, F&& on_tile) const
+    {
+	render_team team(threading, int(tiles.size()));
+
+	#pragma omp parallel num_threads(team.size())
+	{
+	    thread_affinity_guard affinity;
+	    int band = team.join(affinity);
+	    const hittable& local_world = scene_for(team, band, world);
+	    std::vector<color> pixels;
+
+	    for (int k; (k = team.next_row(band)) >= 0; ) {
+		if (cancel.load(std::memory_order_relaxed))
+		    continue;
+
+		int x0, y0, width, height;
+		render_tile(local_world, frame, tiles[k], x0, y0, width, height, pixels);
+		on_tile(x0, y0, width, height, pixels);
+	    }
+	}
+	return !cancel.load();
+    }
+
+    // 타일 단위 렌더 (render_session.h): 파일 저장 / 진행 표시 없음
+    // 렌더 스레드들이 tile_size 크기 타일을 나눠서 렌더하고, 끝난 타일마다 on_tile(x, y, width, height, pixels) 호출
+    // on_tile은 여러 렌더 스레드에서 동시에 불릴 수 있음
+    // cancel이 true가 되면 아직 시작하지 않은 타일은 건너뛰고 false 리턴
+    template <typename F>
+    bool render_tiles(const hittable& world, int tile_size, const std::atomic<bool>& cancel, F&& on_tile) {
+	tile_frame frame;
+	return render_tiles(world, frame, tile_size, cancel, on_tile);
+    }
+
+    // frame에 렌더 결과(누적 버퍼 + 타일 의존성)를 남겨서 나중에 rerender_tiles로 일부만 다시 렌더할 수 있게 함
+    template <typename F>
+    bool render_tiles(const hittable& world, tile_frame& frame, int tile_size, const std::atomic<bool>& cancel, F&& on_tile) {
+	auto start = std::chrono::system_clock::now();
+	begin_tiles(frame, tile_size);
+	std::vector<int> tiles(frame.tile_count());
+	for (int tile = 0; tile < frame.tile_count(); tile++)
+	    tiles[tile] = tile;
+
+	bool finished = render_tile_list(world, frame, tiles, cancel, on_tile);
+	std::chrono::duration<double> sec = std::chrono::system_clock::now() - start;
+	last_render_time = sec.count();
+	return finished;
+    }
+
+    // 씬 편집 후 영향받는 타일(affected_tiles)만 누적 버퍼를 지우고 같은 spp로 다시 렌더
+    // 나머지 타일은 frame에 남아 있는 이전 결과를 그대로 사용 (on_tile은 다시 렌더한 타일만 호출)
+    // world는 편집한 씬, frame은 이 카메라 설정으로 render_tiles(world, frame, ...)한 것
+    // 다시 렌더한 타일 수를 tiles_rendered에 씀
+    template <typename F>
+    bool rerender_tiles(const hittable& world, tile_frame& frame, const scene_edit& edit,
+	const std::atomic<bool>& cancel, F&& on_tile, int* tiles_rendered = nullptr)
+    {
+	auto start = std::chrono::system_clock::now();
+	initialize();
+	std::vector<int> tiles = affected_tiles(frame, edit);
+	for (int tile : tiles)
+	    reset_tile(frame, tile);
+	if (tiles_rendered)
+	    *tiles_rendered = int(tiles.size());
+
+	bool finished = render_tile_list(world, frame, tiles, cancel, on_tile);
+	std::chrono::duration<double> sec = std::chrono::system_clock::now() - start;
+	last_render_time = sec.count();
+	return finished;
+    }
+
+    // 파일 저장 없이 이미지만 렌더 (애니메이션처럼 저장을 따로 하는 경우)
+    // aovs가 있으면 AOV도 채움 (디노이저 입력), heatmap은 만들지 않음
+    std::vector<color> render_frame(const hittable& world, aov_buffers* aovs = nullptr) {
+	initialize();
+	auto start = std::chrono::system_clock::now();
+
+	render_team team(threading, image_height);
+	sample_buffers buffers;
+	prepare_buffers(team, buffers, aovs != nullptr);
+
+	if (time_budget > 0)
+	    render_progressive(world, team, buffers, nullptr, start);
+	else
+	    render_fixed(world, team, buffers, nullptr);
+
+	std::chrono::duration<double> sec = std::chrono::system_clock::now() - start;
+	last_render_time = sec.count();
+
+	std::vector<color> images;
+	resolve(buffers, images, aovs);
+	return images;
+    }
+
+    int get_image_height() const { return image_height; }
+
+    // heatmap 이미지 저장 & 색상 범위 출력
+    void write_heatmap_images(const std::vector<double>& cost_map,
+	const std::vector<double>& time_map) const
+    {
+#ifdef RT_TRAVERSAL_COST
+	auto cost_file = output_name_with("_cost");
+	double max_cost = write_heatmap(cost_map, image_width, image_height, cost_file);
+	std::clog << cost_file << ": 0 ~ " << max_cost << " nodes + primitives / primary ray\n";
+#else
+	(void)cost_map;
+	std::clog << "BVH 순회 비용 heatmap은 RT_ENABLE_STATS(Debug) / -DRT_HEATMAP=ON 빌드에서만 저장됨\n";
+#endif
+	auto time_file = output_name_with("_time");
+	double max_time = write_heatmap(time_map, image_width, image_height, time_file);
+	std::clog << time_file << ": 0 ~ " << max_time << " TSC cycles / pixel\n";
+    }
+};
+
+#endif
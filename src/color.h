@@ -4,7 +4,9 @@
 #include "interval.h"
 #include "vec3.h"
 
+#include <cstring>
 #include <fstream>
+#include <string>
 #include <vector>
 using color = vec3;
 
@@ -17,27 +19,60 @@ inline double linear_to_gamma(double linear_component) {
     return 0;
 }
 
-void write_color(std::vector<color>& value, std::ofstream& out) {
-    for (auto& color : value)
-    {
-	auto r = color.x();
-	auto g = color.y();
-	auto b = color.z();
-
-	// 선형 공간 값을 Gamma 2로 감마 공간 값으로 바꿈
-	r = linear_to_gamma(r);
-	g = linear_to_gamma(g);
-	b = linear_to_gamma(b);
-
-	// [0,1] 범위 값을 [0,255]로 변환
-	static const interval intensity(0.000, 0.999); // 샘플링한 값 평균 저장
-	int rbyte = int(256 * intensity.clamp(r));
-	int gbyte = int(256 * intensity.clamp(g));
-	int bbyte = int(256 * intensity.clamp(b));
-
-	// 픽셀 컬러 컴포넌트 쓰기
-	out << rbyte << " " << gbyte << " " << bbyte << "\n";
+// 0~255 값의 십진수 문자열 테이블 (ppm P3 출력용)
+// ostream의 << 대신 미리 만든 문자열을 복사해서 포맷팅 비용을 없앰
+struct ppm_digit_table {
+    char text[256][4]; // 최대 3자리 + 구분 문자 자리
+    unsigned char length[256];
+
+    ppm_digit_table() {
+	for (int v = 0; v < 256; v++) {
+	    std::string s = std::to_string(v);
+	    length[v] = (unsigned char)s.size();
+	    for (size_t k = 0; k < 4; k++)
+		text[v][k] = k < s.size() ? s[k] : ' ';
+	}
+    }
+};
+
+inline const ppm_digit_table& ppm_digits() {
+    static const ppm_digit_table table;
+    return table;
+}
+
+// 감마 변환된 바이트(픽셀당 3개)를 "r g b\n" 줄들로 포맷팅해서 out 뒤에 붙임
+inline void format_ppm_bytes(const unsigned char* bytes, size_t count, std::string& out) {
+    const ppm_digit_table& table = ppm_digits();
+    size_t pos = out.size();
+    out.resize(pos + count * 4); // 값당 최대 3자리 + 구분 문자 1개
+    char* dst = &out[0] + pos;
+    for (size_t i = 0; i < count; i++) {
+	unsigned char v = bytes[i];
+	// 4바이트를 통째로 복사하고 길이만큼만 전진 (남는 문자는 다음 값이 덮어씀)
+	std::memcpy(dst, table.text[v], 4);
+	dst += table.length[v];
+	*dst++ = (i % 3 == 2) ? '\n' : ' ';
     }
+    out.resize(dst - out.data());
+}
+
+// 선형 색 배열 -> ppm P3 본문 문자열
+// 선형 공간 값을 Gamma 2로 감마 공간 값으로 바꾼 뒤
+// [0,1] 범위 값을 [0,255]로 변환 (linear_to_gamma + [0, 0.999] clamp)
+// 변환은 SIMD 커널로 한 번에, 포맷팅은 테이블로
+inline void format_ppm_pixels(const color* pixels, size_t count, std::string& out) {
+    static_assert(sizeof(color) == 3 * sizeof(double), "color는 double 3개로 이루어져야 함");
+    std::vector<unsigned char> bytes(count * 3);
+    if (count > 0)
+	simd().linear_to_gamma_bytes(pixels[0].e, bytes.size(), bytes.data());
+    format_ppm_bytes(bytes.data(), bytes.size(), out);
+}
+
+inline void write_color(std::vector<color>& value, std::ofstream& out) {
+    // 픽셀 컬러 컴포넌트 쓰기
+    std::string text;
+    format_ppm_pixels(value.data(), value.size(), text);
+    out.write(text.data(), text.size());
 }
 
 #endif
\ No newline at end of file
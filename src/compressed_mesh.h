@@ -0,0 +1,373 @@
+#ifndef COMPRESSED_MESH_H
+#define COMPRESSED_MESH_H
+
+// 메모리를 줄인 메시 BVH (polygon_mesh의 compressed 옵션)
+// - 정점: 메시 bbox 기준 16비트 정수로 양자화, 삼각형마다 세 정점을 직접 저장 (18 bytes)
+// - 노드: 두 자식의 bbox를 부모 bbox 기준 8비트 정수로 저장 (24 bytes)
+// 순회하면서 부모 bbox로부터 자식 bbox를, 리프에서는 삼각형을 그때그때 복원함
+//
+// 자식 bbox는 바깥쪽으로 반올림해서 항상 (양자화된) 삼각형을 감쌈 -> 빠지는 교차가 없음
+// 정점 위치 자체는 bbox 크기 / 65535 이내의 오차를 가짐
+
+#include <array>
+#include <cstdint>
+
+// 리프 하나의 최대 삼각형 개수 (mesh_leaf_size와 같게 맞춤, SIMD 커널 한 번에 검사)
+const size_t compressed_leaf_size = 8;
+
+class compressed_mesh_bvh {
+public:
+    // 삼각형의 세 정점 (월드 좌표)
+    typedef std::array<point3, 3> triangle_corners;
+
+    compressed_mesh_bvh(std::vector<triangle_corners> triangles, const shared_ptr<material> mat)
+	: mat(mat)
+    {
+	if (triangles.empty())
+	    return;
+
+	// 메시 bbox
+	for (int axis = 0; axis < 3; axis++) {
+	    box_min[axis] = infinity;
+	    box_max[axis] = -infinity;
+	}
+	for (const auto& tri : triangles)
+	    for (const auto& p : tri)
+		for (int axis = 0; axis < 3; axis++) {
+		    box_min[axis] = std::min(box_min[axis], p[axis]);
+		    box_max[axis] = std::max(box_max[axis], p[axis]);
+		}
+	for (int axis = 0; axis < 3; axis++)
+	    vertex_scale[axis] = (box_max[axis] - box_min[axis]) / 65535.0;
+
+	// 정점을 먼저 양자화하고, 이후 bbox는 복원된 좌표로 계산 -> 복원한 삼각형을 정확히 감쌈
+	for (auto& tri : triangles)
+	    for (auto& p : tri)
+		p = decode_vertex(encode_vertex(p).data());
+
+	// 루트 bbox도 복원된 좌표 기준 (box_max는 반올림 오차만큼 다를 수 있음)
+	root_box = triangles_box(triangles, 0, triangles.size());
+	root_ref = build(triangles, 0, triangles.size(), root_box);
+
+	// BVH 순서로 정렬된 삼각형 저장
+	quantized.reserve(triangles.size() * 9);
+	for (const auto& tri : triangles)
+	    for (const auto& p : tri) {
+		auto q = encode_vertex(p);
+		quantized.insert(quantized.end(), q.begin(), q.end());
+	    }
+    }
+
+    aabb bounding_box() const {
+	return aabb(
+	    point3(root_box.min[0], root_box.min[1], root_box.min[2]),
+	    point3(root_box.max[0], root_box.max[1], root_box.max[2])
+	);
+    }
+
+    size_t triangle_count() const { return quantized.size() / 9; }
+
+    size_t memory_bytes() const {
+	return sizeof(*this) + nodes.capacity() * sizeof(node) + quantized.capacity() * sizeof(uint16_t);
+    }
+
+    bool hit(const ray& r, interval ray_t, hit_record& rec) const {
+	if (quantized.empty())
+	    return false;
+
+	const point3& o = r.origin();
+	const vec3& d = r.direction();
+	double inv[3] = { 1.0 / d.x(), 1.0 / d.y(), 1.0 / d.z() };
+
+	struct entry { child_ref ref; node_box box; };
+	entry stack[64];
+	int top = 0;
+
+	RT_STAT_INC(box_tests);
+	if (!slab_hit(root_box, o, inv, ray_t))
+	    return false;
+	stack[top++] = { root_ref, root_box };
+
+	bool hit_anything = false;
+	size_t hit_triangle = 0;
+	while (top > 0) {
+	    entry e = stack[--top];
+	    RT_STAT_INC(bvh_nodes_visited);
+
+	    if (e.ref.count > 0) {
+		int index = hit_leaf(e.ref, r, ray_t, rec.t);
+		if (index >= 0) {
+		    hit_anything = true;
+		    hit_triangle = e.ref.index + index;
+		    ray_t.max = rec.t;
+		}
+		continue;
+	    }
+
+	    // 두 자식 bbox 복원 후 검사, 가까운 쪽을 먼저 꺼내도록 나중에 넣음
+	    const node& n = nodes[e.ref.index];
+	    node_box child_box[2];
+	    double t_enter[2];
+	    bool child_hit[2];
+	    for (int c = 0; c < 2; c++) {
+		child_box[c] = decode_box(e.box, n.lo[c], n.hi[c]);
+		RT_STAT_INC(box_tests);
+		child_hit[c] = slab_hit(child_box[c], o, inv, ray_t, &t_enter[c]);
+	    }
+
+	    int near = (child_hit[0] && child_hit[1] && t_enter[1] < t_enter[0]) ? 1 : 0;
+	    for (int k = 1; k >= 0; k--) {
+		int c = k == 0 ? near : 1 - near;
+		if (child_hit[c] && top < 64)
+		    stack[top++] = { { n.child[c], n.count[c] }, child_box[c] };
+	    }
+	}
+
+	if (!hit_anything)
+	    return false;
+
+	// 법선은 가장 가까운 삼각형에 대해 한 번만 계산
+	auto tri = decode_triangle(hit_triangle);
+	vec3 outward_normal = unit_vector(cross(tri[1] - tri[0], tri[2] - tri[0]));
+	rec.p = r.at(rec.t);
+	rec.mat = mat;
+	rec.set_face_normal(r, outward_normal);
+	return true;
+    }
+
+    // 아무 리프에서나 교차가 나오면 끝 (자식을 거리 순으로 넣지 않고 ray_t도 줄이지 않음)
+    bool occluded(const ray& r, interval ray_t) const {
+	if (quantized.empty())
+	    return false;
+
+	const point3& o = r.origin();
+	const vec3& d = r.direction();
+	double inv[3] = { 1.0 / d.x(), 1.0 / d.y(), 1.0 / d.z() };
+
+	struct entry { child_ref ref; node_box box; };
+	entry stack[64];
+	int top = 0;
+
+	RT_STAT_INC(box_tests);
+	if (!slab_hit(root_box, o, inv, ray_t))
+	    return false;
+	stack[top++] = { root_ref, root_box };
+
+	while (top > 0) {
+	    entry e = stack[--top];
+	    RT_STAT_INC(bvh_nodes_visited);
+
+	    if (e.ref.count > 0) {
+		double t;
+		if (hit_leaf(e.ref, r, ray_t, t) >= 0)
+		    return true;
+		continue;
+	    }
+
+	    const node& n = nodes[e.ref.index];
+	    for (int c = 0; c < 2; c++) {
+		node_box child_box = decode_box(e.box, n.lo[c], n.hi[c]);
+		RT_STAT_INC(box_tests);
+		if (slab_hit(child_box, o, inv, ray_t) && top < 64)
+		    stack[top++] = { { n.child[c], n.count[c] }, child_box };
+	    }
+	}
+	return false;
+    }
+
+private:
+    // count == 0: 내부 노드 nodes[index]
+    // count > 0: 리프, [index, index + count) 범위의 삼각형
+    struct child_ref {
+	uint32_t index;
+	uint8_t count;
+    };
+
+    struct node {
+	uint8_t lo[2][3]; // 자식 bbox 최소점 (부모 bbox 기준 0~255)
+	uint8_t hi[2][3]; // 자식 bbox 최대점
+	uint32_t child[2];
+	uint8_t count[2];
+    };
+
+    struct node_box {
+	double min[3], max[3];
+    };
+
+    std::vector<node> nodes;
+    std::vector<uint16_t> quantized; // 삼각형마다 v0, v1, v2의 x, y, z
+    child_ref root_ref = { 0, 0 };
+    node_box root_box = {};
+    double box_min[3] = {}, box_max[3] = {}; // 정점 양자화 기준
+    double vertex_scale[3] = {};
+    shared_ptr<material> mat;
+
+    std::array<uint16_t, 3> encode_vertex(const point3& p) const {
+	std::array<uint16_t, 3> q;
+	for (int axis = 0; axis < 3; axis++) {
+	    double v = vertex_scale[axis] > 0 ? (p[axis] - box_min[axis]) / vertex_scale[axis] : 0;
+	    q[axis] = uint16_t(std::min(65535.0, std::max(0.0, std::round(v))));
+	}
+	return q;
+    }
+
+    point3 decode_vertex(const uint16_t* q) const {
+	return point3(
+	    box_min[0] + q[0] * vertex_scale[0],
+	    box_min[1] + q[1] * vertex_scale[1],
+	    box_min[2] + q[2] * vertex_scale[2]
+	);
+    }
+
+    triangle_corners decode_triangle(size_t i) const {
+	const uint16_t* q = &quantized[i * 9];
+	return { decode_vertex(q), decode_vertex(q + 3), decode_vertex(q + 6) };
+    }
+
+    // 0, 255는 부모의 경계값을 그대로 사용 -> 반올림 오차로 부모 밖으로 나가거나 모자라지 않음
+    static double decode_bound(const node_box& parent, int axis, uint8_t q) {
+	if (q == 0) return parent.min[axis];
+	if (q == 255) return parent.max[axis];
+	return parent.min[axis] + q * ((parent.max[axis] - parent.min[axis]) / 255.0);
+    }
+
+    static node_box decode_box(const node_box& parent, const uint8_t lo[3], const uint8_t hi[3]) {
+	node_box box;
+	for (int axis = 0; axis < 3; axis++) {
+	    box.min[axis] = decode_bound(parent, axis, lo[axis]);
+	    box.max[axis] = decode_bound(parent, axis, hi[axis]);
+	}
+	return box;
+    }
+
+    // 최소점은 내림, 최대점은 올림한 뒤 복원값이 실제 bbox를 감쌀 때까지 한 칸씩 넓힘
+    static void encode_box(const node_box& parent, const node_box& box, uint8_t lo[3], uint8_t hi[3]) {
+	for (int axis = 0; axis < 3; axis++) {
+	    double extent = parent.max[axis] - parent.min[axis];
+	    double scale = extent > 0 ? 255.0 / extent : 0;
+	    int l = int(std::floor((box.min[axis] - parent.min[axis]) * scale));
+	    int h = int(std::ceil((box.max[axis] - parent.min[axis]) * scale));
+	    l = std::max(0, std::min(255, l));
+	    h = std::max(0, std::min(255, h));
+	    if (extent <= 0) { l = 0; h = 255; }
+	    while (l > 0 && decode_bound(parent, axis, uint8_t(l)) > box.min[axis]) l--;
+	    while (h < 255 && decode_bound(parent, axis, uint8_t(h)) < box.max[axis]) h++;
+	    lo[axis] = uint8_t(l);
+	    hi[axis] = uint8_t(h);
+	}
+    }
+
+    static node_box triangles_box(const std::vector<triangle_corners>& triangles, size_t start, size_t end) {
+	node_box box;
+	for (int axis = 0; axis < 3; axis++) {
+	    box.min[axis] = infinity;
+	    box.max[axis] = -infinity;
+	}
+	for (size_t i = start; i < end; i++)
+	    for (const auto& p : triangles[i])
+		for (int axis = 0; axis < 3; axis++) {
+		    box.min[axis] = std::min(box.min[axis], p[axis]);
+		    box.max[axis] = std::max(box.max[axis], p[axis]);
+		}
+	return box;
+    }
+
+    // mesh_bvh_node와 같은 분할: 가장 긴 축 기준으로 정렬 후 반으로 나눔
+    // box는 이 노드의 (복원된) bbox
+    child_ref build(std::vector<triangle_corners>& triangles, size_t start, size_t end, const node_box& box) {
+	size_t size = end - start;
+	if (size <= compressed_leaf_size)
+	    return { uint32_t(start), uint8_t(size) };
+
+	int axis = 0;
+	for (int a = 1; a < 3; a++)
+	    if (box.max[a] - box.min[a] > box.max[axis] - box.min[axis])
+		axis = a;
+
+	std::sort(triangles.begin() + start, triangles.begin() + end,
+	    [axis](const triangle_corners& a, const triangle_corners& b) {
+		return std::min({ a[0][axis], a[1][axis], a[2][axis] })
+		    < std::min({ b[0][axis], b[1][axis], b[2][axis] });
+	    });
+
+	size_t mid = start + size / 2;
+	size_t ranges[2][2] = { { start, mid }, { mid, end } };
+
+	// 자식을 만들기 전에 자리를 잡아둠 (재귀 중 vector가 재할당되므로 인덱스로 접근)
+	uint32_t index = uint32_t(nodes.size());
+	nodes.push_back(node());
+
+	for (int c = 0; c < 2; c++) {
+	    node_box exact = triangles_box(triangles, ranges[c][0], ranges[c][1]);
+	    uint8_t lo[3], hi[3];
+	    encode_box(box, exact, lo, hi);
+	    child_ref ref = build(triangles, ranges[c][0], ranges[c][1], decode_box(box, lo, hi));
+
+	    node& n = nodes[index];
+	    std::copy(lo, lo + 3, n.lo[c]);
+	    std::copy(hi, hi + 3, n.hi[c]);
+	    n.child[c] = ref.index;
+	    n.count[c] = ref.count;
+	}
+
+	return { index, 0 };
+    }
+
+    static bool slab_hit(const node_box& box, const point3& o, const double inv[3],
+	const interval& ray_t, double* t_enter = nullptr)
+    {
+	double t_min = ray_t.min, t_max = ray_t.max;
+	for (int axis = 0; axis < 3; axis++) {
+	    double t0 = (box.min[axis] - o[axis]) * inv[axis];
+	    double t1 = (box.max[axis] - o[axis]) * inv[axis];
+	    if (t0 > t1) std::swap(t0, t1);
+	    if (t0 > t_min) t_min = t0;
+	    if (t1 < t_max) t_max = t1;
+	    if (t_max < t_min)
+		return false;
+	}
+	if (t_enter) *t_enter = t_min;
+	return true;
+    }
+
+    // 리프의 삼각형을 복원해서 SIMD 커널로 검사
+    // 리턴값은 리프 안에서 가장 가까운 삼각형의 인덱스 (없으면 -1)
+    int hit_leaf(const child_ref& leaf, const ray& r, const interval& ray_t, double& t) const {
+	RT_STAT_ADD(mesh_triangle_tests, leaf.count);
+
+	static_assert(compressed_leaf_size <= size_t(simd_max_width), "리프 삼각형이 복원 버퍼보다 많음");
+	double v0[3][simd_max_width], e1[3][simd_max_width], e2[3][simd_max_width];
+	for (int i = 0; i < simd_max_width; i++) {
+	    if (i < leaf.count) {
+		auto tri = decode_triangle(leaf.index + i);
+		for (int axis = 0; axis < 3; axis++) {
+		    v0[axis][i] = tri[0][axis];
+		    e1[axis][i] = tri[1][axis] - tri[0][axis];
+		    e2[axis][i] = tri[2][axis] - tri[0][axis];
+		}
+	    }
+	    else {
+		// 커널이 SIMD 폭만큼 읽으므로 남는 칸은 det = 0인 삼각형으로 채움
+		for (int axis = 0; axis < 3; axis++)
+		    v0[axis][i] = e1[axis][i] = e2[axis][i] = 0.0;
+	    }
+	}
+
+	triangle_soa soa = {
+	    v0[0], v0[1], v0[2],
+	    e1[0], e1[1], e1[2],
+	    e2[0], e2[1], e2[2]
+	};
+	const point3& o = r.origin();
+	const vec3& d = r.direction();
+	simd_ray sr = { o.x(), o.y(), o.z(), d.x(), d.y(), d.z() };
+
+	triangle_hit tri_hit;
+	int index = simd().intersect_triangles(soa, 0, leaf.count, sr, ray_t.min, ray_t.max, tri_hit);
+	if (index >= 0)
+	    t = tri_hit.t;
+	return index;
+    }
+};
+
+#endif
@@ -0,0 +1,80 @@
+﻿#ifndef CPU_FEATURES_H
+#define CPU_FEATURES_H
+
+// cpuid로 실행 중인 CPU의 SIMD 지원 여부 확인
+// 명령어 지원 비트뿐 아니라 OS가 YMM/ZMM 레지스터를 저장해주는지(xgetbv)도 확인해야 함
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define RT_X86 1
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+struct cpu_features {
+    bool sse42 = false;
+    bool avx2 = false;    // AVX2 + FMA
+    bool avx512 = false;  // AVX-512 F + DQ
+};
+
+#ifdef RT_X86
+inline void cpuid(int leaf, int subleaf, unsigned int regs[4]) {
+#if defined(_MSC_VER)
+    int r[4];
+    __cpuidex(r, leaf, subleaf);
+    for (int i = 0; i < 4; i++) regs[i] = (unsigned int)r[i];
+#else
+    __cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+}
+
+// XCR0 레지스터: OS가 컨텍스트 스위칭 때 저장하는 레지스터 상태
+inline unsigned long long read_xcr0() {
+#if defined(_MSC_VER)
+    return _xgetbv(0);
+#else
+    unsigned int eax, edx;
+    __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    return ((unsigned long long)edx << 32) | eax;
+#endif
+}
+#endif
+
+inline cpu_features detect_cpu_features() {
+    cpu_features features;
+#ifdef RT_X86
+    unsigned int regs[4];
+    cpuid(0, 0, regs);
+    unsigned int max_leaf = regs[0];
+    if (max_leaf < 1) return features;
+
+    cpuid(1, 0, regs);
+    bool sse42 = (regs[2] >> 20) & 1;
+    bool fma = (regs[2] >> 12) & 1;
+    bool osxsave = (regs[2] >> 27) & 1;
+    bool avx = (regs[2] >> 28) & 1;
+
+    // XMM(1), YMM(2) 상태 저장 -> AVX 사용 가능
+    // opmask(5), ZMM 하위(6), ZMM 상위(7) 상태 저장 -> AVX-512 사용 가능
+    unsigned long long xcr0 = osxsave ? read_xcr0() : 0;
+    bool os_avx = (xcr0 & 0x6) == 0x6;
+    bool os_avx512 = (xcr0 & 0xe6) == 0xe6;
+
+    bool avx2 = false, avx512f = false, avx512dq = false;
+    if (max_leaf >= 7) {
+	cpuid(7, 0, regs);
+	avx2 = (regs[1] >> 5) & 1;
+	avx512f = (regs[1] >> 16) & 1;
+	avx512dq = (regs[1] >> 17) & 1;
+    }
+
+    features.sse42 = sse42;
+    features.avx2 = avx && avx2 && fma && os_avx;
+    features.avx512 = features.avx2 && avx512f && avx512dq && os_avx512;
+#endif
+    return features;
+}
+
+#endif
@@ -0,0 +1,190 @@
+#ifndef DENOISER_H
+#define DENOISER_H
+
+// AOV(Arbitrary Output Variable) 버퍼와 edge-avoiding à-trous 디노이저 (Dammertz et al. 2010)
+//
+// 픽셀마다 첫 충돌 지점의 albedo, 법선, 깊이를 함께 저장하고
+// 5x5 B3-spline 커널을 간격 1, 2, 4, 8, 16으로 넓혀가며 반복 적용
+// 이웃 픽셀의 가중치는 색, 법선, 깊이, albedo 차이가 클수록 작아짐 -> 물체 경계와 텍스처는 유지
+// 색 차이는 픽셀의 샘플 분산으로 정규화 (SVGF 방식) -> 노이즈가 큰 곳은 강하게, 수렴한 곳은 약하게 필터링
+// 텍스처가 뭉개지지 않도록 beauty / albedo (조명 성분)만 필터링한 뒤 다시 albedo를 곱함
+
+#include <string>
+
+// 샘플 하나의 첫 충돌 정보
+struct aov_sample {
+    color albedo = color(1, 1, 1); // 배경은 1 (조명 성분 = beauty)
+    vec3 normal = vec3(0, 0, 0);   // 배경은 0
+    double depth = 0;              // 카메라에서 충돌 지점까지 거리, 배경은 0
+};
+
+// 픽셀별 AOV (샘플 평균)
+struct aov_buffers {
+    std::vector<color> albedo;
+    std::vector<vec3> normal;
+    std::vector<double> depth;
+    std::vector<double> variance; // 픽셀 평균 휘도의 분산 (샘플 분산 / 샘플 수)
+
+    void resize(size_t pixels) {
+	albedo.assign(pixels, color(0, 0, 0));
+	normal.assign(pixels, vec3(0, 0, 0));
+	depth.assign(pixels, 0.0);
+	variance.assign(pixels, 0.0);
+    }
+
+    bool empty() const { return albedo.empty(); }
+};
+
+inline double luminance(const color& c) {
+    return 0.2126 * c.x() + 0.7152 * c.y() + 0.0722 * c.z();
+}
+
+struct atrous_params {
+    int iterations = 5;         // 간격 1, 2, 4, ... 2^(iterations-1)
+    double sigma_luminance = 4.0; // 휘도 차이 / 표준편차에 대한 허용치
+    double sigma_normal = 0.2;
+    double sigma_depth = 0.05;  // 깊이에 대한 상대 오차
+    double sigma_albedo = 0.1;
+};
+
+inline std::vector<color> atrous_denoise(const std::vector<color>& beauty, const aov_buffers& aov,
+    int width, int height, const atrous_params& params = atrous_params())
+{
+    const double kernel[3] = { 3.0 / 8.0, 1.0 / 4.0, 1.0 / 16.0 }; // B3-spline (중심, 1칸, 2칸)
+    const double albedo_epsilon = 0.001;
+
+    // 조명 성분 분리 (분산도 albedo 휘도의 제곱으로 나눔)
+    std::vector<color> current(beauty.size());
+    std::vector<double> variance(beauty.size());
+    for (size_t i = 0; i < beauty.size(); i++) {
+	const color& a = aov.albedo[i];
+	current[i] = color(
+	    beauty[i].x() / std::max(a.x(), albedo_epsilon),
+	    beauty[i].y() / std::max(a.y(), albedo_epsilon),
+	    beauty[i].z() / std::max(a.z(), albedo_epsilon)
+	);
+	double a_lum = std::max(luminance(a), albedo_epsilon);
+	variance[i] = aov.variance[i] / (a_lum * a_lum);
+    }
+
+    // 샘플 수가 적으면 픽셀 안의 분산이 0으로 나오는 경우가 많음 (모든 샘플이 빛을 못 찾은 픽셀 등)
+    // -> 5x5 이웃 픽셀 값의 분산과 비교해서 큰 쪽을 사용
+    std::vector<double> next_variance(variance.size());
+    #pragma omp parallel for schedule(dynamic)
+    for (int y = 0; y < height; y++) {
+	for (int x = 0; x < width; x++) {
+	    double sum = 0, sq_sum = 0;
+	    int n = 0;
+	    for (int qy = std::max(0, y - 2); qy <= std::min(height - 1, y + 2); qy++)
+		for (int qx = std::max(0, x - 2); qx <= std::min(width - 1, x + 2); qx++) {
+		    double l = luminance(current[size_t(qy) * width + qx]);
+		    sum += l;
+		    sq_sum += l * l;
+		    n++;
+		}
+	    double mean = sum / n;
+	    size_t p = size_t(y) * width + x;
+	    next_variance[p] = std::max(variance[p], sq_sum / n - mean * mean);
+	}
+    }
+    variance.swap(next_variance);
+
+    std::vector<color> next(current.size());
+
+    for (int iteration = 0; iteration < params.iterations; iteration++) {
+	int step = 1 << iteration;
+	double inv_normal = 1.0 / (params.sigma_normal * params.sigma_normal);
+	double inv_albedo = 1.0 / (params.sigma_albedo * params.sigma_albedo);
+
+	#pragma omp parallel for schedule(dynamic)
+	for (int y = 0; y < height; y++) {
+	    for (int x = 0; x < width; x++) {
+		size_t p = size_t(y) * width + x;
+		const color& c_p = current[p];
+		double l_p = luminance(c_p);
+		double luminance_scale = 1.0 / (params.sigma_luminance * std::sqrt(variance[p]) + 1e-4);
+		const vec3& n_p = aov.normal[p];
+		const color& a_p = aov.albedo[p];
+		double z_p = aov.depth[p];
+		// 거리와 간격에 비례해서 깊이 허용 오차를 넓힘 (기울어진 면에서 멀리 떨어진 픽셀)
+		double depth_scale = 1.0 / (params.sigma_depth * std::max(z_p, 1e-6) * step);
+
+		color sum(0, 0, 0);
+		double weight_sum = 0;
+		double variance_sum = 0;
+		for (int dy = -2; dy <= 2; dy++) {
+		    int qy = y + dy * step;
+		    if (qy < 0 || qy >= height) continue;
+		    for (int dx = -2; dx <= 2; dx++) {
+			int qx = x + dx * step;
+			if (qx < 0 || qx >= width) continue;
+			size_t q = size_t(qy) * width + qx;
+
+			double w_color = std::fabs(l_p - luminance(current[q])) * luminance_scale;
+			double w_normal = (n_p - aov.normal[q]).length_squared() * inv_normal;
+			double w_albedo = (a_p - aov.albedo[q]).length_squared() * inv_albedo;
+			double w_depth = std::fabs(z_p - aov.depth[q]) * depth_scale;
+			double w = kernel[std::abs(dx)] * kernel[std::abs(dy)]
+			    * std::exp(-w_color - w_normal - w_albedo - w_depth);
+
+			sum += w * current[q];
+			weight_sum += w;
+			variance_sum += w * w * variance[q];
+		    }
+		}
+		// 중심 픽셀의 가중치는 항상 0보다 큼
+		// 필터링한 값의 분산 = sum(w^2 var) / (sum w)^2 -> 다음 반복에서 색 가중치가 점점 엄격해짐
+		next[p] = sum / weight_sum;
+		next_variance[p] = variance_sum / (weight_sum * weight_sum);
+	    }
+	}
+
+	current.swap(next);
+	variance.swap(next_variance);
+    }
+
+    // 다시 albedo 곱하기
+    for (size_t i = 0; i < current.size(); i++) {
+	const color& a = aov.albedo[i];
+	current[i] = color(
+	    current[i].x() * std::max(a.x(), albedo_epsilon),
+	    current[i].y() * std::max(a.y(), albedo_epsilon),
+	    current[i].z() * std::max(a.z(), albedo_epsilon)
+	);
+    }
+    return current;
+}
+
+// write_color로 저장한 P3 ppm 읽기 (감마 적용된 0~255 값)
+inline bool read_ppm(const std::string& filename, int& width, int& height, std::vector<unsigned char>& bytes) {
+    std::ifstream in(filename);
+    std::string magic;
+    int max_value;
+    if (!(in >> magic >> width >> height >> max_value) || magic != "P3")
+	return false;
+
+    bytes.resize(size_t(width) * height * 3);
+    for (auto& b : bytes) {
+	int value;
+	if (!(in >> value))
+	    return false;
+	b = (unsigned char)value;
+    }
+    return true;
+}
+
+// 선형 이미지를 저장할 때와 같은 변환(감마 2, 8비트)을 거친 뒤 기준 이미지와의 RMSE ([0, 1] 범위)
+inline double image_rmse(const std::vector<color>& image, const std::vector<unsigned char>& reference) {
+    std::vector<unsigned char> bytes(image.size() * 3);
+    if (!image.empty())
+	simd().linear_to_gamma_bytes(image[0].e, bytes.size(), bytes.data());
+
+    double sum = 0;
+    for (size_t i = 0; i < bytes.size(); i++) {
+	double diff = (double(bytes[i]) - double(reference[i])) / 255.0;
+	sum += diff * diff;
+    }
+    return bytes.empty() ? 0 : std::sqrt(sum / bytes.size());
+}
+
+#endif
@@ -0,0 +1,191 @@
+#ifndef ENVIRONMENT_H
+#define ENVIRONMENT_H
+
+// Equirectangular(위도-경도) HDR 환경 맵 조명
+// 물체에 맞지 않고 빠져나간 레이는 camera::background 대신 방향에 해당하는 환경 맵 픽셀 값을 받음
+//
+// 태양처럼 작고 밝은 부분이 있으면 반사 방향을 랜덤하게 골라서는 거의 맞지 않음
+// -> 픽셀 밝기 * sin(theta)에 비례하는 2D 분포(행 marginal CDF + 행마다 conditional CDF)를 만들어서
+//    밝은 방향을 직접 샘플링 (next event estimation), BSDF 샘플링과는 MIS로 합침
+//
+// 좌표: 이미지 맨 윗줄이 +y, u는 sphere::get_sphere_uv와 같은 방향 (u = 0.5가 +x)
+
+#include "rtw_stb_image.h"
+
+#include <string>
+
+class environment_map {
+public:
+    // rtw_image의 float 경로로 읽음 (.hdr은 [0, 1]로 잘리지 않은 선형 값)
+    // rotation: y축 회전 (도), intensity: 밝기 배율
+    environment_map(const char* filename, double intensity = 1.0, double rotation = 0.0)
+	: intensity(intensity), rotation(rotation)
+    {
+	rtw_image image(filename);
+	width = image.width();
+	height = image.height();
+	pixels.resize(size_t(width) * height);
+	for (int y = 0; y < height; y++)
+	    for (int x = 0; x < width; x++) {
+		const float* rgb = image.float_pixel_data(x, y);
+		pixels[size_t(y) * width + x] = color(rgb[0], rgb[1], rgb[2]);
+	    }
+	build_distribution();
+    }
+
+    // 이미 메모리에 있는 선형 RGB 픽셀 (width * height, 맨 윗줄부터)
+    environment_map(int width, int height, std::vector<color> pixels,
+	double intensity = 1.0, double rotation = 0.0)
+	: width(width), height(height), pixels(std::move(pixels)), intensity(intensity), rotation(rotation)
+    {
+	build_distribution();
+    }
+
+    bool valid() const { return width > 0 && height > 0; }
+
+    // 방향 -> 환경 맵 값
+    color value(const vec3& direction) const {
+	if (!valid())
+	    return color(0, 0, 0);
+	int x, y;
+	direction_to_pixel(unit_vector(direction), x, y);
+	return intensity * pixels[size_t(y) * width + x];
+    }
+
+    // 밝기에 비례해서 방향 하나를 고름
+    // pdf: 고른 방향의 입체각 밀도, 리턴값: 그 방향의 환경 맵 값
+    color sample(const sample2& s, vec3& direction, double& pdf) const {
+	pdf = 0;
+	if (total == 0)
+	    return color(0, 0, 0);
+
+	double dv;
+	int y = sample_cdf(&marginal_cdf[0], height, s.v, dv);
+	double du;
+	int x = sample_cdf(&conditional_cdf[size_t(y) * (width + 1)], width, s.u, du);
+
+	double u = (x + du) / width;
+	double v = (y + dv) / height;
+	double theta = pi * v;
+	double sin_theta = std::sin(theta);
+	if (sin_theta <= 0)
+	    return color(0, 0, 0);
+
+	double phi = 2 * pi * (u + rotation / 360.0);
+	direction = vec3(-std::cos(phi) * sin_theta, std::cos(theta), std::sin(phi) * sin_theta);
+
+	// [0, 1]^2 위의 밀도 -> 입체각 밀도 (du dv = sin(theta) dtheta dphi / (2 pi^2))
+	pdf = weights[size_t(y) * width + x] / total / (2 * pi * pi * sin_theta);
+	return intensity * pixels[size_t(y) * width + x];
+    }
+
+    // sample()이 direction을 고를 입체각 밀도 (MIS 가중치용)
+    double pdf(const vec3& direction) const {
+	if (total == 0)
+	    return 0;
+	vec3 d = unit_vector(direction);
+	double sin_theta = std::sqrt(std::fmax(0.0, 1 - d.y() * d.y()));
+	if (sin_theta <= 0)
+	    return 0;
+	int x, y;
+	direction_to_pixel(d, x, y);
+	return weights[size_t(y) * width + x] / total / (2 * pi * pi * sin_theta);
+    }
+
+    size_t memory_bytes() const {
+	return pixels.size() * sizeof(color) + weights.size() * sizeof(double)
+	    + marginal_cdf.size() * sizeof(double) + conditional_cdf.size() * sizeof(double);
+    }
+
+private:
+    int width = 0, height = 0;
+    std::vector<color> pixels;
+    double intensity;
+    double rotation;
+
+    std::vector<double> weights;         // 픽셀 밝기 * sin(theta)
+    std::vector<double> marginal_cdf;    // height + 1개, 행 선택
+    std::vector<double> conditional_cdf; // 행마다 width + 1개, 열 선택
+    double total = 0;                    // weights 평균 ([0, 1]^2 위 밀도의 정규화 상수)
+
+    void build_distribution() {
+	if (!valid())
+	    return;
+
+	weights.resize(pixels.size());
+	marginal_cdf.assign(height + 1, 0.0);
+	conditional_cdf.assign(size_t(height) * (width + 1), 0.0);
+
+	for (int y = 0; y < height; y++) {
+	    // 극으로 갈수록 픽셀 하나가 차지하는 입체각이 sin(theta)만큼 줄어듦
+	    double sin_theta = std::sin(pi * (y + 0.5) / height);
+	    double* cdf = &conditional_cdf[size_t(y) * (width + 1)];
+	    for (int x = 0; x < width; x++) {
+		size_t p = size_t(y) * width + x;
+		weights[p] = std::fmax(0.0, luminance(pixels[p])) * sin_theta;
+		cdf[x + 1] = cdf[x] + weights[p];
+	    }
+	    double row_sum = cdf[width];
+	    marginal_cdf[y + 1] = marginal_cdf[y] + row_sum;
+	    for (int x = 1; x <= width; x++)
+		cdf[x] = row_sum > 0 ? cdf[x] / row_sum : double(x) / width;
+	}
+
+	double sum = marginal_cdf[height];
+	total = sum / (double(width) * height);
+	for (int y = 1; y <= height; y++)
+	    marginal_cdf[y] = sum > 0 ? marginal_cdf[y] / sum : double(y) / height;
+    }
+
+    // cdf[0..n]에서 xi가 들어가는 칸과 칸 안의 위치 [0, 1)
+    static int sample_cdf(const double* cdf, int n, double xi, double& offset) {
+	int i = int(std::upper_bound(cdf, cdf + n + 1, xi) - cdf) - 1;
+	i = std::max(0, std::min(n - 1, i));
+	// 가중치가 0인 칸은 고를 수 없음 (upper_bound가 건너뜀)
+	double size = cdf[i + 1] - cdf[i];
+	offset = size > 0 ? (xi - cdf[i]) / size : 0.5;
+	offset = std::min(offset, 0.99999999);
+	return i;
+    }
+
+    void direction_to_pixel(const vec3& d, int& x, int& y) const {
+	double theta = std::acos(std::fmax(-1.0, std::fmin(1.0, d.y())));
+	double u = (std::atan2(d.z(), -d.x()) / (2 * pi)) - rotation / 360.0;
+	u -= std::floor(u);
+	x = std::min(width - 1, int(u * width));
+	y = std::min(height - 1, int(theta / pi * height));
+    }
+};
+
+// MIS power heuristic (beta = 2)
+inline double power_heuristic(double pdf_a, double pdf_b) {
+    double a2 = pdf_a * pdf_a;
+    double b2 = pdf_b * pdf_b;
+    return a2 + b2 > 0 ? a2 / (a2 + b2) : 0;
+}
+
+// 파일이 없을 때 쓰는 간단한 하늘: 위쪽 파란 그라데이션 + 지평선 흰색 + 작고 밝은 태양
+inline std::vector<color> procedural_sky(int width, int height, const vec3& sun_direction,
+    double sun_angle = 2.0, double sun_intensity = 2000.0)
+{
+    vec3 sun = unit_vector(sun_direction);
+    double cos_sun = std::cos(degrees_to_radians(sun_angle / 2));
+    std::vector<color> pixels(size_t(width) * height);
+    for (int y = 0; y < height; y++) {
+	double theta = pi * (y + 0.5) / height;
+	for (int x = 0; x < width; x++) {
+	    double phi = 2 * pi * (x + 0.5) / width;
+	    vec3 d(-std::cos(phi) * std::sin(theta), std::cos(theta), std::sin(phi) * std::sin(theta));
+	    double t = 0.5 * (d.y() + 1.0);
+	    color sky = (1.0 - t) * color(1.0, 1.0, 1.0) + t * color(0.3, 0.5, 1.0);
+	    if (d.y() < 0)
+		sky = color(0.25, 0.22, 0.2); // 지면
+	    if (dot(d, sun) >= cos_sun)
+		sky = color(sun_intensity, sun_intensity * 0.9, sun_intensity * 0.75);
+	    pixels[size_t(y) * width + x] = sky;
+	}
+    }
+    return pixels;
+}
+
+#endif
@@ -0,0 +1,67 @@
+﻿#ifndef HEATMAP_H
+#define HEATMAP_H
+
+// 디버그용 heatmap 이미지 (BVH 순회 비용, 픽셀당 렌더 시간)
+// 값을 false-color로 바꿔 ppm으로 저장
+
+#include <cstdint>
+#include <string>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+// CPU 타임스탬프 카운터 읽기
+// x86이 아니면 steady_clock 나노초로 대신함
+inline uint64_t read_tsc() {
+#if defined(_MSC_VER) || defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(
+	std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+}
+
+// [0,1] 값을 파랑 -> 청록 -> 초록 -> 노랑 -> 빨강으로 매핑
+inline color false_color(double t) {
+    static const color stops[] = {
+	color(0.0, 0.0, 0.5),
+	color(0.0, 0.6, 1.0),
+	color(0.1, 0.9, 0.2),
+	color(1.0, 0.9, 0.0),
+	color(1.0, 0.0, 0.0)
+    };
+    const int last = 4;
+
+    t = interval(0, 1).clamp(t) * last;
+    int i = int(t);
+    if (i >= last) return stops[last];
+    double f = t - i;
+    return (1 - f) * stops[i] + f * stops[i + 1];
+}
+
+// 값 배열을 false-color ppm으로 저장
+// 튀는 값 몇 개 때문에 전체가 어두워지지 않도록 99 percentile을 최댓값으로 사용
+// 리턴값은 정규화에 사용한 최댓값
+inline double write_heatmap(const std::vector<double>& values, int width, int height,
+    const std::string& filename)
+{
+    std::vector<double> sorted(values);
+    std::sort(sorted.begin(), sorted.end());
+    double max_value = sorted.empty() ? 0 : sorted[size_t((sorted.size() - 1) * 0.99)];
+    if (max_value <= 0) max_value = 1;
+
+    std::ofstream out(filename);
+    out << "P3\n" << width << " " << height << "\n255\n";
+    for (double value : values) {
+	color c = false_color(value / max_value);
+	out << int(255.999 * c.x()) << " " << int(255.999 * c.y()) << " "
+	    << int(255.999 * c.z()) << "\n";
+    }
+
+    return max_value;
+}
+
+#endif
@@ -2,6 +2,7 @@
 #define HITTABLE_H
 
 class material;
+class hittable;
 
 // hit 정보
 class hit_record {
@@ -14,16 +15,41 @@ public:
     // 텍스처 (u,v) 좌표
     double u;
     double v;
+    // p의 반올림 오차 한계 (float 정점 메시에서만 0보다 큼)
+    // 다음 레이의 원점을 이만큼 법선 방향으로 밀어서 같은 면에 다시 맞지 않게 함
+    double offset = 0;
+    // 충돌한 씬 오브젝트 (바깥쪽 bvh_node의 리프, tile_dependencies.h의 의존성 추적용)
+    // BVH 없이 hittable_list만 쓰면 nullptr
+    const hittable* object = nullptr;
 
     // outward_normal은 기존에 구한 법선 벡터
     // outward_normal은 단위 벡터라고 가정
+    // 새 충돌 정보를 채우는 것이므로 이전 충돌의 offset도 지움
     void set_face_normal(const ray& r, const vec3& outward_normal) {
         front_face = dot(r.direction(), outward_normal) < 0;
         // 항상 레이의 반대 방향으로 설정
         normal = front_face ? outward_normal : -outward_normal; // front_face면 바깥으로 나가는 방향 그대로, 아니면 반대로
+        offset = 0;
+    }
+
+    // 충돌 지점에서 direction 방향으로 나가는 레이 (산란, 그림자 레이)
+    // offset이 있으면 원점을 direction이 있는 쪽 면으로 밀어냄 (반사는 바깥, 굴절은 안쪽)
+    ray spawn_ray(const vec3& direction, double time) const {
+        if (offset <= 0)
+            return ray(p, direction, time);
+        vec3 n = dot(direction, normal) > 0 ? normal : -normal;
+        return ray(p + offset * n, direction, time);
     }
 };
 
+// 경로 하나에서 stochastic LOD 선택에 사용할 난수 (lod_mesh.h)
+// 카메라가 primary ray마다 새로 뽑음
+// 같은 경로의 모든 레이가 같은 LOD를 보게 해서 서로 다른 LOD 표면 사이에서 self-intersection이 생기지 않게 함
+inline double& path_lod_sample() {
+    thread_local double sample = 0;
+    return sample;
+}
+
 // hittable한 오브젝트의 부모가 될 추상 클래스
 class hittable {
 public:
@@ -32,8 +58,29 @@ public:
     virtual bool hit(const ray& r, interval ray_t, hit_record& rec) const = 0;
     // 오브젝트의 바운딩 박스 리턴하는 메서드
     virtual aabb bounding_box() const = 0;
+
+    // ray_t 구간 안에 무엇이든 하나라도 맞는지 (그림자 레이, AO 등 가시성 검사)
+    // 가장 가까운 교차를 찾지 않고 처음 찾은 교차에서 바로 리턴, hit_record는 만들지 않음
+    // 기본 구현은 hit()을 그대로 쓰므로 더 싸게 검사할 수 있는 오브젝트가 재정의
+    virtual bool occluded(const ray& r, interval ray_t) const {
+        hit_record rec;
+        return hit(r, ray_t, rec);
+    }
+
+    // ray_t 구간을 가려지지 않고 통과할 확률 (광원 직접 샘플링의 그림자 레이)
+    // 표면은 맞으면 0, 아니면 1 / 참여 매질은 ratio tracking으로 추정한 투과율
+    virtual double transmittance(const ray& r, interval ray_t) const {
+        return occluded(r, ray_t) ? 0.0 : 1.0;
+    }
+
+    // 변환 행렬 m을 기하 데이터에 직접 적용한 새 오브젝트 (make_transformed에서 사용)
+    // 래퍼 없이 표현할 수 없거나 래퍼보다 비싸면 nullptr
+    virtual shared_ptr<hittable> bake_transform(const matrix4& m) const { return nullptr; }
 };
 
+// object에 변환 m을 적용한 오브젝트 (아래에서 정의)
+inline shared_ptr<hittable> make_transformed(shared_ptr<hittable> object, const matrix4& m);
+
 class translate : public hittable {
 public:
     translate(shared_ptr<hittable> object, const vec3& offset)
@@ -55,10 +102,121 @@ public:
         return true;
     }
 
+    bool occluded(const ray& r, interval ray_t) const override {
+        return object->occluded(ray(r.origin() - offset, r.direction(), r.time()), ray_t);
+    }
+
+    double transmittance(const ray& r, interval ray_t) const override {
+        return object->transmittance(ray(r.origin() - offset, r.direction(), r.time()), ray_t);
+    }
+
     aabb bounding_box() const override { return bbox; }
+
+    // 바깥 변환과 합쳐서 안쪽 오브젝트에 한 번에 적용 (래퍼 한 단계 제거)
+    shared_ptr<hittable> bake_transform(const matrix4& m) const override {
+        return make_transformed(object, m * matrix4::translation(offset));
+    }
+
+    const shared_ptr<hittable>& get_object() const { return object; }
 private:
     shared_ptr<hittable> object;
     vec3 offset;
     aabb bbox;
 };
+
+// 일반 affine 변환 (회전, 비균등 스케일, 기울이기 등)
+// 레이를 역행렬로 물체 공간에 옮겨서 검사하고, 충돌 지점과 법선을 다시 월드 공간으로 옮김
+// 방향 벡터를 정규화하지 않으므로 t는 두 공간에서 같은 값
+class transform : public hittable {
+public:
+    transform(shared_ptr<hittable> object, const matrix4& m)
+        : object(object), m(m), inv(m.inverse())
+    {
+        // 물체 bbox의 8개 꼭짓점을 변환한 점들을 감싸는 bbox
+        aabb box = object->bounding_box();
+        bool first = true;
+        for (int i = 0; i < 8; i++) {
+            point3 corner(
+                (i & 1) ? box.x.max : box.x.min,
+                (i & 2) ? box.y.max : box.y.min,
+                (i & 4) ? box.z.max : box.z.min
+            );
+            point3 p = m.transform_point(corner);
+            aabb corner_box(p, p);
+            bbox = first ? corner_box : aabb(bbox, corner_box);
+            first = false;
+        }
+    }
+
+    bool hit(const ray& r, interval ray_t, hit_record& rec) const override {
+        return hit_transformed(*object, m, inv, r, ray_t, rec);
+    }
+
+    // m(물체 공간 -> 월드 공간) / inv로 옮긴 object에 대한 hit
+    // 시간마다 행렬이 바뀌는 래퍼(animated_transform)도 같은 계산을 씀
+    static bool hit_transformed(const hittable& object, const matrix4& m, const matrix4& inv,
+        const ray& r, interval ray_t, hit_record& rec)
+    {
+        ray local_ray(inv.transform_point(r.origin()), inv.transform_vector(r.direction()), r.time());
+
+        if (!object.hit(local_ray, ray_t, rec))
+            return false;
+
+        // 물체 공간의 바깥 방향 법선을 inverse transpose로 옮긴 뒤 월드 레이 기준으로 다시 방향 결정
+        vec3 outward_normal = rec.front_face ? rec.normal : -rec.normal;
+        double offset = rec.offset;
+        rec.p = m.transform_point(rec.p);
+        rec.set_face_normal(r, unit_vector(inv.transform_normal(outward_normal)));
+
+        // 물체 공간의 오차 한계를 변환의 최대 늘림 비율(열 벡터 길이의 합 이하)로 키움
+        if (offset > 0) {
+            double stretch = m.transform_vector(vec3(1, 0, 0)).length()
+                + m.transform_vector(vec3(0, 1, 0)).length()
+                + m.transform_vector(vec3(0, 0, 1)).length();
+            rec.offset = offset * stretch;
+        }
+        return true;
+    }
+
+    // 충돌 지점 / 법선을 월드 공간으로 옮길 필요가 없음
+    bool occluded(const ray& r, interval ray_t) const override {
+        ray local_ray(inv.transform_point(r.origin()), inv.transform_vector(r.direction()), r.time());
+        return object->occluded(local_ray, ray_t);
+    }
+
+    double transmittance(const ray& r, interval ray_t) const override {
+        ray local_ray(inv.transform_point(r.origin()), inv.transform_vector(r.direction()), r.time());
+        return object->transmittance(local_ray, ray_t);
+    }
+
+    aabb bounding_box() const override { return bbox; }
+
+    shared_ptr<hittable> bake_transform(const matrix4& outer) const override {
+        return make_transformed(object, outer * m);
+    }
+
+    const shared_ptr<hittable>& get_object() const { return object; }
+
+private:
+    shared_ptr<hittable> object;
+    matrix4 m;   // 물체 공간 -> 월드 공간
+    matrix4 inv; // 월드 공간 -> 물체 공간
+    aabb bbox;
+};
+
+// 변환 래퍼 체인을 만들지 않고 하나로 합친 오브젝트
+// 1. 단위 행렬이면 object 그대로
+// 2. object가 변환을 직접 받을 수 있으면 (bake_transform) 변환된 기하 데이터
+//    - translate / transform 래퍼는 자기 행렬을 곱해서 안쪽 오브젝트로 넘김 -> 체인이 행렬 하나로 합쳐짐
+//    - sphere는 이동 + 균등 스케일, quad / triangle은 모든 affine 변환을 꼭짓점에 적용
+// 3. 이동만 있으면 translate, 나머지는 transform 래퍼 하나
+inline shared_ptr<hittable> make_transformed(shared_ptr<hittable> object, const matrix4& m) {
+    if (m.is_identity())
+        return object;
+    if (auto baked = object->bake_transform(m))
+        return baked;
+    if (m.is_translation())
+        return arena_make_shared<translate>(object, m.get_translation());
+    return arena_make_shared<transform>(object, m);
+}
 #endif
\ No newline at end of file
@@ -42,9 +42,70 @@ public:
         return hit_anything;
     }
 
+    // 하나라도 맞으면 바로 true (순서 / 거리 상관없음)
+    bool occluded(const ray& r, interval ray_t) const override {
+        for (const auto& object : objects)
+            if (object->occluded(r, ray_t))
+                return true;
+        return false;
+    }
+
+    // 겹친 오브젝트들의 투과율 곱 (하나라도 완전히 가리면 바로 0)
+    double transmittance(const ray& r, interval ray_t) const override {
+        double result = 1.0;
+        for (const auto& object : objects) {
+            result *= object->transmittance(r, ray_t);
+            if (result == 0)
+                break;
+        }
+        return result;
+    }
+
     aabb bounding_box() const override{
         return bbox;
     }
+
+    // 모든 오브젝트가 변환을 받을 수 있을 때만 오브젝트마다 적용한 새 리스트
+    // (하나라도 안 되면 리스트 전체를 감싸는 래퍼 하나가 더 쌈)
+    shared_ptr<hittable> bake_transform(const matrix4& m) const override {
+        auto baked = arena_make_shared<hittable_list>();
+        for (const auto& object : objects) {
+            auto transformed = object->bake_transform(m);
+            if (!transformed)
+                return nullptr;
+            baked->add(transformed);
+        }
+        return baked;
+    }
 };
 
+// 씬 컴파일 단계 (월드 BVH를 만들기 전)에 translate / transform 래퍼 체인을 합침
+// 체인마다 행렬 하나 + 역행렬 하나의 래퍼로 줄이고, 가능하면 기하 데이터에 직접 적용해서 래퍼를 없앰
+// 리스트 안의 오브젝트도 재귀적으로 처리
+inline shared_ptr<hittable> collapse_transforms(const shared_ptr<hittable>& object);
+
+inline void collapse_transforms(hittable_list& list) {
+    hittable_list collapsed;
+    for (const auto& object : list.objects)
+        collapsed.add(collapse_transforms(object));
+    list = collapsed; // bbox도 다시 계산됨
+}
+
+inline shared_ptr<hittable> collapse_transforms(const shared_ptr<hittable>& object) {
+    if (auto list = std::dynamic_pointer_cast<hittable_list>(object)) {
+        collapse_transforms(*list);
+        return object;
+    }
+    if (!std::dynamic_pointer_cast<translate>(object) && !std::dynamic_pointer_cast<transform>(object))
+        return object;
+
+    auto folded = object->bake_transform(matrix4::identity());
+    // 합친 뒤에도 래퍼가 남으면 (안쪽이 변환을 받을 수 없는 경우) 안쪽 리스트의 래퍼도 합침
+    if (auto t = std::dynamic_pointer_cast<translate>(folded))
+        collapse_transforms(t->get_object());
+    else if (auto t = std::dynamic_pointer_cast<transform>(folded))
+        collapse_transforms(t->get_object());
+    return folded;
+}
+
 #endif
\ No newline at end of file
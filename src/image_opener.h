@@ -5,7 +5,7 @@
 #include <string>
 #include <cstdlib>
 
-void openImage(const std::string& filename) {
+inline void openImage(const std::string& filename) {
     std::string command;
 
 #ifdef _WIN32 // Windows ȯ 
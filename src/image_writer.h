@@ -0,0 +1,94 @@
+#ifndef IMAGE_WRITER_H
+#define IMAGE_WRITER_H
+
+// 렌더와 동시에 ppm을 저장하는 writer 스레드
+// 렌더 스레드는 끝난 줄(tile)을 넘기기만 하고, 감마 변환 + 포맷팅 + 파일 쓰기는 writer 스레드가 함
+// ppm은 위에서부터 순서대로 써야 하므로 앞 줄이 모두 도착한 만큼만 이어서 씀
+// -> 렌더가 끝날 때 남는 저장 작업은 마지막 몇 줄뿐
+// 줄이 다 오기 전에 끝나면(렌더 중단 등) 빠진 줄은 검은색으로 채워서 헤더 크기와 맞는 ppm을 남김
+
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+
+class async_image_writer {
+public:
+    async_image_writer(const std::string& filename, int width, int height)
+	: out(filename, std::ios::binary), width(width), height(height)
+    {
+	out << "P3\n" << width << " " << height << "\n255\n";
+	worker = std::thread(&async_image_writer::run, this);
+    }
+
+    ~async_image_writer() { finish(); }
+
+    // row부터 rows줄의 픽셀 (width * rows개, 복사해서 보관)
+    // 여러 렌더 스레드에서 동시에 호출 가능
+    void submit(int row, int rows, const color* pixels) {
+	std::vector<color> tile(pixels, pixels + size_t(width) * rows);
+	{
+	    std::lock_guard<std::mutex> lock(mutex);
+	    pending[row] = std::make_pair(rows, std::move(tile));
+	}
+	ready.notify_one();
+    }
+
+    // 모든 줄이 써질 때까지 기다림 (아직 오지 않은 줄은 검은색으로 씀)
+    void finish() {
+	if (!worker.joinable())
+	    return;
+	{
+	    std::lock_guard<std::mutex> lock(mutex);
+	    finishing = true;
+	}
+	ready.notify_one();
+	worker.join();
+	out.close();
+    }
+
+private:
+    std::ofstream out;
+    int width, height;
+    std::thread worker;
+
+    std::mutex mutex;
+    std::condition_variable ready;
+    std::map<int, std::pair<int, std::vector<color>>> pending; // 시작 줄 -> (줄 수, 픽셀)
+    bool finishing = false;
+
+    void run() {
+	int next_row = 0;
+	std::string text;
+
+	while (next_row < height) {
+	    std::vector<color> tile;
+	    int rows = 0;
+	    {
+		std::unique_lock<std::mutex> lock(mutex);
+		ready.wait(lock, [&] {
+		    return finishing || (!pending.empty() && pending.begin()->first == next_row);
+		});
+		if (pending.empty() || pending.begin()->first != next_row) {
+		    // 줄이 빠진 채로 끝남 (렌더 중단 등): 다음에 도착해 있는 줄(없으면 마지막 줄)까지 검은색
+		    rows = (pending.empty() ? height : pending.begin()->first) - next_row;
+		    tile.assign(size_t(width) * rows, color(0, 0, 0));
+		}
+		else {
+		    rows = pending.begin()->second.first;
+		    tile = std::move(pending.begin()->second.second);
+		    pending.erase(pending.begin());
+		}
+	    }
+
+	    // 잠금 밖에서 변환 + 쓰기
+	    text.clear();
+	    format_ppm_pixels(tile.data(), tile.size(), text);
+	    out.write(text.data(), text.size());
+	    next_row += rows;
+	}
+    }
+};
+
+#endif
@@ -1,59 +1,68 @@
 ﻿#ifndef INTERVAL_H
 #define INTERVAL_H
 
-class interval {
+// 스칼라 타입으로 매개화한 구간 (interval = basic_interval<double>)
+template <typename T>
+class basic_interval {
     public:
-	double min, max;
+	typedef T value_type;
+	T min, max;
 
-	interval() : min(+infinity), max(-infinity) {}
+	basic_interval() : min(T(+infinity)), max(T(-infinity)) {}
 
-	interval(double min, double max) : min(min), max(max) {}
+	basic_interval(T min, T max) : min(min), max(max) {}
 
-	interval(const interval& a, const interval& b) {
+	basic_interval(const basic_interval& a, const basic_interval& b) {
 	    min = (a.min <= b.min) ? a.min : b.min;
 	    max = (a.max >= b.max) ? a.max : b.max;
 	}
 
 	// 구간 크기
-	double size() const {
+	T size() const {
 	    return max - min;
 	}
 
 	// x가 구간 안에 있는지? (양끝 포함)
-	bool contains(double x) const {
+	bool contains(T x) const {
 	    return min <= x && x <= max;
 	}
 
 	// x가 구간 안에 있는지? (양끝 제외)
-	bool surrounds(double x) const {
+	bool surrounds(T x) const {
 	    return min < x && x < max;
 	}
 
 	// x가 구간 안에 있는 경우에만 x 리턴
 	// min 또는 max 경계를 넘어가면 경계값으로 설정
-	double clamp(double x) const {
+	T clamp(T x) const {
 	    if (x < min) return min;
 	    if (x > max) return max;
 	    return x;
 	}
 
 	// 구간의 범위를 delta만큼 증가 -> 양 끝을 delta/2만큼 늘림
-	interval expand(double delta) const {
-	    double padding = delta / 2.0f;
-	    return interval(min - padding, max + padding);
+	basic_interval expand(T delta) const {
+	    T padding = delta / 2.0f;
+	    return basic_interval(min - padding, max + padding);
 	}
 
-	static const interval empty, universe;
+	static const basic_interval empty, universe;
 };
 
-const interval interval::empty = interval(+infinity, -infinity);
-const interval interval::universe = interval(-infinity, infinity);
+template <typename T>
+const basic_interval<T> basic_interval<T>::empty = basic_interval<T>(T(+infinity), T(-infinity));
+template <typename T>
+const basic_interval<T> basic_interval<T>::universe = basic_interval<T>(T(-infinity), T(infinity));
 
-interval operator+(const interval& ival, double displacement) {
-    return interval(ival.min + displacement, ival.max + displacement);
+using interval = basic_interval<double>;
+
+template <typename T>
+inline basic_interval<T> operator+(const basic_interval<T>& ival, typename basic_interval<T>::value_type displacement) {
+    return basic_interval<T>(ival.min + displacement, ival.max + displacement);
 }
 
-interval operator+(double displacement, const interval& ival) {
+template <typename T>
+inline basic_interval<T> operator+(typename basic_interval<T>::value_type displacement, const basic_interval<T>& ival) {
     return ival + displacement;
 }
 
@@ -0,0 +1,252 @@
+#ifndef LOCAL_SOCKET_H
+#define LOCAL_SOCKET_H
+
+// 같은 컴퓨터 안에서만 쓰는 Unix domain socket (render_server.h, render_client.cpp)
+// Linux는 POSIX 소켓, Windows는 Winsock의 AF_UNIX (Windows 10 1803 이상)
+// 요청 / 응답 헤더는 한 줄 텍스트, 픽셀은 그 뒤에 바이너리로 보냄
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <winsock2.h>
+#include <afunix.h>
+#ifdef _MSC_VER
+#pragma comment(lib, "Ws2_32.lib")
+#endif
+#else
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+// 기본 소켓 경로
+inline std::string default_socket_path() {
+#ifdef _WIN32
+    const char* temp = std::getenv("TEMP");
+    return std::string(temp ? temp : ".") + "\\rt_render.sock";
+#else
+    return "/tmp/rt_render.sock";
+#endif
+}
+
+class local_socket {
+public:
+#ifdef _WIN32
+    typedef SOCKET handle_type;
+    static constexpr handle_type invalid_handle = INVALID_SOCKET;
+#else
+    typedef int handle_type;
+    static constexpr handle_type invalid_handle = -1;
+#endif
+
+    local_socket() {}
+    explicit local_socket(handle_type handle) : handle(handle) {}
+    ~local_socket() { close(); }
+
+    local_socket(local_socket&& other) noexcept : handle(other.handle), buffer(std::move(other.buffer)) {
+	other.handle = invalid_handle;
+    }
+    local_socket& operator=(local_socket&& other) noexcept {
+	if (this != &other) {
+	    close();
+	    handle = other.handle;
+	    buffer = std::move(other.buffer);
+	    other.handle = invalid_handle;
+	}
+	return *this;
+    }
+    local_socket(const local_socket&) = delete;
+    local_socket& operator=(const local_socket&) = delete;
+
+    bool is_open() const { return handle != invalid_handle; }
+
+    // 서버: path에 소켓을 만들고 연결 대기 (실패하면 닫힌 소켓, 이유는 error에)
+    // 이전 실행이 남긴 소켓 파일만 지움: 소켓이 아닌 파일이거나 아직 연결을 받는 서버가 있으면 건드리지 않고 실패
+    static local_socket listen_on(const std::string& path, std::string& error) {
+	startup();
+	local_socket s(::socket(AF_UNIX, SOCK_STREAM, 0));
+	sockaddr_un addr;
+	if (!s.is_open() || !make_address(path, addr)) {
+	    error = "소켓을 만들 수 없음";
+	    return local_socket();
+	}
+
+	bool is_socket;
+	if (file_exists(path, is_socket)) {
+	    if (!is_socket) {
+		error = "소켓이 아닌 파일이 이미 있음";
+		return local_socket();
+	    }
+	    if (connect_to(path).is_open()) {
+		error = "다른 서버가 이미 사용 중";
+		return local_socket();
+	    }
+	    remove_file(path);
+	}
+
+	if (::bind(s.handle, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0
+	    || ::listen(s.handle, 16) != 0) {
+	    error = "bind / listen 실패";
+	    return local_socket();
+	}
+	return s;
+    }
+
+    // 클라이언트: path의 서버에 연결
+    static local_socket connect_to(const std::string& path) {
+	startup();
+	local_socket s(::socket(AF_UNIX, SOCK_STREAM, 0));
+	sockaddr_un addr;
+	if (!s.is_open() || !make_address(path, addr))
+	    return local_socket();
+	if (::connect(s.handle, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0)
+	    return local_socket();
+	return s;
+    }
+
+    // 연결 하나 받기 (실패하면 닫힌 소켓)
+    local_socket accept_one() const {
+	return local_socket(::accept(handle, nullptr, nullptr));
+    }
+
+    // size 바이트를 모두 보냄 (상대가 연결을 끊었으면 false)
+    bool send_all(const void* data, size_t size) {
+	const char* p = static_cast<const char*>(data);
+	while (size > 0) {
+	    int chunk = int(std::min<size_t>(size, 1 << 20));
+	    auto sent = ::send(handle, p, chunk, send_flags());
+	    if (sent <= 0)
+		return false;
+	    p += sent;
+	    size -= size_t(sent);
+	}
+	return true;
+    }
+
+    bool send_line(const std::string& line) {
+	std::string text = line + "\n";
+	return send_all(text.data(), text.size());
+    }
+
+    // '\n'까지 한 줄 읽기 ('\n'은 빼고, 연결이 끊기면 false)
+    bool recv_line(std::string& line) {
+	for (;;) {
+	    size_t end = buffer.find('\n');
+	    if (end != std::string::npos) {
+		line = buffer.substr(0, end);
+		buffer.erase(0, end + 1);
+		return true;
+	    }
+	    if (!fill())
+		return false;
+	}
+    }
+
+    // 정확히 size 바이트 읽기
+    bool recv_exact(void* data, size_t size) {
+	char* p = static_cast<char*>(data);
+	while (size > 0) {
+	    if (buffer.empty() && !fill())
+		return false;
+	    size_t n = std::min(size, buffer.size());
+	    std::memcpy(p, buffer.data(), n);
+	    buffer.erase(0, n);
+	    p += n;
+	    size -= n;
+	}
+	return true;
+    }
+
+    // 다른 스레드에서 막혀 있는 accept / recv를 깨움
+    void shutdown() {
+	if (is_open())
+	    ::shutdown(handle, 2); // SHUT_RDWR / SD_BOTH
+    }
+
+    void close() {
+	if (!is_open())
+	    return;
+#ifdef _WIN32
+	::closesocket(handle);
+#else
+	::close(handle);
+#endif
+	handle = invalid_handle;
+    }
+
+    static void remove_file(const std::string& path) {
+	std::remove(path.c_str());
+    }
+
+private:
+    handle_type handle = invalid_handle;
+    std::string buffer; // 받았지만 아직 꺼내지 않은 바이트
+
+    bool fill() {
+	char chunk[4096];
+	auto n = ::recv(handle, chunk, int(sizeof(chunk)), 0);
+	if (n <= 0)
+	    return false;
+	buffer.append(chunk, size_t(n));
+	return true;
+    }
+
+    // path에 파일이 있는지와 그 파일이 소켓인지
+    static bool file_exists(const std::string& path, bool& is_socket) {
+#ifdef _WIN32
+	// Windows의 AF_UNIX 소켓 파일은 reparse point
+	DWORD attributes = GetFileAttributesA(path.c_str());
+	if (attributes == INVALID_FILE_ATTRIBUTES)
+	    return false;
+	is_socket = (attributes & FILE_ATTRIBUTE_REPARSE_POINT) != 0;
+	return true;
+#else
+	struct stat info;
+	if (::lstat(path.c_str(), &info) != 0)
+	    return false;
+	is_socket = S_ISSOCK(info.st_mode);
+	return true;
+#endif
+    }
+
+    static bool make_address(const std::string& path, sockaddr_un& addr) {
+	std::memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	if (path.size() >= sizeof(addr.sun_path))
+	    return false;
+	std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+	return true;
+    }
+
+    // 끊긴 연결에 send해도 프로세스가 SIGPIPE로 종료되지 않게
+    static int send_flags() {
+#ifdef MSG_NOSIGNAL
+	return MSG_NOSIGNAL;
+#else
+	return 0;
+#endif
+    }
+
+    static void startup() {
+#ifdef _WIN32
+	static bool started = [] {
+	    WSADATA data;
+	    return WSAStartup(MAKEWORD(2, 2), &data) == 0;
+	}();
+	(void)started;
+#endif
+    }
+};
+
+#endif
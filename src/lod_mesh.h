@@ -0,0 +1,186 @@
+#ifndef LOD_MESH_H
+#define LOD_MESH_H
+
+// 여러 LOD(Level of Detail)를 가진 메시
+// 인스턴스가 화면에 투영된 크기를 보고 필요한 만큼의 삼각형을 가진 LOD만 불러옴
+// -> 멀리 있는 물체가 69k 삼각형짜리 BVH를 순회하지 않게 함
+//
+// LOD는 lod_mesh를 만들 때의 카메라로 한 번만 고르고 그 뒤로 바꾸지 않음
+// 애니메이션(animation.h)의 카메라 이동이나 렌더 서버 요청의 lookfrom / lookat / width는 LOD 선택에 반영되지 않음
+// (월드를 여러 프레임 / 요청이 같이 쓰므로 렌더 중에 LOD를 바꾸지 않음)
+
+// 하나의 모델에 대한 LOD 파일 목록
+class mesh_asset {
+public:
+    struct level {
+	std::string path;
+	size_t faces; // 면 개수
+	aabb bounds;  // 모델 좌표의 정점 범위 (변환 전)
+    };
+
+    mesh_asset() {}
+
+    // LOD 파일 등록
+    // 면 개수와 정점 범위는 파일에서 "f " / "v " 줄만 훑어서 구함 (파싱, BVH 빌드는 선택될 때만)
+    void add_lod(const std::string& path) {
+	std::ifstream file(path);
+	if (!file.is_open()) {
+	    std::cerr << "LOD 파일 읽기 중 오류 발생: " << path << "\n";
+	    return;
+	}
+
+	size_t faces = 0;
+	point3 lo(infinity, infinity, infinity), hi(-infinity, -infinity, -infinity);
+	std::string line;
+	while (std::getline(file, line)) {
+	    if (line.size() < 2 || line[1] != ' ')
+		continue;
+	    if (line[0] == 'f') {
+		faces++;
+	    }
+	    else if (line[0] == 'v') {
+		double v[3];
+		if (std::sscanf(line.c_str() + 2, "%lf %lf %lf", &v[0], &v[1], &v[2]) == 3) {
+		    lo = point3(std::fmin(lo.x(), v[0]), std::fmin(lo.y(), v[1]), std::fmin(lo.z(), v[2]));
+		    hi = point3(std::fmax(hi.x(), v[0]), std::fmax(hi.y(), v[1]), std::fmax(hi.z(), v[2]));
+		}
+	    }
+	}
+
+	levels.push_back({ path, faces, aabb(lo, hi) });
+
+	// 면이 많은 것(가장 자세한 것)부터 정렬
+	std::sort(levels.begin(), levels.end(),
+	    [](const level& a, const level& b) { return a.faces > b.faces; });
+    }
+
+    // source_path와 QEM으로 단순화한 LOD들을 등록 (mesh_simplify.h)
+    // 단순화 결과는 원본 옆에 캐시되므로 두 번째 실행부터는 파일만 읽음
+    void add_simplified_lods(const std::string& source_path,
+	const std::vector<size_t>& target_faces, double max_error = infinity)
+    {
+	add_lod(source_path);
+	for (const auto& path : build_lod_chain(source_path, target_faces, max_error))
+	    add_lod(path);
+    }
+
+    // 0이 가장 자세한 LOD
+    const std::vector<level>& get_levels() const { return levels; }
+
+private:
+    std::vector<level> levels;
+};
+
+// mesh_asset의 인스턴스
+// 생성할 때 카메라 기준 투영 크기로 LOD를 고름 -> 카메라 설정이 끝난 뒤 생성해야 함 (이후 고정)
+class lod_mesh : public hittable {
+private:
+    shared_ptr<polygon_mesh> fine;   // 선택된 LOD
+    shared_ptr<polygon_mesh> coarse; // stochastic 모드에서 섞을 한 단계 낮은 LOD
+    double coarse_probability = 0;   // coarse를 사용할 확률
+    aabb bbox;
+
+    static shared_ptr<polygon_mesh> load(const mesh_asset::level& level,
+	const shared_ptr<material>& mat, const point3& pos, const vec3& scale)
+    {
+	std::string path = level.path;
+	hittable_list unused;
+	return arena_make_shared<polygon_mesh>(path, mat, unused, pos, scale);
+    }
+
+public:
+    // triangles_per_pixel: 투영된 면적 1픽셀당 필요한 삼각형 수
+    // stochastic: true면 두 LOD 사이를 경로마다 확률적으로 섞어서 LOD 경계가 튀지 않게 함
+    lod_mesh(
+	const mesh_asset& asset,
+	const shared_ptr<material> mat,
+	const point3& pos,
+	const vec3& scale,
+	const camera& cam,
+	bool stochastic = false,
+	double triangles_per_pixel = 0.5
+    ) {
+	const auto& levels = asset.get_levels();
+	if (levels.empty()) {
+	    std::cerr << "LOD가 등록되지 않은 mesh_asset\n";
+	    return;
+	}
+
+	// 가장 자세한 LOD의 정점 범위로 크기를 잼 (add_lod에서 구해 둔 값이라 메시를 불러오지 않음)
+	size_t coarsest = levels.size() - 1;
+	const aabb& model = levels[0].bounds;
+	point3 model_min(model.x.min, model.y.min, model.z.min);
+	point3 model_max(model.x.max, model.y.max, model.z.max);
+	double pixels = projected_diameter(aabb(pos + scale * model_min, pos + scale * model_max), cam);
+
+	// 투영된 원의 면적 * triangles_per_pixel 만큼의 삼각형이 필요
+	double target = triangles_per_pixel * pi * 0.25 * pixels * pixels;
+
+	// target 이상의 면을 가진 LOD 중 가장 단순한 것
+	size_t level = 0;
+	while (level + 1 < levels.size() && levels[level + 1].faces >= target)
+	    level++;
+
+	fine = load(levels[level], mat, pos, scale);
+
+	// stochastic 모드: target이 level과 level + 1 사이 어디쯤인지에 따라 섞음
+	// (면 개수의 로그 스케일로 보간)
+	if (stochastic && level < coarsest && target < levels[level].faces) {
+	    double fine_faces = double(levels[level].faces);
+	    double coarse_faces = double(levels[level + 1].faces);
+	    coarse_probability = std::log(fine_faces / target) / std::log(fine_faces / coarse_faces);
+	    coarse = load(levels[level + 1], mat, pos, scale);
+	}
+
+	bbox = fine->bounding_box();
+	if (coarse)
+	    bbox = aabb(bbox, coarse->bounding_box());
+
+	std::clog << "LOD: " << levels[level].path << " (" << levels[level].faces
+	    << " faces, " << int(pixels) << " px";
+	if (coarse)
+	    std::clog << ", " << int(100 * coarse_probability) << "% -> " << levels[level + 1].path;
+	std::clog << ")\n";
+    }
+
+    // bbox를 감싸는 구가 화면에 투영된 지름 (픽셀)
+    static double projected_diameter(const aabb& box, const camera& cam) {
+	point3 center(
+	    0.5 * (box.x.min + box.x.max),
+	    0.5 * (box.y.min + box.y.max),
+	    0.5 * (box.z.min + box.z.max)
+	);
+	double radius = 0.5 * vec3(box.x.size(), box.y.size(), box.z.size()).length();
+	double distance = (center - cam.lookfrom).length();
+
+	// 카메라가 구 안에 있으면 화면을 가득 채움
+	int image_height = std::max(1, int(cam.image_width / cam.aspect_ratio));
+	if (distance <= radius)
+	    return std::max(cam.image_width, image_height);
+
+	// 거리 distance에서 화면 세로 길이 = 2 * distance * tan(vfov / 2)
+	double view_height = 2.0 * distance * std::tan(degrees_to_radians(cam.vfov) / 2);
+	return 2.0 * radius / view_height * image_height;
+    }
+
+    bool hit(const ray& r, interval ray_t, hit_record& rec) const override {
+	if (!fine)
+	    return false;
+	if (coarse && path_lod_sample() < coarse_probability)
+	    return coarse->hit(r, ray_t, rec);
+	return fine->hit(r, ray_t, rec);
+    }
+
+    // hit과 같은 LOD를 골라야 그림자 레이가 보이는 표면과 어긋나지 않음
+    bool occluded(const ray& r, interval ray_t) const override {
+	if (!fine)
+	    return false;
+	if (coarse && path_lod_sample() < coarse_probability)
+	    return coarse->occluded(r, ray_t);
+	return fine->occluded(r, ray_t);
+    }
+
+    aabb bounding_box() const override { return bbox; }
+};
+
+#endif
@@ -7,23 +7,30 @@
 #include "hittable_list.h"
 #include "bvh.h"
 #include "sphere.h"
+#include "sphere_group.h"
+#include "volume.h"
 #include "triangle.h"
+#include "compressed_mesh.h"
 #include "polygon_mesh.h"
+#include "mesh_simplify.h"
 #include "quad.h"
 #include "image_opener.h"
 #include "camera.h"
+#include "lod_mesh.h"
+#include "animation.h"
 #include "material.h"
 #include "texture.h"
+#include "render_server.h"
 
 void cornell_box(hittable_list& world, camera& cam) {
-    auto mat_red = make_shared<lambertian>(color(1.0, 0.0, 0.0));
-    auto mat_green = make_shared<lambertian>(color(0.0, 1.0, 0.0));
-    auto mat_blue = make_shared<lambertian>(color(0.0, 0.0, 1.0));
-    auto mat_white = make_shared<lambertian>(color(1.0, 1.0, 1.0));
-    auto mat_light = make_shared<diffuse_light>(color(15, 15, 15));
+    auto mat_red = arena_make_shared<lambertian>(color(1.0, 0.0, 0.0));
+    auto mat_green = arena_make_shared<lambertian>(color(0.0, 1.0, 0.0));
+    auto mat_blue = arena_make_shared<lambertian>(color(0.0, 0.0, 1.0));
+    auto mat_white = arena_make_shared<lambertian>(color(1.0, 1.0, 1.0));
+    auto mat_light = arena_make_shared<diffuse_light>(color(15, 15, 15));
 
     // left
-    world.add(make_shared<quad>(
+    world.add(arena_make_shared<quad>(
 	point3(-2, -2, 2),
 	vec3(0, 0, -4),
 	vec3(0, 4, 0),
@@ -31,7 +38,7 @@ void cornell_box(hittable_list& world, camera& cam) {
     ));
 
     // right
-    world.add(make_shared<quad>(
+    world.add(arena_make_shared<quad>(
 	point3(2, -2, 2),
 	vec3(0, 0, -4),
 	vec3(0, 4, 0),
@@ -39,7 +46,7 @@ void cornell_box(hittable_list& world, camera& cam) {
     ));
 
     // floor
-    world.add(make_shared<quad>(
+    world.add(arena_make_shared<quad>(
 	point3(-2, -2, 2),
 	vec3(4, 0, 0),
 	vec3(0, 0, -4),
@@ -47,7 +54,7 @@ void cornell_box(hittable_list& world, camera& cam) {
     ));
 
     // ceil
-    world.add(make_shared<quad>(
+    world.add(arena_make_shared<quad>(
 	point3(-2, 2, 2),
 	vec3(4, 0, 0),
 	vec3(0, 0, -4),
@@ -55,7 +62,7 @@ void cornell_box(hittable_list& world, camera& cam) {
     ));
 
     // back
-    world.add(make_shared<quad>(
+    world.add(arena_make_shared<quad>(
 	point3(-2, -2, -2),
 	vec3(4, 0, 0),
 	vec3(0, 4, 0),
@@ -63,7 +70,7 @@ void cornell_box(hittable_list& world, camera& cam) {
     ));
 
     // emit
-    world.add(make_shared<quad>(
+    world.add(arena_make_shared<quad>(
 	point3(-0.5, 1.99, -.25),
 	vec3(1.0, 0, 0),
 	vec3(0, 0, -1.0),
@@ -78,17 +85,17 @@ void cornell_box(hittable_list& world, camera& cam) {
 
 void scene1(hittable_list& world, camera& cam) {
     // 물체에 사용할 머티리얼
-    auto material_ground = make_shared<lambertian>(color(0.8, 0.8, 0.0));
-    auto material_center = make_shared<lambertian>(color(0.1, 0.2, 0.5));
-    auto material_left = make_shared<dielectric>(1.50);
-    auto material_bubble = make_shared<dielectric>(1.00 / 1.50);
-    auto material_right = make_shared<metal>(color(0.8, 0.6, 0.2), 0.2);
-
-    world.add(make_shared<sphere>(point3(0.0, -100.5, -1.0), 100.0, material_ground));
-    world.add(make_shared<sphere>(point3(0.0, 0.0, 0.8), 0.5, material_center));
-    world.add(make_shared<sphere>(point3(-1.0, 0.0, 0.8), 0.3, material_left));
-    world.add(make_shared<sphere>(point3(-1.0, 0.0, 0.8), 0.5, material_bubble));
-    world.add(make_shared<sphere>(point3(1.0, 0.0, 0.8), 0.5, material_right));
+    auto material_ground = arena_make_shared<lambertian>(color(0.8, 0.8, 0.0));
+    auto material_center = arena_make_shared<lambertian>(color(0.1, 0.2, 0.5));
+    auto material_left = arena_make_shared<dielectric>(1.50);
+    auto material_bubble = arena_make_shared<dielectric>(1.00 / 1.50);
+    auto material_right = arena_make_shared<metal>(color(0.8, 0.6, 0.2), 0.2);
+
+    world.add(arena_make_shared<sphere>(point3(0.0, -100.5, -1.0), 100.0, material_ground));
+    world.add(arena_make_shared<sphere>(point3(0.0, 0.0, 0.8), 0.5, material_center));
+    world.add(arena_make_shared<sphere>(point3(-1.0, 0.0, 0.8), 0.3, material_left));
+    world.add(arena_make_shared<sphere>(point3(-1.0, 0.0, 0.8), 0.5, material_bubble));
+    world.add(arena_make_shared<sphere>(point3(1.0, 0.0, 0.8), 0.5, material_right));
 
     cam.background = color(0.70, 0.80, 1.00);
 }
@@ -96,36 +103,36 @@ void scene1(hittable_list& world, camera& cam) {
 void scene2(hittable_list& world, camera& cam) {
     auto R = std::cos(pi / 4);
     
-    auto material_left = make_shared<lambertian>(color(0, 0, 1));
-    auto material_right = make_shared<lambertian>(color(1, 0, 0));
+    auto material_left = arena_make_shared<lambertian>(color(0, 0, 1));
+    auto material_right = arena_make_shared<lambertian>(color(1, 0, 0));
 
-    world.add(make_shared<sphere>(point3(-R, 0, -1), R, material_left));
-    world.add(make_shared<sphere>(point3(R, 0, -1), R, material_right));
+    world.add(arena_make_shared<sphere>(point3(-R, 0, -1), R, material_left));
+    world.add(arena_make_shared<sphere>(point3(R, 0, -1), R, material_right));
 
     cam.background = color(0.70, 0.80, 1.00);
 }
 
 // 삼각형 테스트
 void scene3(hittable_list& world, camera& cam) {
-    auto material_center = make_shared<lambertian>(color(0.1, 0.2, 0.5));
-    auto material_left = make_shared<metal>(color(0.3, 0.6, 0.8), 1.0);
-    auto material_right = make_shared<metal>(color(0.8, 0.6, 0.2), 0.1);
+    auto material_center = arena_make_shared<lambertian>(color(0.1, 0.2, 0.5));
+    auto material_left = arena_make_shared<metal>(color(0.3, 0.6, 0.8), 1.0);
+    auto material_right = arena_make_shared<metal>(color(0.8, 0.6, 0.2), 0.1);
     
-    world.add(make_shared<triangle>(
+    world.add(arena_make_shared<triangle>(
 	point3(-0.5, 0.1, 1.0),
 	point3(0.5, 0.1, 1.0),
 	point3(0.0, 0.85, 1.0),
 	material_center
     ));
 
-    world.add(make_shared<triangle>(
+    world.add(arena_make_shared<triangle>(
 	point3(-1.5, 0.1, 1.1),
 	point3(-0.5, 0.1, 1.0),
 	point3(-1.0, 0.85, 1.0),
 	material_left
     ));
 
-    world.add(make_shared<triangle>(
+    world.add(arena_make_shared<triangle>(
 	point3(0.5, 0.1, 1.0),
 	point3(1.5, 0.1, 1.1),
 	point3(1.0, 0.85, 1.0),
@@ -139,16 +146,16 @@ void scene3(hittable_list& world, camera& cam) {
 
 // 폴리곤 메시 테스트
 void scene4(hittable_list& world, camera& cam) {
-    auto material_ground = make_shared<lambertian>(color(0.8, 0.8, 0.0));
-    auto material_lambertian = make_shared<lambertian>(color(0.1, 0.2, 0.5));
-    auto material_metal1 = make_shared<metal>(color(0.3, 0.6, 0.8), 1.0);
-    auto material_metal2 = make_shared<metal>(color(0.8, 0.6, 0.2), 0.4);
-    auto material_dielectric = make_shared<dielectric>(1.50);
+    auto material_ground = arena_make_shared<lambertian>(color(0.8, 0.8, 0.0));
+    auto material_lambertian = arena_make_shared<lambertian>(color(0.1, 0.2, 0.5));
+    auto material_metal1 = arena_make_shared<metal>(color(0.3, 0.6, 0.8), 1.0);
+    auto material_metal2 = arena_make_shared<metal>(color(0.8, 0.6, 0.2), 0.4);
+    auto material_dielectric = arena_make_shared<dielectric>(1.50);
 
-    world.add(make_shared<sphere>(point3(0.0, -100.5, -1.0), 100.0, material_ground));
+    world.add(arena_make_shared<sphere>(point3(0.0, -100.5, -1.0), 100.0, material_ground));
 
     std::string teapot_path = "../res/teapot.obj";
-    auto obj1 = make_shared<polygon_mesh>(
+    auto obj1 = arena_make_shared<polygon_mesh>(
 	teapot_path,
 	material_lambertian,
 	world,
@@ -157,7 +164,7 @@ void scene4(hittable_list& world, camera& cam) {
     );
     world.add(obj1);
 
-    auto obj2 = make_shared<polygon_mesh>(
+    auto obj2 = arena_make_shared<polygon_mesh>(
 	teapot_path,
 	material_dielectric,
 	world,
@@ -167,7 +174,7 @@ void scene4(hittable_list& world, camera& cam) {
     world.add(obj2);
 
     std::string bunny_path = "../res/stanford-bunny.obj";
-    auto obj3 = make_shared<polygon_mesh>(
+    auto obj3 = arena_make_shared<polygon_mesh>(
 	bunny_path,
 	material_metal2,
 	world,
@@ -185,9 +192,9 @@ void scene4(hittable_list& world, camera& cam) {
 
 // Triangle 개수에 따른 렌더 시간 테스트
 void scene5(hittable_list& world, camera& cam) {
-    auto material_ground = make_shared<lambertian>(color(0.8, 0.8, 0.0));
-    auto material_lambertian = make_shared<lambertian>(color(0.1, 0.2, 0.5));
-    auto material_metal = make_shared<metal>(color(0.8, 0.6, 0.2), 0.1);
+    auto material_ground = arena_make_shared<lambertian>(color(0.8, 0.8, 0.0));
+    auto material_lambertian = arena_make_shared<lambertian>(color(0.1, 0.2, 0.5));
+    auto material_metal = arena_make_shared<metal>(color(0.8, 0.6, 0.2), 0.1);
 
     std::string bunny_path = "../res/stanford-bunny.obj";
     std::string bunny_path_08 = "../res/stanford-bunny-08.obj";
@@ -196,8 +203,8 @@ void scene5(hittable_list& world, camera& cam) {
     std::string bunny_path_02 = "../res/stanford-bunny-02.obj";
     std::string bunny_path_01 = "../res/stanford-bunny-01.obj";
 
-    //world.add(make_shared<sphere>(point3(0.0, -100.5, -1.0), 100.0, material_ground));
-    auto bunny_test = make_shared<polygon_mesh>(
+    //world.add(arena_make_shared<sphere>(point3(0.0, -100.5, -1.0), 100.0, material_ground));
+    auto bunny_test = arena_make_shared<polygon_mesh>(
 	bunny_path, 
 	material_metal,
 	world,
@@ -211,10 +218,10 @@ void scene5(hittable_list& world, camera& cam) {
 }
 
 void scene6(hittable_list& world, camera& cam) {
-    auto material_lambertian = make_shared<lambertian>(color(0.1, 0.2, 0.5));
-    auto material_metal = make_shared<metal>(color(0.8, 0.6, 0.2), 0.1);
+    auto material_lambertian = arena_make_shared<lambertian>(color(0.1, 0.2, 0.5));
+    auto material_metal = arena_make_shared<metal>(color(0.8, 0.6, 0.2), 0.1);
     std::string vase_path = "../res/vase.obj";
-    auto vase = make_shared<polygon_mesh>(
+    auto vase = arena_make_shared<polygon_mesh>(
 	vase_path,
 	material_metal,
 	world,
@@ -227,18 +234,18 @@ void scene6(hittable_list& world, camera& cam) {
 // Quads
 void scene7(hittable_list& world, camera& cam) {
     // Materials
-    auto left_red = make_shared<lambertian>(color(1.0, 0.2, 0.2));
-    auto back_green = make_shared<lambertian>(color(0.2, 1.0, 0.2));
-    auto right_blue = make_shared<lambertian>(color(0.2, 0.2, 1.0));
-    auto upper_orange = make_shared<lambertian>(color(1.0, 0.5, 0.0));
-    auto lower_teal = make_shared<lambertian>(color(0.2, 0.8, 0.8));
+    auto left_red = arena_make_shared<lambertian>(color(1.0, 0.2, 0.2));
+    auto back_green = arena_make_shared<lambertian>(color(0.2, 1.0, 0.2));
+    auto right_blue = arena_make_shared<lambertian>(color(0.2, 0.2, 1.0));
+    auto upper_orange = arena_make_shared<lambertian>(color(1.0, 0.5, 0.0));
+    auto lower_teal = arena_make_shared<lambertian>(color(0.2, 0.8, 0.8));
 
     // Quads
-    world.add(make_shared<quad>(point3(-3, -2, 5), vec3(0, 0, -4), vec3(0, 4, 0), left_red));
-    world.add(make_shared<quad>(point3(-2, -2, 0), vec3(4, 0, 0), vec3(0, 4, 0), back_green));
-    world.add(make_shared<quad>(point3(3, -2, 1), vec3(0, 0, 4), vec3(0, 4, 0), right_blue));
-    world.add(make_shared<quad>(point3(-2, 3, 1), vec3(4, 0, 0), vec3(0, 0, 4), upper_orange));
-    world.add(make_shared<quad>(point3(-2, -3, 5), vec3(4, 0, 0), vec3(0, 0, -4), lower_teal));
+    world.add(arena_make_shared<quad>(point3(-3, -2, 5), vec3(0, 0, -4), vec3(0, 4, 0), left_red));
+    world.add(arena_make_shared<quad>(point3(-2, -2, 0), vec3(4, 0, 0), vec3(0, 4, 0), back_green));
+    world.add(arena_make_shared<quad>(point3(3, -2, 1), vec3(0, 0, 4), vec3(0, 4, 0), right_blue));
+    world.add(arena_make_shared<quad>(point3(-2, 3, 1), vec3(4, 0, 0), vec3(0, 0, 4), upper_orange));
+    world.add(arena_make_shared<quad>(point3(-2, -3, 5), vec3(4, 0, 0), vec3(0, 0, -4), lower_teal));
 
     cam.vfov = 80;
     cam.lookfrom = point3(0, 0, 9);
@@ -254,12 +261,12 @@ void scene8(hittable_list& world, camera& cam) {
     std::string bunny_path = "../res/stanford-bunny.obj";
     std::string teapot_path = "../res/teapot.obj";
 
-    auto material_lambertian = make_shared<lambertian>(color(0.1, 0.2, 0.5));
-    auto material_metal1 = make_shared<metal>(color(0.3, 0.6, 0.8), 1.0);
-    auto material_metal2 = make_shared<metal>(color(0.8, 0.6, 0.2), 0.4);
-    auto material_dielectric = make_shared<dielectric>(1.50);
+    auto material_lambertian = arena_make_shared<lambertian>(color(0.1, 0.2, 0.5));
+    auto material_metal1 = arena_make_shared<metal>(color(0.3, 0.6, 0.8), 1.0);
+    auto material_metal2 = arena_make_shared<metal>(color(0.8, 0.6, 0.2), 0.4);
+    auto material_dielectric = arena_make_shared<dielectric>(1.50);
 
-    auto obj1 = make_shared<polygon_mesh>(
+    auto obj1 = arena_make_shared<polygon_mesh>(
 	teapot_path,
 	material_lambertian,
 	world,
@@ -268,7 +275,7 @@ void scene8(hittable_list& world, camera& cam) {
     );
     world.add(obj1);
 
-    auto obj2 = make_shared<polygon_mesh>(
+    auto obj2 = arena_make_shared<polygon_mesh>(
 	teapot_path,
 	material_dielectric,
 	world,
@@ -277,7 +284,7 @@ void scene8(hittable_list& world, camera& cam) {
     );
     world.add(obj2);
 
-    auto obj3 = make_shared<polygon_mesh>(
+    auto obj3 = arena_make_shared<polygon_mesh>(
 	bunny_path,
 	material_metal2,
 	world,
@@ -288,13 +295,13 @@ void scene8(hittable_list& world, camera& cam) {
 
     auto sphere_center1 = point3(-1, 0.5, 0);
     auto sphere_center2 = sphere_center1 + vec3(random_double(0, 0.5), random_double(0, 1), 0);
-    world.add(make_shared<sphere>(sphere_center1, sphere_center2,
+    world.add(arena_make_shared<sphere>(sphere_center1, sphere_center2,
 	0.2, material_lambertian));
 
-    auto earth_texture = make_shared<image_texture>("earthmap.jpg");
-    auto earth_material = make_shared<lambertian>(earth_texture);
+    auto earth_texture = arena_make_shared<image_texture>("earthmap.jpg");
+    auto earth_material = arena_make_shared<lambertian>(earth_texture);
 
-    world.add(make_shared<sphere>(
+    world.add(arena_make_shared<sphere>(
 	point3(0.6, -0.5, 0.7),
 	0.4,
 	earth_material
@@ -304,7 +311,7 @@ void scene8(hittable_list& world, camera& cam) {
 void scene9(hittable_list& world, camera& cam) {
     cornell_box(world, cam);
 
-    auto mat_white = make_shared<lambertian>(color(1.0, 1.0, 1.0));
+    auto mat_white = arena_make_shared<lambertian>(color(1.0, 1.0, 1.0));
 
     world.add(box(
 	point3(-0.9, 0.7, -2),
@@ -319,7 +326,277 @@ void scene9(hittable_list& world, camera& cam) {
     ));
 }
 
-int main() {
+// 거리에 따른 LOD 자동 선택
+// 카메라 설정이 끝난 뒤에 lod_mesh를 만들어야 투영 크기를 제대로 계산함
+void scene10(hittable_list& world, camera& cam) {
+    cam.lookfrom = point3(0, 2, 6);
+    cam.lookat = point3(0, 1, -20);
+    cam.background = color(0.70, 0.80, 1.00);
+    cam.defocus_angle = 0;
+
+    auto material_ground = arena_make_shared<lambertian>(color(0.8, 0.8, 0.0));
+    auto material_metal = arena_make_shared<metal>(color(0.8, 0.6, 0.2), 0.1);
+    world.add(arena_make_shared<sphere>(point3(0, -1000, 0), 1000, material_ground));
+
+    mesh_asset bunny;
+    bunny.add_lod("../res/stanford-bunny.obj");
+    bunny.add_lod("../res/stanford-bunny-08.obj");
+    bunny.add_lod("../res/stanford-bunny-06.obj");
+    bunny.add_lod("../res/stanford-bunny-04.obj");
+    bunny.add_lod("../res/stanford-bunny-02.obj");
+    bunny.add_lod("../res/stanford-bunny-01.obj");
+
+    // 멀어질수록 단순한 LOD가 선택됨
+    for (int i = 0; i < 6; i++) {
+	double z = -5.0 * i * i;
+	world.add(arena_make_shared<lod_mesh>(
+	    bunny,
+	    material_metal,
+	    point3(2.0 * (i % 2 == 0 ? -1 : 1), -0.7, z),
+	    vec3(20, 20, 20),
+	    cam,
+	    true
+	));
+    }
+}
+
+// 원본 모델 하나에서 QEM으로 LOD 체인을 만들어 사용
+// 단순화한 모델은 ../res/vase.qem*.obj로 캐시됨
+void scene11(hittable_list& world, camera& cam) {
+    cam.lookfrom = point3(0, 3, 8);
+    cam.lookat = point3(0, 2, -20);
+    cam.background = color(0.70, 0.80, 1.00);
+    cam.defocus_angle = 0;
+
+    auto material_ground = arena_make_shared<lambertian>(color(0.8, 0.8, 0.0));
+    auto material_metal = arena_make_shared<metal>(color(0.8, 0.6, 0.2), 0.1);
+    world.add(arena_make_shared<sphere>(point3(0, -1000, 0), 1000, material_ground));
+
+    mesh_asset vase;
+    vase.add_simplified_lods("../res/vase.obj", { 4000, 2000, 1000, 500, 250 });
+
+    for (int i = 0; i < 6; i++) {
+	double z = -5.0 * i * i;
+	world.add(arena_make_shared<lod_mesh>(
+	    vase,
+	    material_metal,
+	    point3(2.0 * (i % 2 == 0 ? -1 : 1), 1.45, z),
+	    vec3(0.01, 0.01, 0.01),
+	    cam
+	));
+    }
+}
+
+// 애니메이션: 튀어 오르는 공과 옆으로 움직이는 카메라
+void scene12(hittable_list& world, camera& cam, animation& anim) {
+    cam.vfov = 40;
+    cam.background = color(0.70, 0.80, 1.00);
+    cam.defocus_angle = 0;
+
+    auto material_ground = arena_make_shared<lambertian>(color(0.8, 0.8, 0.0));
+    auto material_center = arena_make_shared<lambertian>(color(0.1, 0.2, 0.5));
+    auto material_metal = arena_make_shared<metal>(color(0.8, 0.6, 0.2), 0.1);
+    world.add(arena_make_shared<sphere>(point3(0, -1000, 0), 1000, material_ground));
+    world.add(arena_make_shared<sphere>(point3(2, 1, 0), 1, material_metal));
+
+    // 1초에 두 번 튀어 오름
+    transform_keys bounce;
+    for (int i = 0; i <= 4; i++)
+	bounce.translation.add(i * 0.25, vec3(0, (i % 2 == 0) ? 0.0 : 2.0, 0));
+    auto ball = arena_make_shared<animated_transform>(
+	arena_make_shared<sphere>(point3(-1, 1, 0), 1, material_center), bounce);
+    world.add(ball);
+    anim.objects.push_back(ball);
+
+    anim.lookfrom.add(0.0, point3(-6, 3, 10));
+    anim.lookfrom.add(1.0, point3(6, 3, 10));
+    anim.lookat.add(0.0, point3(0, 1, 0));
+    anim.fps = 24;
+}
+
+// HDR 환경 맵 조명: 작은 태양이 있는 하늘 아래의 구들
+// RTW_IMAGES 또는 images/ 폴더에 sky.hdr (equirectangular)이 있으면 사용, 없으면 절차적 하늘
+void scene13(hittable_list& world, camera& cam) {
+    cam.vfov = 30;
+    cam.lookfrom = point3(0, 2, 10);
+    cam.lookat = point3(0, 0.8, 0);
+    cam.defocus_angle = 0;
+
+    auto environment = arena_make_shared<environment_map>("sky.hdr");
+    if (!environment->valid()) {
+	std::clog << "sky.hdr 없음: 절차적 하늘 사용\n";
+	environment = arena_make_shared<environment_map>(1024, 512,
+	    procedural_sky(1024, 512, vec3(-1, 0.6, 0.5)));
+    }
+    cam.environment = environment;
+
+    world.add(arena_make_shared<sphere>(point3(0, -1000, 0), 1000,
+	arena_make_shared<lambertian>(arena_make_shared<checker_texture>(0.5, color(.2, .3, .1), color(.9, .9, .9)))));
+    world.add(arena_make_shared<sphere>(point3(-2.2, 1, 0), 1, arena_make_shared<lambertian>(color(0.7, 0.3, 0.2))));
+    world.add(arena_make_shared<sphere>(point3(0, 1, 0), 1, arena_make_shared<dielectric>(1.5)));
+    world.add(arena_make_shared<sphere>(point3(2.2, 1, 0), 1, arena_make_shared<metal>(color(0.8, 0.8, 0.9), 0.1)));
+}
+
+// 구 약 1만 개 (The Next Week 마지막 씬의 구 덩어리를 크게 늘린 것)
+// grouped가 true면 작은 구들을 sphere_group 하나로, false면 구마다 sphere 객체로 월드 BVH에 넣음
+void scene14(hittable_list& world, camera& cam, bool grouped = true) {
+    cam.vfov = 40;
+    cam.lookfrom = point3(478, 278, -600);
+    cam.lookat = point3(278, 278, 0);
+    cam.defocus_angle = 0;
+    cam.background = color(0.7, 0.8, 1.0);
+
+    world.add(arena_make_shared<sphere>(point3(278, -100000, 0), 100000 - 1,
+	arena_make_shared<lambertian>(color(0.48, 0.83, 0.53))));
+
+    auto white = arena_make_shared<lambertian>(color(.73, .73, .73));
+    auto red = arena_make_shared<lambertian>(color(.65, .05, .05));
+    auto glass = arena_make_shared<dielectric>(1.5);
+    auto gold = arena_make_shared<metal>(color(0.8, 0.6, 0.2), 0.2);
+
+    auto group = arena_make_shared<sphere_group>();
+    auto add_static = [&](const point3& center, double radius, shared_ptr<material> mat) {
+	if (grouped)
+	    group->add(center, radius, mat);
+	else
+	    world.add(arena_make_shared<sphere>(center, radius, mat));
+    };
+    auto add_moving = [&](const point3& center1, const point3& center2, double radius, shared_ptr<material> mat) {
+	if (grouped)
+	    group->add(center1, center2, radius, mat);
+	else
+	    world.add(arena_make_shared<sphere>(center1, center2, radius, mat));
+    };
+
+    // 가운데 정육면체 안을 채운 작은 흰 구 9000개
+    point3 cube_center(278, 300, 300);
+    for (int k = 0; k < 9000; k++)
+	add_static(cube_center + vec3::random(-165, 165), 7, white);
+
+    // 그 위아래로 흩어진 색 구 800개와 금속 구 100개
+    for (int k = 0; k < 800; k++)
+	add_static(point3(random_double(0, 556), random_double(0, 60), random_double(-100, 600)),
+	    random_double(4, 10), red);
+    for (int k = 0; k < 100; k++)
+	add_static(point3(random_double(0, 556), random_double(500, 560), random_double(0, 556)),
+	    random_double(5, 15), gold);
+
+    // 모션 블러가 있는 구 100개
+    for (int k = 0; k < 100; k++) {
+	point3 center1(random_double(0, 556), random_double(80, 140), random_double(-150, 0));
+	add_moving(center1, center1 + vec3(random_double(10, 30), 0, 0), 8, white);
+    }
+
+    if (grouped) {
+	group->build();
+	world.add(group);
+	std::clog << "Sphere group: " << group->size() << " spheres, "
+	    << group->memory_bytes() / 1024 << " KB\n";
+    }
+
+    world.add(arena_make_shared<sphere>(point3(260, 150, -150), 50, glass));
+    world.add(arena_make_shared<sphere>(point3(0, 150, 145), 50, gold));
+}
+
+// 회전 / 이동 래퍼를 겹쳐 쓴 Cornell box
+// 래퍼 체인은 월드 BVH를 만들기 전에 collapse_transforms가 행렬 하나로 합치고, box의 quad에는 직접 적용함
+void scene15(hittable_list& world, camera& cam) {
+    cornell_box(world, cam);
+
+    auto mat_white = arena_make_shared<lambertian>(color(0.73, 0.73, 0.73));
+    auto mat_metal = arena_make_shared<metal>(color(0.8, 0.85, 0.88), 0.05);
+
+    // 원점에 만든 상자를 회전 -> 이동 (래퍼 두 단계)
+    shared_ptr<hittable> tall_box = box(point3(0, 0, 0), point3(1.1, 2.4, 1.1), mat_white);
+    tall_box = arena_make_shared<transform>(tall_box, matrix4::rotation(vec3(0, 1, 0), 15));
+    tall_box = arena_make_shared<translate>(tall_box, vec3(-1.4, -2, -1.3));
+    world.add(tall_box);
+
+    shared_ptr<hittable> short_box = box(point3(0, 0, 0), point3(1.1, 1.1, 1.1), mat_white);
+    short_box = arena_make_shared<transform>(short_box, matrix4::rotation(vec3(0, 1, 0), -18));
+    short_box = arena_make_shared<translate>(short_box, vec3(0.3, -2, 0.1));
+    world.add(short_box);
+
+    // 이동 + 균등 스케일은 구의 중심 / 반지름에 직접 적용됨
+    shared_ptr<hittable> ball = arena_make_shared<sphere>(point3(0, 0, 0), 1, mat_metal);
+    ball = arena_make_shared<transform>(ball, matrix4::scaling(vec3(0.45, 0.45, 0.45)));
+    ball = arena_make_shared<translate>(ball, vec3(0.85, -0.45, 0.65));
+    world.add(ball);
+
+    // 비균등 스케일은 합친 행렬 하나의 transform 래퍼로 남음
+    shared_ptr<hittable> egg = arena_make_shared<sphere>(point3(0, 0, 0), 1, mat_white);
+    egg = arena_make_shared<transform>(egg, matrix4::rotation(vec3(0, 0, 1), 30) * matrix4::scaling(vec3(0.25, 0.4, 0.25)));
+    egg = arena_make_shared<translate>(egg, vec3(-1.25, 0.8, -0.7));
+    world.add(egg);
+}
+
+// 참여 매질: Cornell box 안의 불균일 연기 격자 + 유리구 안의 균일한 안개
+void scene16(hittable_list& world, camera& cam) {
+    cornell_box(world, cam);
+
+    // 64^3 연기 격자, majorant 블록 8^3
+    const int n = 64;
+    aabb smoke_box(point3(-1.8, -2, -1.8), point3(1.8, 1.2, 1.8));
+    world.add(arena_make_shared<grid_medium>(smoke_box, n, n, n, procedural_smoke(n, 12),
+	6.0, color(0.8, 0.8, 0.8)));
+
+    auto boundary = arena_make_shared<sphere>(point3(0.9, -1.4, 1.1), 0.6, arena_make_shared<dielectric>(1.5));
+    world.add(boundary);
+    world.add(arena_make_shared<constant_medium>(boundary, 2.0, color(0.2, 0.4, 0.9)));
+}
+
+// Perlin noise 텍스처: turbulence 바닥 + marble 구
+// 구의 marble은 구를 감싸는 박스에 미리 bake (박스 밖 바닥은 직접 계산)
+void scene17(hittable_list& world, camera& cam) {
+    auto ground = arena_make_shared<noise_texture>(2.0, noise_texture::pattern::turbulence, color(0.6, 0.5, 0.4));
+    world.add(arena_make_shared<sphere>(point3(0, -1000, 0), 1000, arena_make_shared<lambertian>(ground)));
+
+    auto marble = arena_make_shared<noise_texture>(4.0, noise_texture::pattern::marble, color(0.9, 0.9, 0.95), 7);
+    marble->bake(aabb(point3(-2, 0, -2), point3(2, 4, 2)), 128);
+    world.add(arena_make_shared<sphere>(point3(0, 2, 0), 2, arena_make_shared<lambertian>(marble)));
+
+    auto light = arena_make_shared<diffuse_light>(color(4, 4, 4));
+    world.add(arena_make_shared<quad>(point3(3, 1, -2), vec3(2, 0, 0), vec3(0, 2, 0), light));
+
+    cam.vfov = 20;
+    cam.lookfrom = point3(26, 3, 6);
+    cam.lookat = point3(0, 2, 0);
+    cam.background = color(0.1, 0.1, 0.12);
+
+    cam.defocus_angle = 0;
+}
+
+// 서버 모드에서 이름으로 요청할 수 있는 씬 (scene12는 애니메이션 전용이라 제외)
+void add_server_scenes(render_server& server) {
+    server.add_scene("cornell_box", cornell_box);
+    server.add_scene("scene1", scene1);
+    server.add_scene("scene2", scene2);
+    server.add_scene("scene3", scene3);
+    server.add_scene("scene4", scene4);
+    server.add_scene("scene5", scene5);
+    server.add_scene("scene6", scene6);
+    server.add_scene("scene7", scene7);
+    server.add_scene("scene8", scene8);
+    server.add_scene("scene9", scene9);
+    server.add_scene("scene10", scene10);
+    server.add_scene("scene11", scene11);
+    server.add_scene("scene13", scene13);
+    server.add_scene("scene14", [](hittable_list& world, camera& cam) { scene14(world, cam); });
+    server.add_scene("scene15", scene15);
+    server.add_scene("scene16", scene16);
+    server.add_scene("scene17", scene17);
+}
+
+// 사용법: RaytracingNextWeekend                  위 설정으로 한 장 렌더해서 image.ppm 저장
+//         RaytracingNextWeekend --serve [--socket 경로] [--threads N] [미리 불러올 씬 ...]
+//                                                씬을 메모리에 둔 채로 render_client의 요청을 처리
+int main(int argc, char** argv) {
+    // 씬 객체(머티리얼, 텍스처, primitive, BVH 노드)를 할당할 arena
+    // 씬 객체를 가리키는 카메라 / 월드보다 먼저 선언해서 가장 나중에 해제되게 함
+    // 두 번째 인자를 true로 하면 huge page 사용 (Linux)
+    scene_arena arena(size_t(4) << 20, false);
+    arena_scope scope(arena);
+
     // 카메라
     camera cam;
     cam.aspect_ratio = 1.0;
@@ -336,16 +613,110 @@ int main() {
     cam.defocus_angle = 10.0;
     cam.focus_dist = 3;
 
+    // true면 BVH 순회 비용 / 픽셀당 시간 heatmap도 함께 저장
+    cam.write_heatmaps = false;
+
+    // true면 albedo / 법선 / 깊이 AOV 이미지 저장
+    cam.write_aovs = false;
+    // true면 AOV 기반 à-trous 디노이즈 결과(image_denoised.ppm)도 저장
+    cam.denoise = false;
+    // 1000spp로 렌더한 이미지 경로를 넣으면 원본 / 디노이즈 결과의 RMSE 출력
+    cam.reference_image = "";
+
+    // 0보다 크면 주어진 시간(초) 동안 1spp 패스를 반복 (samples_per_pixel은 최대 패스 수)
+    cam.time_budget = 0;
+    // 시간 예산 모드에서 중간 결과를 저장하는 간격 (초)
+    cam.progress_interval = 0;
+
+    // 렌더 스레드 수 (0이면 OpenMP 기본값)와 CPU 고정 정책 (none / compact / spread)
+    // 고정하면 이미지를 NUMA 노드별 줄 묶음으로 나누고 프레임버퍼도 노드별로 배치 (render_threads.h)
+    cam.threading.threads = 0;
+    cam.threading.pinning = thread_pinning::none;
+    // true면 NUMA 노드마다 씬을 따로 만들어서 각 노드의 스레드가 자기 노드 메모리의 BVH를 읽음 (pinning 필요)
+    const bool replicate_scene = false;
+
+    // 서버 모드: 위 카메라 설정을 요청의 기본값으로 사용 (요청에서 width / spp 등을 덮어씀)
+    if (argc > 1 && std::string(argv[1]) == "--serve") {
+	server_options options;
+	options.threads = cam.threading.threads;
+	std::vector<std::string> preload;
+	for (int i = 2; i < argc; i++) {
+	    std::string arg = argv[i];
+	    if (arg == "--socket" && i + 1 < argc)
+		options.socket_path = argv[++i];
+	    else if (arg == "--threads" && i + 1 < argc)
+		options.threads = std::atoi(argv[++i]);
+	    else
+		preload.push_back(arg);
+	}
+
+	render_server server(cam, options);
+	add_server_scenes(server);
+	for (const std::string& name : preload) {
+	    std::string error;
+	    if (!server.preload(name, error))
+		std::cerr << error << "\n";
+	}
+	return server.run() ? 0 : 1;
+    }
+
     // 월드
     hittable_list world; // 모든 hittable한 오브젝트를 저장
 
-    // 불러올 씬
-    scene8(world, cam);
-
-    // 월드 공간 BVH
-    world = hittable_list(make_shared<bvh_node>(world));
-
-    cam.render(world); // hittable_list에 있는 모든 물체에 대해 렌더링
+    // 0보다 크면 scene12 애니메이션을 이 프레임 수만큼 렌더 (frame_0000.ppm, ...)
+    const int animation_frames = 0;
+
+    // 불러올 씬 (NUMA 복제본을 만들 때 다시 호출)
+    auto build_scene = [](hittable_list& world, camera& cam) {
+	scene8(world, cam);
+
+	// translate / transform 래퍼 체인을 행렬 하나로 합치거나 기하 데이터에 직접 적용
+	collapse_transforms(world);
+
+	// 월드 공간 BVH
+	world = hittable_list(arena_make_shared<bvh_node>(std::move(world)));
+    };
+
+    animation anim;
+    if (animation_frames > 0) {
+	scene12(world, cam, anim);
+	collapse_transforms(world);
+	// 애니메이션에서는 이 BVH를 모든 프레임에서 재사용
+	world = hittable_list(arena_make_shared<bvh_node>(std::move(world)));
+    }
+    else {
+	build_scene(world, cam);
+    }
+
+    // NUMA 노드별 씬 복제본: 노드마다 그 노드에 고정한 스레드에서 같은 씬을 한 번 더 만듦
+    // 씬 함수가 random_double()을 쓰므로 원본과 같은 seed(std::rand 기본값 1)로 시작
+    // 애니메이션은 anim이 원본 씬의 물체만 움직이므로 복제하지 않음
+    std::vector<std::unique_ptr<scene_arena>> replica_arenas; // 복제본 월드보다 나중에 해제
+    std::vector<hittable_list> replica_worlds;
+    if (replicate_scene && animation_frames == 0 && cam.threading.pinning != thread_pinning::none
+	&& numa_topology::system().node_count() > 1)
+    {
+	size_t vertices = scene_info::vertices, faces = scene_info::faces;
+	replica_worlds.resize(numa_topology::system().node_count());
+	run_on_each_numa_node([&](int node) {
+	    replica_arenas.push_back(std::make_unique<scene_arena>(size_t(4) << 20, false));
+	    arena_scope replica_scope(*replica_arenas.back());
+	    camera replica_cam; // 씬 함수가 바꾸는 카메라 설정은 원본 것을 사용
+	    std::srand(1);
+	    build_scene(replica_worlds[node], replica_cam);
+	    cam.scene_replicas.push_back(&replica_worlds[node]);
+	});
+	// 씬 정보는 원본 하나 기준
+	scene_info::vertices = vertices;
+	scene_info::faces = faces;
+    }
+
+    if (animation_frames > 0)
+	anim.render(cam, world, animation_frames);
+    else {
+	cam.render(world); // hittable_list에 있는 모든 물체에 대해 렌더링
+	openImage(cam.outputFilename); // 이미지 자동 실행
+    }
 
     std::clog << "\nRENDER INFO\n";
     std::clog << "Vertices: " << scene_info::vertices << "\n";
@@ -354,4 +725,10 @@ int main() {
     std::clog << "Image Width: " << cam.image_width << "\n";
     std::clog << "Samples Per Pixel: " << cam.samples_per_pixel << "\n";
     std::clog << "Ray Max Depth: " << cam.max_depth << "\n";
+    std::clog << "SIMD Kernels: " << simd().name << "\n";
+    arena.report(std::clog);
+
+#ifdef RT_ENABLE_STATS
+    render_stats::report(std::clog, cam.last_render_time);
+#endif
 }
\ No newline at end of file
@@ -1,21 +1,30 @@
 ﻿#ifndef MAT4_H
 #define MAT4_H
 
+#include <cstring>
+
+// 4x4 homogeneous 변환 행렬 (열 벡터 기준: p' = M * p)
+// 여러 변환을 합칠 때는 나중에 적용할 변환을 왼쪽에 곱함 (T * R * S: 스케일 -> 회전 -> 이동)
 class matrix4 {
 private:
     double m[4][4]; // 4x4 행렬
 
 public:
-    // TODO: 기본 생성자 검증하기
+    // 0으로 초기화 (operator*가 0에서부터 누적하므로 필요)
+    // 단위 행렬은 identity()
     matrix4() {
-	// 0으로 초기화
-	std::fill(m[0][0], m[3][3], 0);
+	std::fill(&m[0][0], &m[0][0] + 16, 0.0);
     }
 
     matrix4(const matrix4& mat) {
 	memcpy(m, mat.m, sizeof(double) * 16);
     }
 
+    matrix4& operator=(const matrix4& mat) {
+	memcpy(m, mat.m, sizeof(double) * 16);
+	return *this;
+    }
+
     matrix4(const std::vector<double>& r1, const std::vector<double>& r2,
 	const std::vector<double>& r3, const std::vector<double>& r4)
     {
@@ -33,7 +42,46 @@ public:
 	memcpy(m, mat_arr, sizeof(double) * 16);
     }
 
-    matrix4 operator*(const matrix4& other) {
+    // 기본 변환 행렬
+    static matrix4 identity() {
+	matrix4 mat;
+	for (int i = 0; i < 4; i++)
+	    mat.m[i][i] = 1;
+	return mat;
+    }
+
+    static matrix4 translation(const vec3& offset) {
+	matrix4 mat = identity();
+	for (int i = 0; i < 3; i++)
+	    mat.m[i][3] = offset[i];
+	return mat;
+    }
+
+    static matrix4 scaling(const vec3& scale) {
+	matrix4 mat = identity();
+	for (int i = 0; i < 3; i++)
+	    mat.m[i][i] = scale[i];
+	return mat;
+    }
+
+    // axis를 축으로 degrees만큼 회전 (오른손 법칙, Rodrigues 공식)
+    static matrix4 rotation(const vec3& axis, double degrees) {
+	vec3 a = unit_vector(axis);
+	double theta = degrees_to_radians(degrees);
+	double c = std::cos(theta), s = std::sin(theta), t = 1 - c;
+	double x = a.x(), y = a.y(), z = a.z();
+
+	matrix4 mat = identity();
+	mat.m[0][0] = t * x * x + c;     mat.m[0][1] = t * x * y - s * z; mat.m[0][2] = t * x * z + s * y;
+	mat.m[1][0] = t * x * y + s * z; mat.m[1][1] = t * y * y + c;     mat.m[1][2] = t * y * z - s * x;
+	mat.m[2][0] = t * x * z - s * y; mat.m[2][1] = t * y * z + s * x; mat.m[2][2] = t * z * z + c;
+	return mat;
+    }
+
+    double operator()(int row, int col) const { return m[row][col]; }
+    double& operator()(int row, int col) { return m[row][col]; }
+
+    matrix4 operator*(const matrix4& other) const {
 	matrix4 mat;
 
 	for (unsigned int i = 0; i < 4; i++)
@@ -43,11 +91,133 @@ public:
 
 	return mat;
     }
-    
- //   matrix4 operator+(const matrix4& other) {
-	//matrix4 mat;
 
+    matrix4 operator+(const matrix4& other) const {
+	matrix4 mat;
+	for (int i = 0; i < 4; i++)
+	    for (int j = 0; j < 4; j++)
+		mat.m[i][j] = m[i][j] + other.m[i][j];
+	return mat;
+    }
+
+    vec4 operator*(const vec4& v) const {
+	vec4 result;
+	for (int i = 0; i < 4; i++)
+	    result[i] = m[i][0] * v[0] + m[i][1] * v[1] + m[i][2] * v[2] + m[i][3] * v[3];
+	return result;
+    }
+
+    // 점 (w = 1) 변환, 마지막 행이 (0, 0, 0, 1)이 아니면 w로 나눔
+    point3 transform_point(const point3& p) const {
+	double x = m[0][0] * p.x() + m[0][1] * p.y() + m[0][2] * p.z() + m[0][3];
+	double y = m[1][0] * p.x() + m[1][1] * p.y() + m[1][2] * p.z() + m[1][3];
+	double z = m[2][0] * p.x() + m[2][1] * p.y() + m[2][2] * p.z() + m[2][3];
+	if (is_affine())
+	    return point3(x, y, z);
+	double w = m[3][0] * p.x() + m[3][1] * p.y() + m[3][2] * p.z() + m[3][3];
+	return point3(x / w, y / w, z / w);
+    }
 
- //   }
+    // 방향 벡터 (w = 0) 변환, 이동 성분은 무시
+    vec3 transform_vector(const vec3& v) const {
+	return vec3(
+	    m[0][0] * v.x() + m[0][1] * v.y() + m[0][2] * v.z(),
+	    m[1][0] * v.x() + m[1][1] * v.y() + m[1][2] * v.z(),
+	    m[2][0] * v.x() + m[2][1] * v.y() + m[2][2] * v.z()
+	);
+    }
+
+    // 전치 행렬로 방향 벡터 변환
+    // 역행렬에 대해 호출하면 법선 변환 (inverse transpose, 비균등 스케일에서도 면에 수직 유지)
+    vec3 transform_normal(const vec3& n) const {
+	return vec3(
+	    m[0][0] * n.x() + m[1][0] * n.y() + m[2][0] * n.z(),
+	    m[0][1] * n.x() + m[1][1] * n.y() + m[2][1] * n.z(),
+	    m[0][2] * n.x() + m[1][2] * n.y() + m[2][2] * n.z()
+	);
+    }
+
+    matrix4 transpose() const {
+	matrix4 mat;
+	for (int i = 0; i < 4; i++)
+	    for (int j = 0; j < 4; j++)
+		mat.m[i][j] = m[j][i];
+	return mat;
+    }
+
+    // 역행렬 (부분 피벗 Gauss-Jordan 소거)
+    // 특이 행렬이면 0 행렬 리턴
+    matrix4 inverse() const {
+	double a[4][8];
+	for (int i = 0; i < 4; i++)
+	    for (int j = 0; j < 4; j++) {
+		a[i][j] = m[i][j];
+		a[i][j + 4] = (i == j) ? 1.0 : 0.0;
+	    }
+
+	for (int col = 0; col < 4; col++) {
+	    int pivot = col;
+	    for (int row = col + 1; row < 4; row++)
+		if (std::fabs(a[row][col]) > std::fabs(a[pivot][col]))
+		    pivot = row;
+	    if (std::fabs(a[pivot][col]) < 1e-300)
+		return matrix4();
+	    if (pivot != col)
+		for (int j = 0; j < 8; j++)
+		    std::swap(a[col][j], a[pivot][j]);
+
+	    double scale = 1.0 / a[col][col];
+	    for (int j = 0; j < 8; j++)
+		a[col][j] *= scale;
+	    for (int row = 0; row < 4; row++) {
+		if (row == col || a[row][col] == 0)
+		    continue;
+		double factor = a[row][col];
+		for (int j = 0; j < 8; j++)
+		    a[row][j] -= factor * a[col][j];
+	    }
+	}
+
+	matrix4 mat;
+	for (int i = 0; i < 4; i++)
+	    for (int j = 0; j < 4; j++)
+		mat.m[i][j] = a[i][j + 4];
+	return mat;
+    }
+
+    // 왼쪽 위 3x3 (선형 부분)의 행렬식
+    double determinant3() const {
+	return m[0][0] * (m[1][1] * m[2][2] - m[1][2] * m[2][1])
+	    - m[0][1] * (m[1][0] * m[2][2] - m[1][2] * m[2][0])
+	    + m[0][2] * (m[1][0] * m[2][1] - m[1][1] * m[2][0]);
+    }
+
+    vec3 get_translation() const { return vec3(m[0][3], m[1][3], m[2][3]); }
+
+    // 변환 종류 판별 (래퍼를 합치거나 기하 데이터에 직접 적용할지 결정할 때 사용)
+    bool is_affine() const {
+	return m[3][0] == 0 && m[3][1] == 0 && m[3][2] == 0 && m[3][3] == 1;
+    }
+
+    // 선형 부분이 s * I (s > 0)인지: 이동 + 균등 스케일
+    bool is_uniform_scale_translation(double& scale, double eps = 1e-12) const {
+	if (!is_affine())
+	    return false;
+	scale = m[0][0];
+	for (int i = 0; i < 3; i++)
+	    for (int j = 0; j < 3; j++)
+		if (std::fabs(m[i][j] - (i == j ? scale : 0.0)) > eps * std::fmax(1.0, std::fabs(scale)))
+		    return false;
+	return scale > 0;
+    }
+
+    bool is_translation(double eps = 1e-12) const {
+	double scale;
+	return is_uniform_scale_translation(scale, eps) && std::fabs(scale - 1) <= eps;
+    }
+
+    bool is_identity(double eps = 1e-12) const {
+	return is_translation(eps) && get_translation().length_squared() <= eps * eps;
+    }
 };
 #endif
\ No newline at end of file
@@ -3,6 +3,7 @@
 
 #include "hittable.h"
 #include "texture.h"
+#include "sampler.h"
 
 // 레이와 부딪혔을 때 모든 머티리얼의 역할
 // 1. 산란광(scattered light) 만들기
@@ -15,17 +16,35 @@ public:
     // 산란광 만들기
     // 앞으로 만들 모든 머티리얼(lambertian, metal 등)이
     // scatter 메서드를 각자의 방식대로 구현
+    // 필요한 난수는 모두 s에서 꺼내 씀 (픽셀 샘플마다 같은 차원 순서)
     virtual bool scatter(
 	const ray& r_in, const hit_record& rec, color& attenuation,
-	ray& scattered
+	ray& scattered, sampler& s
     ) const {
 	return false;
     }
 
+    // scatter()가 direction 방향을 고를 입체각 확률 밀도
+    // 0이면 거울 / 유리처럼 정해진 방향으로만 산란 -> 광원 직접 샘플링을 하지 않음
+    virtual double scattering_pdf(const ray& r_in, const hit_record& rec, const vec3& direction) const {
+	return 0;
+    }
+
+    // BRDF * cos(theta): direction에서 들어온 빛이 r_in 반대 방향으로 나가는 비율 (광원 직접 샘플링용)
+    virtual color scattering_value(const ray& r_in, const hit_record& rec, const vec3& direction) const {
+	return color(0, 0, 0);
+    }
+
     // 물체가 방출하는 빛
     virtual color emitted(double u, double v, const point3& p) const {
 	return color(0, 0, 0);
     }
+
+    // 디노이저용 표면 색 (AOV)
+    // 조명과 상관없는 물체 고유의 색, 기본값은 흰색
+    virtual color surface_albedo(const hit_record& rec) const {
+	return color(1, 1, 1);
+    }
 };
 
 // Lambertian(diffuse) reflectance
@@ -34,20 +53,22 @@ private:
     //color albedo; // 물체 고유의 색 or 반사율
     shared_ptr<texture> tex;
 public:
-    lambertian(const color& albedo) : tex(make_shared<solid_color>(albedo)) {}
+    lambertian(const color& albedo) : tex(arena_make_shared<solid_color>(albedo)) {}
     lambertian(shared_ptr<texture> tex) : tex(tex) {}
 
     // Diffuse Scatter
     bool scatter(const ray& r_in, const hit_record& rec, color& attenuation,
-	ray& scattered
+	ray& scattered, sampler& s
     ) const override {
 	// Simple Diffuse
 	// 충돌 지점의 법선 벡터가 속한 반구에서 랜덤 방향의 벡터 가져옴
 	//vec3 direction = random_on_hemisphere(rec.normal);
 
 	// True Lambertian Reflection
-	// 법선 벡터 주변으로 랜덤한 단위벡터 더함
-	vec3 scattered_dir = rec.normal + random_unit_vector();
+	// 법선 벡터 주변으로 랜덤한 단위벡터 더함 (= cosine 가중 반구 분포)
+	// sample_cosine_hemisphere와 분포는 같지만 직교 기저를 만들 필요가 없어서 더 빠름
+	auto square = s.get_2d();
+	vec3 scattered_dir = rec.normal + sample_sphere(square.u, square.v);
 
 	// 랜덤 벡터와 노멀 벡터가 정확히 반대 방향인 경우
 	// 합이 0이 되어 나중에 오류 유발 할 수 있음
@@ -57,10 +78,28 @@ public:
 	    scattered_dir = rec.normal;
 	}
 
-	scattered = ray(rec.p, scattered_dir, r_in.time());
+	scattered = rec.spawn_ray(scattered_dir, r_in.time());
 	attenuation = tex->value(rec.u, rec.v, rec.p);
 	return true;
     }
+
+    // cosine 가중 반구 분포
+    double scattering_pdf(const ray& r_in, const hit_record& rec, const vec3& direction) const override {
+	double cos_theta = dot(rec.normal, unit_vector(direction));
+	return cos_theta > 0 ? cos_theta / pi : 0;
+    }
+
+    // albedo / pi * cos(theta)
+    color scattering_value(const ray& r_in, const hit_record& rec, const vec3& direction) const override {
+	double cos_theta = dot(rec.normal, unit_vector(direction));
+	if (cos_theta <= 0)
+	    return color(0, 0, 0);
+	return tex->value(rec.u, rec.v, rec.p) * (cos_theta / pi);
+    }
+
+    color surface_albedo(const hit_record& rec) const override {
+	return tex->value(rec.u, rec.v, rec.p);
+    }
 };
 
 class metal : public material {
@@ -72,15 +111,20 @@ public:
 	: albedo(albedo), fuzz(fuzz < 1 ? fuzz : 1) {}
 
     bool scatter(const ray& r_in, const hit_record& rec, color& attenuation,
-	ray& scattered
+	ray& scattered, sampler& s
     ) const override {
 	vec3 reflected = reflect(r_in.direction(), rec.normal);
 	// 완벽한 반사 방향 벡터에 fuzz만큼의 무작위 벡터 더함
-	reflected = unit_vector(reflected) + (fuzz * random_unit_vector());
-	scattered = ray(rec.p, reflected, r_in.time());
+	auto square = s.get_2d();
+	reflected = unit_vector(reflected) + (fuzz * sample_sphere(square.u, square.v));
+	scattered = rec.spawn_ray(reflected, r_in.time());
 	attenuation = albedo;
 	return (dot(scattered.direction(), rec.normal) > 0);
     }
+
+    color surface_albedo(const hit_record& rec) const override {
+	return albedo;
+    }
 };
 
 class dielectric : public material {
@@ -97,7 +141,7 @@ public:
     dielectric(double refraction_index) : refraction_index(refraction_index) {}
 
     bool scatter(const ray& r_in, const hit_record& rec, color& attenuation,
-	ray& scattered
+	ray& scattered, sampler& s
     ) const override {
 	attenuation = color(1.0, 1.0, 1.0);
 	// 레이가 물체 안으로 들어가는지, 밖으로 나가는지에 따라
@@ -113,14 +157,14 @@ public:
 
 	// 해가 없는 경우 or 계산된 반사율에 따라 확률적으로 반사 또는 굴절
 	if (ri * sin_theta > 1.0 || 
-	    reflectance(cos_theta, ri) > random_double()) {
+	    reflectance(cos_theta, ri) > s.get_1d()) {
 	    direction = reflect(unit_direction, rec.normal); // 전반사
 	}
 	else {
 	    direction = refract(unit_direction, rec.normal, ri); // 굴절
 	}
 
-	scattered = ray(rec.p, direction, r_in.time()); // 굴절된 방향으로 레이 발사
+	scattered = rec.spawn_ray(direction, r_in.time()); // 굴절된 방향으로 레이 발사
 
 	// (임시) 무조건 굴절 하게 하기
 	return true;
@@ -132,11 +176,41 @@ private:
     shared_ptr<texture> tex;
 public:
     diffuse_light(shared_ptr<texture> tex) : tex(tex) {}
-    diffuse_light(const color& emit) : tex(make_shared<solid_color>(emit)) {}
+    diffuse_light(const color& emit) : tex(arena_make_shared<solid_color>(emit)) {}
 
     color emitted(double u, double v, const point3& p) const override {
 	return tex->value(u, v, p);
     }
 };
 
+// 참여 매질(안개, 연기) 안의 산란: 모든 방향으로 균일하게 산란 (위상 함수 1 / 4pi)
+class isotropic : public material {
+private:
+    shared_ptr<texture> tex;
+public:
+    isotropic(const color& albedo) : tex(arena_make_shared<solid_color>(albedo)) {}
+    isotropic(shared_ptr<texture> tex) : tex(tex) {}
+
+    bool scatter(const ray& r_in, const hit_record& rec, color& attenuation,
+	ray& scattered, sampler& s
+    ) const override {
+	auto square = s.get_2d();
+	scattered = rec.spawn_ray(sample_sphere(square.u, square.v), r_in.time());
+	attenuation = tex->value(rec.u, rec.v, rec.p);
+	return true;
+    }
+
+    double scattering_pdf(const ray& r_in, const hit_record& rec, const vec3& direction) const override {
+	return 1 / (4 * pi);
+    }
+
+    color scattering_value(const ray& r_in, const hit_record& rec, const vec3& direction) const override {
+	return tex->value(rec.u, rec.v, rec.p) / (4 * pi);
+    }
+
+    color surface_albedo(const hit_record& rec) const override {
+	return tex->value(rec.u, rec.v, rec.p);
+    }
+};
+
 #endif
\ No newline at end of file
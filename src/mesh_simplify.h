@@ -0,0 +1,447 @@
+#ifndef MESH_SIMPLIFY_H
+#define MESH_SIMPLIFY_H
+
+// QEM(Quadric Error Metric) edge collapse 메시 단순화 (Garland & Heckbert)
+// 원본 obj에서 면 개수를 줄인 LOD들을 만들고, 원본 옆에 obj로 저장해서 다음 실행 때 재사용
+//
+// 각 정점은 주변 면 평면들까지의 거리 제곱 합을 나타내는 4x4 대칭 행렬(quadric)을 가짐
+// 간선 (v0, v1)을 한 점으로 합칠 때의 비용 = (Q0 + Q1)을 최소로 만드는 위치에서의 값
+// 비용이 가장 작은 간선부터 합쳐 나감
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <queue>
+#include <string>
+
+// 인덱스 기반 삼각형 메시 (obj 읽기/쓰기, 단순화용)
+struct indexed_mesh {
+    std::vector<point3> vertices;
+    std::vector<std::array<int, 3>> faces;
+};
+
+// obj의 v, f 줄만 읽음 (polygon_mesh::parse_obj와 같은 형식)
+inline bool read_obj(const std::string& path, indexed_mesh& mesh) {
+    std::ifstream file(path);
+    if (!file.is_open())
+	return false;
+
+    std::string line;
+    while (std::getline(file, line)) {
+	std::stringstream ss(line);
+	std::string identifier;
+	ss >> identifier;
+
+	if (identifier == "v") {
+	    double x, y, z;
+	    ss >> x >> y >> z;
+	    mesh.vertices.push_back(point3(x, y, z));
+	}
+	else if (identifier == "f") {
+	    int v0, v1, v2;
+	    ss >> v0 >> v1 >> v2;
+	    mesh.faces.push_back({ v0 - 1, v1 - 1, v2 - 1 });
+	}
+    }
+    return true;
+}
+
+// header는 맨 앞에 주석으로 씀 (캐시 확인용)
+inline bool write_obj(const std::string& path, const indexed_mesh& mesh, const std::string& header) {
+    std::ofstream file(path);
+    if (!file.is_open())
+	return false;
+
+    file << "# " << header << "\n";
+    file.precision(9);
+    for (const auto& v : mesh.vertices)
+	file << "v " << v.x() << " " << v.y() << " " << v.z() << "\n";
+    for (const auto& f : mesh.faces)
+	file << "f " << f[0] + 1 << " " << f[1] + 1 << " " << f[2] + 1 << "\n";
+    return true;
+}
+
+// 4x4 대칭 행렬 (위쪽 삼각형 10개 성분)
+// | a0 a1 a2 a3 |
+// |    a4 a5 a6 |
+// |       a7 a8 |
+// |          a9 |
+class quadric {
+public:
+    double a[10] = {};
+
+    quadric() {}
+
+    // 평면 nx + d = 0에 대한 quadric (n은 단위 벡터)
+    quadric(const vec3& n, double d, double weight = 1.0) {
+	double p[4] = { n.x(), n.y(), n.z(), d };
+	int k = 0;
+	for (int i = 0; i < 4; i++)
+	    for (int j = i; j < 4; j++)
+		a[k++] = weight * p[i] * p[j];
+    }
+
+    quadric& operator+=(const quadric& q) {
+	for (int i = 0; i < 10; i++)
+	    a[i] += q.a[i];
+	return *this;
+    }
+
+    // v^T Q v (평면들까지 거리 제곱 합)
+    double error(const point3& v) const {
+	double x = v.x(), y = v.y(), z = v.z();
+	return a[0] * x * x + 2 * a[1] * x * y + 2 * a[2] * x * z + 2 * a[3] * x
+	    + a[4] * y * y + 2 * a[5] * y * z + 2 * a[6] * y
+	    + a[7] * z * z + 2 * a[8] * z
+	    + a[9];
+    }
+
+    // error를 최소로 만드는 위치 (3x3 선형 시스템을 크래머 공식으로 풂)
+    // 행렬이 특이하면(평면, 직선 위의 정점 등) false
+    bool optimal(point3& v) const {
+	double det = a[0] * (a[4] * a[7] - a[5] * a[5])
+	    - a[1] * (a[1] * a[7] - a[5] * a[2])
+	    + a[2] * (a[1] * a[5] - a[4] * a[2]);
+	if (std::fabs(det) < 1e-12)
+	    return false;
+
+	double bx = -a[3], by = -a[6], bz = -a[8];
+	double x = bx * (a[4] * a[7] - a[5] * a[5]) - a[1] * (by * a[7] - a[5] * bz) + a[2] * (by * a[5] - a[4] * bz);
+	double y = a[0] * (by * a[7] - bz * a[5]) - bx * (a[1] * a[7] - a[5] * a[2]) + a[2] * (a[1] * bz - by * a[2]);
+	double z = a[0] * (a[4] * bz - a[5] * by) - a[1] * (a[1] * bz - by * a[2]) + bx * (a[1] * a[5] - a[4] * a[2]);
+	v = point3(x / det, y / det, z / det);
+	return true;
+    }
+};
+
+class mesh_simplifier {
+public:
+    explicit mesh_simplifier(const indexed_mesh& mesh)
+	: positions(mesh.vertices), faces(mesh.faces)
+    {
+	size_t nv = positions.size();
+	quadrics.assign(nv, quadric());
+	vertex_faces.assign(nv, {});
+	version.assign(nv, 0);
+	removed.assign(nv, false);
+	face_removed.assign(faces.size(), false);
+	live_faces = faces.size();
+
+	// 면 평면 quadric을 세 정점에 더함
+	for (size_t f = 0; f < faces.size(); f++) {
+	    vec3 n;
+	    double d;
+	    if (!face_plane(faces[f], n, d)) {
+		// 넓이 0인 면은 처음부터 제외
+		face_removed[f] = true;
+		live_faces--;
+		continue;
+	    }
+	    quadric q(n, d);
+	    for (int k = 0; k < 3; k++) {
+		quadrics[faces[f][k]] += q;
+		vertex_faces[faces[f][k]].push_back(int(f));
+	    }
+	}
+
+	add_boundary_constraints();
+
+	// 모든 간선의 비용 계산
+	for (size_t f = 0; f < faces.size(); f++) {
+	    if (face_removed[f]) continue;
+	    for (int k = 0; k < 3; k++) {
+		int v0 = faces[f][k], v1 = faces[f][(k + 1) % 3];
+		if (v0 < v1) // 공유 간선 중복 방지 (반대 방향은 이웃 면에서 나옴)
+		    push_edge(v0, v1);
+		else if (is_boundary_edge(v0, v1))
+		    push_edge(v1, v0);
+	    }
+	}
+    }
+
+    size_t face_count() const { return live_faces; }
+
+    // 면 개수가 target_faces 이하가 되거나, 다음 collapse 오차가 max_error(거리)를 넘을 때까지 단순화
+    // 이어서 호출하면 앞에서 단순화한 결과에서 계속 진행 -> LOD 체인을 한 번에 만들 수 있음
+    void simplify(size_t target_faces, double max_error = infinity) {
+	double max_cost = max_error * max_error;
+
+	while (live_faces > target_faces && !heap.empty()) {
+	    edge e = heap.top();
+	    if (e.cost > max_cost)
+		break;
+	    heap.pop();
+
+	    // 정점이 이미 합쳐졌거나 주변이 바뀐 뒤의 오래된 항목은 버림
+	    if (removed[e.v0] || removed[e.v1]
+		|| version[e.v0] != e.version0 || version[e.v1] != e.version1)
+		continue;
+
+	    collapse(e);
+	}
+    }
+
+    // 현재 상태를 인덱스를 다시 매긴 메시로 꺼냄
+    indexed_mesh extract() const {
+	indexed_mesh result;
+	std::vector<int> remap(positions.size(), -1);
+
+	for (size_t f = 0; f < faces.size(); f++) {
+	    if (face_removed[f]) continue;
+	    std::array<int, 3> face;
+	    for (int k = 0; k < 3; k++) {
+		int v = faces[f][k];
+		if (remap[v] < 0) {
+		    remap[v] = int(result.vertices.size());
+		    result.vertices.push_back(positions[v]);
+		}
+		face[k] = remap[v];
+	    }
+	    result.faces.push_back(face);
+	}
+	return result;
+    }
+
+private:
+    struct edge {
+	double cost;
+	int v0, v1;               // v1을 v0으로 합침
+	unsigned version0, version1;
+	point3 target;            // 합친 정점의 위치
+
+	bool operator<(const edge& other) const { return cost > other.cost; } // min heap
+    };
+
+    std::vector<point3> positions;
+    std::vector<std::array<int, 3>> faces;
+    std::vector<quadric> quadrics;
+    std::vector<std::vector<int>> vertex_faces; // 정점을 포함하는 면 (지워진 면이 섞여 있을 수 있음)
+    std::vector<unsigned> version;              // 정점 주변이 바뀔 때마다 증가
+    std::vector<bool> removed;
+    std::vector<bool> face_removed;
+    std::priority_queue<edge> heap;
+    size_t live_faces = 0;
+
+    bool face_plane(const std::array<int, 3>& f, vec3& n, double& d) const {
+	vec3 c = cross(positions[f[1]] - positions[f[0]], positions[f[2]] - positions[f[0]]);
+	double len = c.length();
+	if (len < 1e-20)
+	    return false;
+	n = c / len;
+	d = -dot(n, positions[f[0]]);
+	return true;
+    }
+
+    bool is_boundary_edge(int v0, int v1) const {
+	int shared = 0;
+	for (int f : vertex_faces[v0]) {
+	    if (face_removed[f]) continue;
+	    const auto& face = faces[f];
+	    if (face[0] == v1 || face[1] == v1 || face[2] == v1)
+		shared++;
+	}
+	return shared == 1;
+    }
+
+    // 경계 간선은 면에 수직인 평면을 크게 가중해서 더함 -> 구멍 가장자리가 줄어들지 않게 함
+    void add_boundary_constraints() {
+	const double boundary_weight = 1000.0;
+	for (size_t f = 0; f < faces.size(); f++) {
+	    if (face_removed[f]) continue;
+	    vec3 n;
+	    double d;
+	    face_plane(faces[f], n, d);
+	    for (int k = 0; k < 3; k++) {
+		int v0 = faces[f][k], v1 = faces[f][(k + 1) % 3];
+		if (!is_boundary_edge(v0, v1))
+		    continue;
+		vec3 edge_dir = positions[v1] - positions[v0];
+		vec3 side = cross(edge_dir, n);
+		double len = side.length();
+		if (len < 1e-20) continue;
+		side /= len;
+		quadric q(side, -dot(side, positions[v0]), boundary_weight);
+		quadrics[v0] += q;
+		quadrics[v1] += q;
+	    }
+	}
+    }
+
+    void push_edge(int v0, int v1) {
+	quadric q = quadrics[v0];
+	q += quadrics[v1];
+
+	// 최적 위치를 못 구하면 두 끝점과 중점 중 가장 좋은 곳
+	point3 target;
+	if (!q.optimal(target)) {
+	    point3 candidates[] = { positions[v0], positions[v1], 0.5 * (positions[v0] + positions[v1]) };
+	    double best = infinity;
+	    for (const auto& c : candidates) {
+		double err = q.error(c);
+		if (err < best) { best = err; target = c; }
+	    }
+	}
+
+	heap.push({ std::max(0.0, q.error(target)), v0, v1, version[v0], version[v1], target });
+    }
+
+    // 합친 뒤 뒤집히는 면이 있으면 false (면 법선이 크게 바뀌면 뒤집힌 것으로 봄)
+    bool collapse_keeps_orientation(int v, int other, const point3& target) const {
+	for (int f : vertex_faces[v]) {
+	    if (face_removed[f]) continue;
+	    const auto& face = faces[f];
+	    if (face[0] == other || face[1] == other || face[2] == other)
+		continue; // 지워질 면
+
+	    vec3 old_n, new_n;
+	    double d;
+	    if (!face_plane(face, old_n, d)) continue;
+
+	    std::array<point3, 3> p = { positions[face[0]], positions[face[1]], positions[face[2]] };
+	    for (int k = 0; k < 3; k++)
+		if (face[k] == v) p[k] = target;
+	    vec3 c = cross(p[1] - p[0], p[2] - p[0]);
+	    double len = c.length();
+	    if (len < 1e-20) return false;
+	    new_n = c / len;
+	    if (dot(old_n, new_n) < 0.2)
+		return false;
+	}
+	return true;
+    }
+
+    void collapse(const edge& e) {
+	int v0 = e.v0, v1 = e.v1;
+	if (!collapse_keeps_orientation(v0, v1, e.target) || !collapse_keeps_orientation(v1, v0, e.target))
+	    return;
+
+	positions[v0] = e.target;
+	quadrics[v0] += quadrics[v1];
+	removed[v1] = true;
+
+	// v1을 v0으로 바꾸고, 두 정점을 모두 가진 면(간선에 붙은 면)은 지움
+	for (int f : vertex_faces[v1]) {
+	    if (face_removed[f]) continue;
+	    auto& face = faces[f];
+	    bool has_v0 = face[0] == v0 || face[1] == v0 || face[2] == v0;
+	    if (has_v0) {
+		face_removed[f] = true;
+		live_faces--;
+		continue;
+	    }
+	    for (int k = 0; k < 3; k++)
+		if (face[k] == v1) face[k] = v0;
+	    vertex_faces[v0].push_back(f);
+	}
+	vertex_faces[v1].clear();
+
+	// 지워진 면 정리
+	auto& list = vertex_faces[v0];
+	list.erase(std::remove_if(list.begin(), list.end(),
+	    [&](int f) { return face_removed[f]; }), list.end());
+
+	// 비용이 바뀌는 건 v0에 붙은 간선뿐 (다른 간선은 두 끝점의 quadric, 위치가 그대로)
+	// -> v0 버전을 올려 예전 항목을 무효화하고 다시 넣음
+	version[v0]++;
+	std::vector<int> neighbors;
+	for (int f : list)
+	    for (int k = 0; k < 3; k++)
+		if (faces[f][k] != v0)
+		    neighbors.push_back(faces[f][k]);
+	std::sort(neighbors.begin(), neighbors.end());
+	neighbors.erase(std::unique(neighbors.begin(), neighbors.end()), neighbors.end());
+	for (int n : neighbors)
+	    push_edge(v0, n);
+    }
+};
+
+// 파일 내용의 64비트 FNV-1a 해시와 크기 (LOD 캐시가 원본 내용과 맞는지 확인용, 파일을 못 읽으면 false)
+// 수정 시각은 git checkout / 복사로 쉽게 바뀌거나 그대로 남으므로 내용으로 비교
+inline bool file_content_hash(const std::string& path, uint64_t& hash, uint64_t& size) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open())
+	return false;
+    hash = 14695981039346656037ULL;
+    size = 0;
+    char buffer[1 << 16];
+    while (file.read(buffer, sizeof(buffer)) || file.gcount() > 0) {
+	std::streamsize n = file.gcount();
+	for (std::streamsize i = 0; i < n; i++) {
+	    hash ^= uint64_t(static_cast<unsigned char>(buffer[i]));
+	    hash *= 1099511628211ULL;
+	}
+	size += uint64_t(n);
+    }
+    return true;
+}
+
+// source_path의 obj를 단순화한 LOD 체인을 만들어 원본 옆에 캐시
+// 파일 이름: <원본>.qem<면 개수>.obj, 첫 줄 주석에 원본 면 개수 / 크기 / 내용 해시와 max_error를 적어서
+// 원본(면 개수가 같은 수정 포함)이나 설정이 바뀌면 다시 만듦
+// 리턴값은 target_faces 순서대로의 파일 경로 (원본을 못 읽으면 빈 배열)
+inline std::vector<std::string> build_lod_chain(
+    const std::string& source_path,
+    std::vector<size_t> target_faces,
+    double max_error = infinity)
+{
+    std::vector<std::string> paths;
+
+    indexed_mesh source;
+    if (!read_obj(source_path, source)) {
+	std::cerr << "모델 파일 읽기 중 오류 발생: " << source_path << "\n";
+	return paths;
+    }
+
+    uint64_t source_hash = 0, source_bytes = 0;
+    file_content_hash(source_path, source_hash, source_bytes);
+
+    std::string stem = source_path;
+    if (stem.size() > 4 && stem.compare(stem.size() - 4, 4, ".obj") == 0)
+	stem.resize(stem.size() - 4);
+
+    std::sort(target_faces.begin(), target_faces.end(), std::greater<size_t>());
+
+    // 캐시 확인
+    std::vector<std::string> headers;
+    std::vector<bool> cached;
+    bool all_cached = true;
+    for (size_t target : target_faces) {
+	std::ostringstream header;
+	header << "qem source_faces=" << source.faces.size() << " source_bytes=" << source_bytes
+	    << " source_hash=" << std::hex << source_hash << std::dec
+	    << " target=" << target << " max_error=" << max_error;
+	std::string path = stem + ".qem" + std::to_string(target) + ".obj";
+
+	std::ifstream file(path);
+	std::string first_line;
+	bool hit = file.is_open() && std::getline(file, first_line) && first_line == "# " + header.str();
+
+	paths.push_back(path);
+	headers.push_back(header.str());
+	cached.push_back(hit);
+	all_cached = all_cached && hit;
+    }
+    if (all_cached)
+	return paths;
+
+    // 큰 target부터 차례로 단순화하면서 중간 결과를 저장
+    auto start = std::chrono::high_resolution_clock::now();
+    mesh_simplifier simplifier(source);
+    for (size_t i = 0; i < target_faces.size(); i++) {
+	simplifier.simplify(target_faces[i], max_error);
+	if (cached[i])
+	    continue;
+
+	indexed_mesh reduced = simplifier.extract();
+	if (!write_obj(paths[i], reduced, headers[i]))
+	    std::cerr << "LOD 캐시 저장 실패: " << paths[i] << "\n";
+	std::clog << paths[i] << ": " << source.faces.size() << " -> " << reduced.faces.size() << " faces\n";
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    std::clog << "QEM 단순화 시간: "
+	<< std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count() << " ms\n";
+
+    return paths;
+}
+
+#endif
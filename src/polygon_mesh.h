@@ -12,44 +12,122 @@ public:
     ) : face(face), bbox(bbox) { }
 };
 
+// 리프 노드 하나에 들어가는 최대 삼각형 개수
+// 리프의 삼각형들은 SIMD 커널로 한 번에 검사 (AVX-512 기준 한 번, AVX2 기준 두 번)
+// float 메시는 레인이 두 배라서 리프도 두 배
+const size_t mesh_leaf_size = 8;
+
+template <typename T>
+constexpr size_t mesh_leaf_size_of() {
+    return sizeof(T) == sizeof(float) ? 2 * mesh_leaf_size : mesh_leaf_size;
+}
+
+// 메시 삼각형의 SoA 배열
+// BVH를 만든 뒤 정렬된 면 순서대로 저장해서 리프의 삼각형들이 메모리에 연속되게 함
+// T = float면 엣지를 double로 계산한 뒤 float로 저장
+template <typename T>
+class basic_mesh_triangles {
+private:
+    using soa_type = std::conditional_t<std::is_same_v<T, float>, triangle_soa_f32, triangle_soa>;
+
+    // v0, e1 = v1 - v0, e2 = v2 - v0의 x, y, z 성분
+    std::vector<T> v0x, v0y, v0z;
+    std::vector<T> e1x, e1y, e1z;
+    std::vector<T> e2x, e2y, e2z;
+    soa_type view = {};
+
+public:
+    void build(const std::vector<point3>& vertices, const std::vector<triangle_face>& faces) {
+	// 커널이 리프 끝을 넘어 SIMD 폭만큼 읽을 수 있으므로 0으로 패딩
+	// (det = 0인 삼각형은 커널에서 항상 제외됨)
+	size_t padded = faces.size() + 2 * simd_max_width;
+	for (auto* array : { &v0x, &v0y, &v0z, &e1x, &e1y, &e1z, &e2x, &e2y, &e2z })
+	    array->assign(padded, T(0));
+
+	for (size_t i = 0; i < faces.size(); i++) {
+	    const point3& v0 = vertices[faces[i].face[0]];
+	    vec3 e1 = vertices[faces[i].face[1]] - v0;
+	    vec3 e2 = vertices[faces[i].face[2]] - v0;
+	    v0x[i] = T(v0.x()); v0y[i] = T(v0.y()); v0z[i] = T(v0.z());
+	    e1x[i] = T(e1.x()); e1y[i] = T(e1.y()); e1z[i] = T(e1.z());
+	    e2x[i] = T(e2.x()); e2y[i] = T(e2.y()); e2z[i] = T(e2.z());
+	}
+
+	view = {
+	    v0x.data(), v0y.data(), v0z.data(),
+	    e1x.data(), e1y.data(), e1z.data(),
+	    e2x.data(), e2y.data(), e2z.data()
+	};
+    }
+
+    const soa_type& soa() const { return view; }
+
+    size_t memory_bytes() const {
+	return sizeof(*this) + 9 * v0x.capacity() * sizeof(T);
+    }
+
+    vec3 vertex0(size_t i) const { return vec3(v0x[i], v0y[i], v0z[i]); }
+    vec3 edge1(size_t i) const { return vec3(e1x[i], e1y[i], e1z[i]); }
+    vec3 edge2(size_t i) const { return vec3(e2x[i], e2y[i], e2z[i]); }
+};
+
 // 단일 폴리곤 메시에 대한 BVH 알고리즘
-class mesh_bvh_node : public hittable {
+// T: 정점과 노드 bbox를 저장하는 정밀도
+// float면 노드 bbox를 바깥쪽으로 반올림해서 저장하고, 충돌 지점은 barycentric 좌표로 복원한 뒤
+// 반올림 오차 한계(rec.offset)만큼 다음 레이를 밀어냄
+template <typename T>
+class basic_mesh_bvh_node : public hittable {
 private:
-    aabb bbox;
+    using triangles_type = basic_mesh_triangles<T>;
+
+    basic_aabb<T> bbox;
     shared_ptr<hittable> left;
     shared_ptr<hittable> right;
-    std::vector<point3>& vertices;
-    std::vector<triangle_face>& faces;
+
+    // 메시 전체의 삼각형 SoA 배열 (모든 노드가 공유)
+    shared_ptr<triangles_type> triangles;
 
     // 중간 노드는 삼각형과 머티리얼을 가지지 않고 BBOX만 가짐
+    // 리프 노드는 [first, first + count) 범위의 삼각형을 가짐
     bool isLeaf = false;
-    triangle_face& face;
+    size_t first = 0;
+    int count = 0;
     shared_ptr<material> mat = NULL;
 
 public:
-    mesh_bvh_node(
+    basic_mesh_bvh_node(
 	std::vector<point3>& vertices,
 	std::vector<triangle_face>& faces,
 	const shared_ptr<material> mat
-    ) : mesh_bvh_node(vertices, faces, mat, 0, faces.size()) {}
+    ) : basic_mesh_bvh_node(vertices, faces, mat, 0, faces.size(), arena_make_shared<triangles_type>())
+    {
+	// 트리를 만들면서 faces가 BVH 순서로 정렬됨
+	// 정렬이 끝난 뒤 그 순서대로 SoA 배열을 만듦
+	triangles->build(vertices, faces);
+    }
 
     // BVH 트리 만들기
-    mesh_bvh_node(
+    basic_mesh_bvh_node(
 	std::vector<point3>& vertices, 
 	std::vector<triangle_face>& faces,
 	const shared_ptr<material> mat,
 	size_t start,
-	size_t end
-    ) : vertices(vertices), faces(faces), mat(mat), face(faces[start])
+	size_t end,
+	shared_ptr<triangles_type> triangles
+    ) : triangles(triangles), mat(mat)
     {
 	size_t size = end - start;
 
 	// 재귀 종료 조건 검사
-	if (size == 1) {
+	if (size <= mesh_leaf_size_of<T>()) {
 	    // 리프 노드인 경우에만 삼각형과 BBOX를 가짐
 	    isLeaf = true;
-	    face = faces[start];
-	    bbox = face.bbox;
+	    first = start;
+	    count = int(size);
+	    aabb leaf_bbox;
+	    for (size_t i = start; i < end; i++)
+		leaf_bbox = aabb(leaf_bbox, faces[i].bbox);
+	    bbox = basic_aabb<T>(leaf_bbox);
 	    return;
 	}
 
@@ -88,80 +166,59 @@ public:
 
 	// 리스트 분할
 	size_t mid = start + (size / 2);
-	left = make_shared<mesh_bvh_node>(vertices, faces, mat, start, mid);
-	right = make_shared<mesh_bvh_node>(vertices, faces, mat, mid, end);
+	left = arena_make_shared<basic_mesh_bvh_node>(vertices, faces, mat, start, mid, triangles);
+	right = arena_make_shared<basic_mesh_bvh_node>(vertices, faces, mat, mid, end, triangles);
 
 	// 현재 노드의 bbox 계산
-	bbox = aabb(left->bounding_box(), right->bounding_box());
+	bbox = basic_aabb<T>(aabb(left->bounding_box(), right->bounding_box()));
     }
 
     bool hit(const ray& r, interval ray_t, hit_record& rec) const override {
+	RT_STAT_INC(bvh_nodes_visited);
+	RT_STAT_INC(box_tests);
+
 	// 만약 현재 노드가 레이에 부딪히지 않으면
 	if (!bbox.hit(r, ray_t))
 	    return false;
 	
 	// 만약 리프 노드인 경우 Ray-Triangle Intersection 판정
+	// 리프의 삼각형들을 SIMD 커널로 한 번에 검사
 	if (isLeaf) {
-	    point3 v0 = vertices[face.face[0]];
-	    point3 v1 = vertices[face.face[1]];
-	    point3 v2 = vertices[face.face[2]];
-
-	    // 엣지 벡터 2개
-	    vec3 edge1 = v1 - v0;
-	    vec3 edge2 = v2 - v0;
-	    vec3 P = cross(r.direction(), edge2); // P = (D x E2)
-	    double det = dot(P, edge1); // P dot E1
-
-	    // 레이가 삼각형 평면에 평행하다면 바로 false
-	    // 부동 소수점 오차를 줄이기 위해 epsilon 값 사용
-	    double epsilon = std::numeric_limits<double>::epsilon();
-
-	    // two-sided intersection routine
-	    //if (-epsilon < det && det < epsilon) 
-	    //  return false;
-
-	    // one-sided intersection routine
-	    // 정면 삼각형만 렌더링하므로 속도 빠름
-	    if (det <= epsilon)
-		return false;
-
-	    // u, v, t 구하기
-	    // u와 v는 barycentric coordinate이므로 다음 조건을 만족해야 함
-	    // 0 <= u, v <= 1
-	    // u + v <= 1
-
-	    double inv_det = 1.0 / det;
-	    vec3 T = r.origin() - v0;
-	    double u = inv_det * dot(P, T);
-
-	    // u의 유효 범위 검사
-	    if (u < 0 || u > 1)
-		return false;
-
-	    vec3 Q = cross(T, edge1);
-	    double v = inv_det * dot(Q, r.direction());
-
-	    // v의 유효 범위 검사
-	    if (v < 0 || u + v > 1)
-		return false;
+	    RT_STAT_ADD(mesh_triangle_tests, count);
 
-	    double t = inv_det * dot(Q, edge2);
+	    const point3& o = r.origin();
+	    const vec3& d = r.direction();
+	    simd_ray sr = { o.x(), o.y(), o.z(), d.x(), d.y(), d.z() };
 
-	    // t의 유효 범위 검사
-	    // 교차점의 광선이 시작점보다 뒤에 있는 경우는 (t < 0 or t < ray_t.min)
-	    // 유효한 충돌이 아님
-	    if (!ray_t.contains(t))
+	    triangle_hit tri_hit;
+	    int hit_index = intersect_leaf(sr, ray_t, tri_hit);
+	    if (hit_index < 0)
 		return false;
 
 	    // rec에 충돌 정보 담아서 리턴
-	    rec.t = t;
-	    rec.p = r.at(rec.t);
+	    size_t tri = first + hit_index;
+	    rec.t = tri_hit.t;
 	    rec.mat = mat;
 
 	    // 삼각형의 법선 벡터 -> 두 엣지 벡터 외적
-	    vec3 outward_normal = unit_vector(cross(edge1, edge2));
+	    vec3 e1 = triangles->edge1(tri);
+	    vec3 e2 = triangles->edge2(tri);
+	    vec3 outward_normal = unit_vector(cross(e1, e2));
 	    rec.set_face_normal(r, outward_normal);
 
+	    if constexpr (std::is_same_v<T, float>) {
+		// float로 구한 t는 레이 길이에 비례하는 오차가 있으므로 면 위의 점을 barycentric으로 복원
+		// 정점을 float로 저장할 때의 반올림 오차가 남으므로 그만큼 여유를 둠
+		point3 v0 = triangles->vertex0(tri);
+		rec.p = v0 + tri_hit.u * e1 + tri_hit.v * e2;
+		double extent = std::fmax(std::fabs(v0.x()), std::fmax(std::fabs(v0.y()), std::fabs(v0.z())))
+		    + e1.length() + e2.length();
+		rec.offset = 8 * std::numeric_limits<float>::epsilon() * extent;
+	    }
+	    else {
+		rec.p = r.at(rec.t);
+	    }
+
 	    return true;
 	}
 
@@ -175,11 +232,55 @@ public:
 	return hit_left || hit_right;
     }
 
+    // 리프에서 아무 삼각형이나 맞으면 끝 (법선 계산 없음, 자식 순서 / 구간 축소 없음)
+    bool occluded(const ray& r, interval ray_t) const override {
+	RT_STAT_INC(bvh_nodes_visited);
+	RT_STAT_INC(box_tests);
+
+	if (!bbox.hit(r, ray_t))
+	    return false;
+
+	if (isLeaf) {
+	    RT_STAT_ADD(mesh_triangle_tests, count);
+
+	    const point3& o = r.origin();
+	    const vec3& d = r.direction();
+	    simd_ray sr = { o.x(), o.y(), o.z(), d.x(), d.y(), d.z() };
+
+	    triangle_hit tri_hit;
+	    return intersect_leaf(sr, ray_t, tri_hit) >= 0;
+	}
+
+	return left->occluded(r, ray_t) || right->occluded(r, ray_t);
+    }
+
     aabb bounding_box() const override {
-	return bbox;
+	return aabb(bbox);
+    }
+
+    // 노드와 (루트에서는) 삼각형 SoA 배열이 차지하는 메모리
+    // make_shared의 control block 크기는 구현마다 다르므로 포인터 두 개로 어림잡음
+    size_t memory_bytes(bool root = true) const {
+	size_t bytes = sizeof(*this) + 2 * sizeof(void*);
+	if (left) bytes += std::static_pointer_cast<basic_mesh_bvh_node>(left)->memory_bytes(false);
+	if (right) bytes += std::static_pointer_cast<basic_mesh_bvh_node>(right)->memory_bytes(false);
+	if (root && triangles) bytes += triangles->memory_bytes();
+	return bytes;
+    }
+
+private:
+    // 리프의 삼각형들을 정밀도에 맞는 SIMD 커널로 검사
+    int intersect_leaf(const simd_ray& sr, const interval& ray_t, triangle_hit& tri_hit) const {
+	if constexpr (std::is_same_v<T, float>)
+	    return simd().intersect_triangles_f32(triangles->soa(), first, count, sr, ray_t.min, ray_t.max, tri_hit);
+	else
+	    return simd().intersect_triangles(triangles->soa(), first, count, sr, ray_t.min, ray_t.max, tri_hit);
     }
 };
 
+using mesh_triangles = basic_mesh_triangles<rt_real>;
+using mesh_bvh_node = basic_mesh_bvh_node<rt_real>;
+
 class polygon_mesh : public hittable {
 private:
     std::string modelPath; // 모델 경로
@@ -187,34 +288,86 @@ private:
     std::vector<triangle_face> faces; // 면 정보 배열
     std::shared_ptr<material> mat; // 머티리얼
 
-    point3 pos; // 위치
-    vec3 scale; // 스케일
-    // TODO: 회전 기능 추가 -> 4차원 homogeneous matrix
+    matrix4 model_matrix; // 모델 변환 (정점을 읽을 때 적용해서 래퍼 없이 월드 좌표로 저장)
 
     // BVH
     aabb bbox;
     shared_ptr<mesh_bvh_node> mesh_bvh_root;
+    shared_ptr<compressed_mesh_bvh> compressed_root; // compressed 옵션을 켠 경우에만 사용
 public:
+    // compressed: true면 정점 16비트 / 노드 bbox 8비트로 양자화한 BVH 사용 (compressed_mesh.h)
+    // 정점 위치에 bbox 크기 / 65535 이내의 오차가 생기는 대신 메모리가 줄어듦
     polygon_mesh(
 	std::string& modelPath, 
 	const shared_ptr<material> mat,
 	hittable_list& world, 
 	const point3& pos, 
-	const vec3& scale
-    ) : modelPath(modelPath), mat(mat), pos(pos), scale(scale)
+	const vec3& scale,
+	bool compressed = false
+    ) : polygon_mesh(modelPath, mat, world, matrix4::translation(pos) * matrix4::scaling(scale), compressed)
+    {
+    }
+
+    // 회전 등 임의의 affine 변환 (matrix4::translation(...) * matrix4::rotation(...) * ...)
+    // 거울 변환(det < 0)은 면의 감김 방향이 뒤집혀 앞뒤 판정이 바뀜
+    polygon_mesh(
+	std::string& modelPath,
+	const shared_ptr<material> mat,
+	hittable_list& world,
+	const matrix4& model_matrix,
+	bool compressed = false
+    ) : modelPath(modelPath), mat(mat), model_matrix(model_matrix)
     {
 	// 모델 경로 받고 바로 파싱해서 정점과 면 정보를 저장
 	parse_obj();
 
+	// Scene Info 업데이트
+	scene_info::vertices += vertices.size();
+	scene_info::faces += faces.size();
+
 	// bvh 트리 구성
-	mesh_bvh_root = make_shared<mesh_bvh_node>(vertices, faces, mat);
+	mesh_bvh_root = arena_make_shared<mesh_bvh_node>(vertices, faces, mat);
 
 	// BVH 루트의 BBOX == 폴리곤 메시 전체의 BBOX
 	bbox = mesh_bvh_root->bounding_box();
 
-	// Scene Info 업데이트
-	scene_info::vertices += vertices.size();
-	scene_info::faces += faces.size();
+	if (compressed)
+	    compress();
+    }
+
+    // 압축 BVH를 만들고 원래 BVH, 정점, 면 배열은 해제
+    void compress() {
+	if (faces.empty())
+	    return;
+
+	std::vector<compressed_mesh_bvh::triangle_corners> corners;
+	corners.reserve(faces.size());
+	for (const auto& f : faces)
+	    corners.push_back({ vertices[f.face[0]], vertices[f.face[1]], vertices[f.face[2]] });
+
+	double before = double(memory_bytes()) / faces.size();
+	compressed_root = arena_make_shared<compressed_mesh_bvh>(corners, mat);
+	bbox = compressed_root->bounding_box();
+
+	mesh_bvh_root.reset();
+	std::vector<point3>().swap(vertices);
+	std::vector<triangle_face>().swap(faces);
+
+	double after = double(memory_bytes()) / compressed_root->triangle_count();
+	std::clog << modelPath << " 압축: " << before << " -> " << after << " bytes/triangle\n";
+    }
+
+    // 메시 BVH, 정점, 면 배열이 차지하는 메모리
+    size_t memory_bytes() const {
+	if (compressed_root)
+	    return compressed_root->memory_bytes();
+
+	size_t bytes = vertices.capacity() * sizeof(point3) + faces.capacity() * sizeof(triangle_face);
+	for (const auto& f : faces)
+	    bytes += f.face.capacity() * sizeof(int);
+	if (mesh_bvh_root)
+	    bytes += mesh_bvh_root->memory_bytes();
+	return bytes;
     }
     
     // obj 파일 파싱해서 vertex, face 정보 가져옴
@@ -242,12 +395,8 @@ public:
 	    if (identifier == "v") { // vertex인 경우 vertices에 추가
 		double x, y, z;
 		ss >> x >> y >> z;
-		vertices.push_back(point3(
-		    // 지정된 좌표 값을 더함
-		    (x * scale.x()) + pos.x(),
-		    (y * scale.y()) + pos.y(), 
-		    (z * scale.z()) + pos.z()
-		));
+		// 모델 변환 적용
+		vertices.push_back(model_matrix.transform_point(point3(x, y, z)));
 	    }
 	    else if (identifier == "f") { // face인 경우 faces에 추가
 		int v0_idx, v1_idx, v2_idx;
@@ -265,13 +414,25 @@ public:
     }
 
     bool hit(const ray& r, interval ray_t, hit_record& rec) const override {
+	if (compressed_root)
+	    return compressed_root->hit(r, ray_t, rec);
 	return mesh_bvh_root->hit(r, ray_t, rec);
     }
 
+    bool occluded(const ray& r, interval ray_t) const override {
+	if (compressed_root)
+	    return compressed_root->occluded(r, ray_t);
+	return mesh_bvh_root->occluded(r, ray_t);
+    }
+
     aabb bounding_box() const override {
 	return bbox;
     }
 
+    // 파싱된 정점, 면 정보 (벤치마크 등에서 BVH를 따로 만들 때 사용)
+    const std::vector<point3>& get_vertices() const { return vertices; }
+    const std::vector<triangle_face>& get_faces() const { return faces; }
+
     // 모든 면의 bbox 미리 계산
     aabb make_triangle_bbox(const int& v0_idx, const int& v1_idx, const int& v2_idx) {
 	// x, y, z 길이 -> 세 정점 각 성분의 min, max -> interval 구하기
@@ -35,57 +35,77 @@ public:
 
     aabb bounding_box() const override { return bbox; };
 
-    bool hit(const ray& r, interval ray_t, hit_record& rec) const override {
-	auto denominator = dot(normal, r.direction()); // t 구하는 식의 분모
-
-	// 레이와 Quad가 평행하면 분모가 0이 됨
-	if (std::fabs(denominator) < 1e-8)
-	    return false;
-
-	// 레이와 평면의 충돌 지점 t 계산
-	auto t = (D - dot(normal, r.origin())) / denominator;
-	if (!ray_t.contains(t)) // 레이 범위 검사
-	    return false;
+    // affine 변환은 평행사변형을 평행사변형으로 보내고 (alpha, beta)도 그대로이므로 꼭짓점에 직접 적용
+    // 거울 변환(det < 0)은 u x v 법선의 앞뒤가 바뀌므로 (box의 안팎 판정) 래퍼로 남김
+    shared_ptr<hittable> bake_transform(const matrix4& m) const override {
+	if (!m.is_affine() || m.determinant3() <= 0)
+	    return nullptr;
+	return arena_make_shared<quad>(m.transform_point(Q), m.transform_vector(u), m.transform_vector(v), mat);
+    }
 
-	auto intersection = r.at(t); // 레이와 평면의 충돌 지점
-	// 평면의 기준점 O와 레이가 충돌한 지점의 방향 벡터
-	auto planar_hitpt_vector = intersection - Q;
-	// w, 각 변의 방향벡터 uv, 충돌지점 방향벡터로
-	// 평면좌표계 좌표 구하기
-	auto alpha = dot(w, cross(planar_hitpt_vector, v));
-	auto beta = dot(w, cross(u, planar_hitpt_vector));
+    bool hit(const ray& r, interval ray_t, hit_record& rec) const override {
+	RT_STAT_INC(quad_tests);
 
-	if (!is_interior(alpha, beta, rec))
+	double t, alpha, beta;
+	if (!intersect(r, ray_t, t, alpha, beta))
 	    return false;
 
 	// 충돌 정보 전달
 	rec.t = t;
-	rec.p = intersection;
+	rec.p = r.at(t);
 	rec.mat = mat;
 	rec.set_face_normal(r, normal);
+	rec.u = alpha;
+	rec.v = beta;
 
 	return true;
     }
 
+    bool occluded(const ray& r, interval ray_t) const override {
+	RT_STAT_INC(quad_tests);
+	double t, alpha, beta;
+	return intersect(r, ray_t, t, alpha, beta);
+    }
+
     // Interior Test
-    virtual bool is_interior(double a, double b, hit_record& rec) const {
+    // 평면좌표계 (alpha, beta)가 도형 안에 있는지 (uv 좌표는 (alpha, beta) 그대로 사용)
+    virtual bool is_interior(double a, double b) const {
 	auto unit_interval = interval(0, 1);
 
-	// 평면좌표계 (alpha, beta)일 때
 	// 0 <= alpha <= 1, 0 <= beta <= 1 만족하면 Ray가 Quad와 교차한 것
-	if (!unit_interval.contains(a) || !unit_interval.contains(b))
+	return unit_interval.contains(a) && unit_interval.contains(b);
+    }
+
+private:
+    // 레이와 평면의 교차 거리 t와 평면좌표계 (alpha, beta) (hit / occluded 공용)
+    bool intersect(const ray& r, const interval& ray_t, double& t, double& alpha, double& beta) const {
+	auto denominator = dot(normal, r.direction()); // t 구하는 식의 분모
+
+	// 레이와 Quad가 평행하면 분모가 0이 됨
+	if (std::fabs(denominator) < 1e-8)
 	    return false;
 
-	rec.u = a;
-	rec.v = b;
-	return true;
+	// 레이와 평면의 충돌 지점 t 계산
+	t = (D - dot(normal, r.origin())) / denominator;
+	if (!ray_t.contains(t)) // 레이 범위 검사
+	    return false;
+
+	auto intersection = r.at(t); // 레이와 평면의 충돌 지점
+	// 평면의 기준점 O와 레이가 충돌한 지점의 방향 벡터
+	auto planar_hitpt_vector = intersection - Q;
+	// w, 각 변의 방향벡터 uv, 충돌지점 방향벡터로
+	// 평면좌표계 좌표 구하기
+	alpha = dot(w, cross(planar_hitpt_vector, v));
+	beta = dot(w, cross(u, planar_hitpt_vector));
+
+	return is_interior(alpha, beta);
     }
 };
 
 inline shared_ptr<hittable_list> box(const point3& a, const point3& b, shared_ptr<material> mat) {
     // 양 끝점 a와 b로 만들어지는 3D 큐브 리턴
     
-    auto sides = make_shared<hittable_list>();
+    auto sides = arena_make_shared<hittable_list>();
 
     // 양 끝 정점 구하기
     auto min = point3(
@@ -103,12 +123,12 @@ inline shared_ptr<hittable_list> box(const point3& a, const point3& b, shared_pt
     auto dy = vec3(0, max.y() - min.y(), 0);
     auto dz = vec3(0, 0, max.z() - min.z());
 
-    sides->add(make_shared<quad>(point3(min.x(), min.y(), max.z()), dx, dy, mat)); // front
-    sides->add(make_shared<quad>(point3(max.x(), min.y(), max.z()), -dz, dy, mat)); // right
-    sides->add(make_shared<quad>(point3(max.x(), min.y(), min.z()), -dx, dy, mat)); // back
-    sides->add(make_shared<quad>(point3(min.x(), min.y(), min.z()), dz, dy, mat)); // left
-    sides->add(make_shared<quad>(point3(min.x(), max.y(), max.z()), dx, -dz, mat)); // top
-    sides->add(make_shared<quad>(point3(min.x(), min.y(), min.z()), dx, dz, mat)); // bottom
+    sides->add(arena_make_shared<quad>(point3(min.x(), min.y(), max.z()), dx, dy, mat)); // front
+    sides->add(arena_make_shared<quad>(point3(max.x(), min.y(), max.z()), -dz, dy, mat)); // right
+    sides->add(arena_make_shared<quad>(point3(max.x(), min.y(), min.z()), -dx, dy, mat)); // back
+    sides->add(arena_make_shared<quad>(point3(min.x(), min.y(), min.z()), dz, dy, mat)); // left
+    sides->add(arena_make_shared<quad>(point3(min.x(), max.y(), max.z()), dx, -dz, mat)); // top
+    sides->add(arena_make_shared<quad>(point3(min.x(), min.y(), min.z()), dx, dz, mat)); // bottom
 
     return sides;
 }
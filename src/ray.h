@@ -3,27 +3,31 @@
 
 #include "vec3.h"
 
-class ray {
+// 스칼라 타입으로 매개화한 레이 (ray = basic_ray<double>)
+template <typename T>
+class basic_ray {
 private:
-    point3 orig;
-    vec3 dir;
-    double tm; // 레이가 생성된 특정 시각
+    basic_vec3<T> orig;
+    basic_vec3<T> dir;
+    T tm; // 레이가 생성된 특정 시각
 public:
-    ray() {}
+    basic_ray() {}
 
-    ray(const point3& origin, const vec3& direction, double time) 
+    basic_ray(const basic_vec3<T>& origin, const basic_vec3<T>& direction, T time) 
         : orig(origin), dir(direction), tm(time) {}
 
-    ray(const point3& origin, const vec3& direction)
+    basic_ray(const basic_vec3<T>& origin, const basic_vec3<T>& direction)
         : orig(origin), dir(direction), tm(0) {}
 
-    const point3& origin() const { return orig; }
-    const vec3& direction() const { return dir; }
-    double time() const { return tm; }
+    const basic_vec3<T>& origin() const { return orig; }
+    const basic_vec3<T>& direction() const { return dir; }
+    T time() const { return tm; }
 
-    point3 at(double t) const {
+    basic_vec3<T> at(T t) const {
         return orig + t*dir;
     }
 };
 
+using ray = basic_ray<double>;
+
 #endif
\ No newline at end of file
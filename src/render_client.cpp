@@ -0,0 +1,123 @@
+#include "rtWeekend.h"
+#include "local_socket.h"
+
+#include <string>
+
+// 렌더 서버(RaytracingNextWeekend --serve) 테스트용 클라이언트
+// 사용법: render_client [--socket 경로] [--out 파일] <씬> [key=value ...]   렌더해서 ppm 저장
+//         render_client [--socket 경로] list | load <씬> | shutdown
+// key는 render_server.h의 프로토콜 참고 (width=256 spp=16 mode=image ...)
+
+static int usage() {
+    std::cerr << "usage: render_client [--socket path] [--out file.ppm] <scene> [key=value ...]\n"
+	"       render_client [--socket path] list | load <scene> | shutdown\n";
+    return 1;
+}
+
+int main(int argc, char** argv) {
+    std::string socket_path = default_socket_path();
+    std::string out_path = "image.ppm";
+    std::vector<std::string> args;
+    for (int i = 1; i < argc; i++) {
+	std::string arg = argv[i];
+	if (arg == "--socket" && i + 1 < argc)
+	    socket_path = argv[++i];
+	else if (arg == "--out" && i + 1 < argc)
+	    out_path = argv[++i];
+	else
+	    args.push_back(arg);
+    }
+    if (args.empty())
+	return usage();
+
+    local_socket server = local_socket::connect_to(socket_path);
+    if (!server.is_open()) {
+	std::cerr << "서버 연결 실패: " << socket_path << "\n";
+	return 1;
+    }
+
+    // 한 줄 응답 명령
+    if (args[0] == "list" || args[0] == "load" || args[0] == "shutdown") {
+	std::string request, reply;
+	for (const std::string& a : args)
+	    request += (request.empty() ? "" : " ") + a;
+	if (!server.send_line(request) || !server.recv_line(reply))
+	    return 1;
+	std::cout << reply << "\n";
+	return reply.compare(0, 5, "error") == 0 ? 1 : 0;
+    }
+
+    std::string request = "render";
+    for (const std::string& a : args)
+	request += " " + a;
+
+    auto start = std::chrono::steady_clock::now();
+    auto seconds = [&] {
+	std::chrono::duration<double> sec = std::chrono::steady_clock::now() - start;
+	return sec.count();
+    };
+
+    std::string line;
+    if (!server.send_line(request) || !server.recv_line(line))
+	return 1;
+
+    int width = 0, height = 0, tiles_total = 0;
+    std::istringstream begin(line);
+    std::string word;
+    if (!(begin >> word >> width >> height >> tiles_total) || word != "begin") {
+	std::cerr << line << "\n";
+	return 1;
+    }
+
+    // 받은 타일 / 이미지를 모아서 한 장으로
+    std::vector<unsigned char> image(size_t(width) * height * 3, 0);
+    std::vector<unsigned char> tile;
+    int tiles_received = 0;
+    double first_tile = -1;
+
+    while (server.recv_line(line)) {
+	std::istringstream in(line);
+	in >> word;
+	if (word == "tile") {
+	    int x, y, w, h;
+	    in >> x >> y >> w >> h;
+	    tile.resize(size_t(w) * h * 3);
+	    if (!server.recv_exact(tile.data(), tile.size()))
+		break;
+	    for (int row = 0; row < h; row++)
+		std::memcpy(&image[(size_t(y + row) * width + x) * 3], &tile[size_t(row) * w * 3], size_t(w) * 3);
+
+	    if (first_tile < 0)
+		first_tile = seconds();
+	    tiles_received++;
+	    std::clog << "\rTiles: " << tiles_received << " / " << tiles_total << " " << std::flush;
+	}
+	else if (word == "image") {
+	    if (!server.recv_exact(image.data(), image.size()))
+		break;
+	    if (first_tile < 0)
+		first_tile = seconds();
+	}
+	else if (word == "done") {
+	    double render_seconds, load_seconds;
+	    in >> render_seconds >> load_seconds;
+
+	    std::string text = "P3\n" + std::to_string(width) + " " + std::to_string(height) + "\n255\n";
+	    format_ppm_bytes(image.data(), image.size(), text);
+	    std::ofstream out(out_path, std::ios::binary);
+	    out.write(text.data(), text.size());
+
+	    std::clog << "\n" << out_path << ": " << width << " x " << height << "\n";
+	    std::clog << "First pixels: " << first_tile << " s, total: " << seconds() << " s"
+		<< " (server render " << render_seconds << " s, scene load " << load_seconds << " s)\n";
+	    return 0;
+	}
+	else {
+	    std::cerr << "\n" << line << "\n";
+	    return 1;
+	}
+    }
+
+    std::cerr << "\n서버 연결이 끊김\n";
+    return 1;
+}
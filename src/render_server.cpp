@@ -0,0 +1,382 @@
+#include "render_server.h"
+#include "bvh.h"
+
+#include <sstream>
+
+render_server::render_server(const camera& defaults, const server_options& options)
+    : defaults(defaults), options(options)
+{
+}
+
+render_server::~render_server() {
+    stop();
+    for (auto& t : workers)
+	t.join();
+    for (auto& c : connections)
+	c->thread.join();
+}
+
+void render_server::add_scene(const std::string& name, scene_builder builder) {
+    std::lock_guard<std::mutex> lock(scenes_mutex);
+    builders[name] = std::move(builder);
+}
+
+bool render_server::preload(const std::string& name, std::string& error) {
+    return find_scene(name, error) != nullptr;
+}
+
+// 처음 요청된 씬이면 여기서 불러옴
+// 맵을 찾고 넣는 동안만 scenes_mutex를 잡아서, 씬을 불러오는 동안에도 이미 불러온 씬의 요청 / list는 막히지 않음
+const render_server::loaded_scene* render_server::find_scene(const std::string& name, std::string& error) {
+    scene_slot* slot;
+    scene_builder builder;
+    {
+	std::lock_guard<std::mutex> lock(scenes_mutex);
+	auto found = builders.find(name);
+	if (found == builders.end()) {
+	    error = "unknown scene " + name;
+	    return nullptr;
+	}
+	builder = found->second;
+
+	std::unique_ptr<scene_slot>& entry = scenes[name];
+	if (!entry)
+	    entry.reset(new scene_slot());
+	slot = entry.get();
+    }
+
+    std::call_once(slot->once, [&] { slot->scene = load_scene(name, builder); });
+    return slot->scene.get();
+}
+
+// 씬 함수 실행 + BVH 생성 (main.cpp의 build_scene과 같은 순서)
+std::unique_ptr<render_server::loaded_scene> render_server::load_scene(const std::string& name, const scene_builder& builder) {
+    std::lock_guard<std::mutex> lock(build_mutex);
+    auto start = std::chrono::steady_clock::now();
+    auto arena = std::make_unique<scene_arena>(size_t(4) << 20, false);
+    hittable_list world;
+    camera cam = defaults;
+    {
+	arena_scope scope(*arena);
+	std::srand(1); // 씬 함수가 random_double()을 쓰므로 CLI와 같은 씬이 되게
+	builder(world, cam);
+	collapse_transforms(world);
+	world = hittable_list(arena_make_shared<bvh_node>(std::move(world)));
+    }
+    std::chrono::duration<double> sec = std::chrono::steady_clock::now() - start;
+
+    std::clog << "scene " << name << " loaded in " << sec.count() << " s\n";
+    return std::unique_ptr<loaded_scene>(new loaded_scene{ std::move(arena), std::move(world), cam, sec.count() });
+}
+
+bool render_server::run() {
+    std::string error;
+    listener = local_socket::listen_on(options.socket_path, error);
+    if (!listener.is_open()) {
+	std::cerr << "소켓 열기 실패: " << options.socket_path << " (" << error << ")\n";
+	return false;
+    }
+
+    int threads = options.threads > 0 ? options.threads : int(std::thread::hardware_concurrency());
+    for (int i = 0; i < std::max(1, threads); i++)
+	workers.emplace_back(&render_server::worker_loop, this);
+    std::clog << "listening on " << options.socket_path << " (" << workers.size() << " render threads)\n";
+
+    int failures = 0;
+    while (!stopping) {
+	local_socket client = listener.accept_one();
+	if (!client.is_open()) {
+	    if (stopping)
+		break;
+	    // fd가 모자라는 등 accept가 계속 실패하면 바쁜 대기 대신 점점 길게 쉬었다가 다시 시도 (최대 1초)
+	    if (failures++ == 0)
+		std::cerr << "연결 받기 실패, 다시 시도하는 중\n";
+	    std::this_thread::sleep_for(std::chrono::milliseconds(std::min(1000, 10 << std::min(failures, 7))));
+	    continue;
+	}
+	failures = 0;
+
+	std::lock_guard<std::mutex> lock(connections_mutex);
+	reap_connections();
+	auto c = std::make_unique<connection>();
+	c->thread = std::thread(&render_server::serve_connection, this, std::move(client), c.get());
+	connections.push_back(std::move(c));
+    }
+
+    local_socket::remove_file(options.socket_path);
+    return true;
+}
+
+void render_server::stop() {
+    stopping = true;
+    listener.shutdown();
+    {
+	// 잠금 안에서 깨워야 wait에 들어가려던 스레드도 stopping을 봄
+	std::lock_guard<std::mutex> lock(jobs_mutex);
+	work_ready.notify_all();
+	for (auto& job : jobs) {
+	    std::lock_guard<std::mutex> job_lock(job->mutex);
+	    job->changed.notify_all();
+	}
+    }
+    std::lock_guard<std::mutex> lock(connections_mutex);
+    for (local_socket* client : clients)
+	client->shutdown();
+}
+
+// 렌더 시간을 가장 적게 쓴 요청의 타일을 하나씩 렌더
+void render_server::worker_loop() {
+    std::vector<color> pixels;
+    for (;;) {
+	std::shared_ptr<render_job> job;
+	int tile;
+	{
+	    std::unique_lock<std::mutex> lock(jobs_mutex);
+	    work_ready.wait(lock, [&] { return stopping || !jobs.empty(); });
+	    if (stopping)
+		return;
+
+	    auto next = std::min_element(jobs.begin(), jobs.end(),
+		[](const std::shared_ptr<render_job>& a, const std::shared_ptr<render_job>& b) {
+		    return a->used_seconds < b->used_seconds;
+		});
+	    job = *next;
+	    tile = job->next_tile++;
+	    // 타일을 다 나눠준 요청은 목록에서 뺌
+	    if (job->next_tile >= job->frame.tile_count())
+		jobs.erase(next);
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	render_tile result;
+	job->cam.render_tile(*job->world, job->frame, tile, result.x, result.y, result.width, result.height, pixels);
+	std::chrono::duration<double> sec = std::chrono::steady_clock::now() - start;
+	{
+	    std::lock_guard<std::mutex> lock(jobs_mutex);
+	    job->used_seconds += sec.count();
+	}
+
+	{
+	    std::lock_guard<std::mutex> lock(job->mutex);
+	    if (job->stream_tiles) {
+		result.pixels = pixels;
+		job->finished.push_back(std::move(result));
+	    }
+	    else {
+		int width = job->cam.image_width;
+		for (int row = 0; row < result.height; row++)
+		    std::copy(pixels.begin() + size_t(row) * result.width, pixels.begin() + size_t(row + 1) * result.width,
+			job->image.begin() + size_t(result.y + row) * width + result.x);
+	    }
+	    job->tiles_done++;
+	}
+	job->changed.notify_one();
+    }
+}
+
+// 아직 나눠주지 않은 타일은 버리고, 렌더 중인 타일이 끝날 때까지 기다림
+void render_server::cancel_job(const std::shared_ptr<render_job>& job) {
+    int handed_out;
+    {
+	std::lock_guard<std::mutex> lock(jobs_mutex);
+	auto it = std::find(jobs.begin(), jobs.end(), job);
+	if (it != jobs.end())
+	    jobs.erase(it);
+	handed_out = job->next_tile;
+    }
+    std::unique_lock<std::mutex> lock(job->mutex);
+    job->changed.wait(lock, [&] { return job->tiles_done >= handed_out; });
+}
+
+// 선형 색 -> 감마 변환한 8비트 RGB (ppm과 같은 값)
+static std::vector<unsigned char> to_bytes(const std::vector<color>& pixels) {
+    std::vector<unsigned char> bytes(pixels.size() * 3);
+    if (!pixels.empty())
+	simd().linear_to_gamma_bytes(pixels[0].e, bytes.size(), bytes.data());
+    return bytes;
+}
+
+static bool parse_vec3(const std::string& text, vec3& v) {
+    double x, y, z;
+    char c1, c2;
+    std::istringstream in(text);
+    if (!(in >> x >> c1 >> y >> c2 >> z) || c1 != ',' || c2 != ',')
+	return false;
+    v = vec3(x, y, z);
+    return true;
+}
+
+bool render_server::handle_render(local_socket& client, const std::vector<std::string>& args) {
+    if (args.size() < 2)
+	return client.send_line("error usage: render <scene> [key=value ...]");
+
+    std::string error;
+    const loaded_scene* scene = find_scene(args[1], error);
+    if (!scene)
+	return client.send_line("error " + error);
+
+    auto job = std::make_shared<render_job>(scene->settings);
+    camera& cam = job->cam;
+    int tile_size = options.tile_size;
+
+    // 요청의 카메라 설정
+    for (size_t i = 2; i < args.size(); i++) {
+	size_t eq = args[i].find('=');
+	std::string key = args[i].substr(0, eq);
+	std::string value = eq == std::string::npos ? "" : args[i].substr(eq + 1);
+	bool ok = true;
+	try {
+	    if (key == "width") cam.image_width = std::stoi(value);
+	    else if (key == "aspect") cam.aspect_ratio = std::stod(value);
+	    else if (key == "spp") cam.samples_per_pixel = std::stoi(value);
+	    else if (key == "depth") cam.max_depth = std::stoi(value);
+	    else if (key == "seed") cam.sampler_seed = uint32_t(std::stoul(value));
+	    else if (key == "vfov") cam.vfov = std::stod(value);
+	    else if (key == "lookfrom") ok = parse_vec3(value, cam.lookfrom);
+	    else if (key == "lookat") ok = parse_vec3(value, cam.lookat);
+	    else if (key == "tile") tile_size = std::stoi(value);
+	    else if (key == "mode") job->stream_tiles = value != "image";
+	    else ok = false;
+	}
+	catch (const std::exception&) {
+	    ok = false;
+	}
+	if (!ok || cam.image_width < 1 || cam.samples_per_pixel < 1 || tile_size < 1 || cam.aspect_ratio <= 0)
+	    return client.send_line("error bad option " + args[i]);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    cam.begin_tiles(job->frame, tile_size, false); // 연결 스레드에서 OpenMP 팀을 만들지 않음
+    job->world = &scene->world;
+    int width = cam.image_width, height = cam.get_image_height();
+    int tiles_total = job->frame.tile_count();
+    if (!job->stream_tiles)
+	job->image.assign(size_t(width) * height, color(0, 0, 0));
+
+    std::ostringstream header;
+    header << "begin " << width << " " << height << " " << tiles_total;
+    if (!client.send_line(header.str()))
+	return false;
+
+    {
+	// 새 요청은 진행 중인 요청 중 가장 적게 쓴 시간부터 시작 (먼저 온 요청들이 쓴 시간만큼 독차지하지 않게)
+	std::lock_guard<std::mutex> lock(jobs_mutex);
+	if (!jobs.empty()) {
+	    job->used_seconds = jobs.front()->used_seconds;
+	    for (auto& other : jobs)
+		job->used_seconds = std::min(job->used_seconds, other->used_seconds);
+	}
+	jobs.push_back(job);
+    }
+    work_ready.notify_all();
+
+    // 끝난 타일을 받는 대로 전송 (전송은 이 연결 스레드에서 해서 느린 클라이언트가 렌더 스레드를 막지 않음)
+    int tiles_sent = 0;
+    for (;;) {
+	std::deque<render_tile> ready;
+	bool done;
+	{
+	    std::unique_lock<std::mutex> lock(job->mutex);
+	    job->changed.wait(lock, [&] {
+		return stopping || !job->finished.empty() || job->tiles_done == tiles_total;
+	    });
+	    ready.swap(job->finished);
+	    done = job->tiles_done == tiles_total;
+	}
+	if (stopping && !done) {
+	    cancel_job(job);
+	    return false;
+	}
+
+	for (const render_tile& tile : ready) {
+	    std::ostringstream line;
+	    line << "tile " << tile.x << " " << tile.y << " " << tile.width << " " << tile.height;
+	    std::vector<unsigned char> bytes = to_bytes(tile.pixels);
+	    if (!client.send_line(line.str()) || !client.send_all(bytes.data(), bytes.size())) {
+		cancel_job(job); // 클라이언트가 연결을 끊음
+		return false;
+	    }
+	    tiles_sent++;
+	}
+	if (done && (!job->stream_tiles || tiles_sent == tiles_total))
+	    break;
+    }
+
+    if (!job->stream_tiles) {
+	std::ostringstream line;
+	line << "image " << width << " " << height;
+	std::vector<unsigned char> bytes = to_bytes(job->image);
+	if (!client.send_line(line.str()) || !client.send_all(bytes.data(), bytes.size()))
+	    return false;
+    }
+
+    std::chrono::duration<double> sec = std::chrono::steady_clock::now() - start;
+    std::ostringstream line;
+    line << "done " << sec.count() << " " << scene->load_seconds;
+    return client.send_line(line.str());
+}
+
+// 끝난 연결 스레드를 join해서 정리 (connections_mutex 안에서 호출)
+void render_server::reap_connections() {
+    for (auto it = connections.begin(); it != connections.end(); ) {
+	if ((*it)->done) {
+	    (*it)->thread.join();
+	    it = connections.erase(it);
+	}
+	else {
+	    ++it;
+	}
+    }
+}
+
+void render_server::serve_connection(local_socket client, connection* self) {
+    {
+	std::lock_guard<std::mutex> lock(connections_mutex);
+	clients.push_back(&client);
+    }
+
+    std::string line;
+    while (!stopping && client.recv_line(line)) {
+	std::istringstream in(line);
+	std::vector<std::string> args;
+	for (std::string word; in >> word; )
+	    args.push_back(word);
+	if (args.empty())
+	    continue;
+
+	bool ok;
+	if (args[0] == "render") {
+	    ok = handle_render(client, args);
+	}
+	else if (args[0] == "load" && args.size() == 2) {
+	    std::string error;
+	    const loaded_scene* scene = find_scene(args[1], error);
+	    ok = client.send_line(scene ? "loaded " + args[1] + " " + std::to_string(scene->load_seconds) : "error " + error);
+	}
+	else if (args[0] == "shutdown") {
+	    client.send_line("bye");
+	    stop();
+	    ok = false;
+	}
+	else if (args[0] == "list") {
+	    std::string names = "scenes";
+	    {
+		std::lock_guard<std::mutex> lock(scenes_mutex);
+		for (auto& b : builders)
+		    names += " " + b.first;
+	    }
+	    ok = client.send_line(names);
+	}
+	else {
+	    ok = client.send_line("error unknown command " + args[0]);
+	}
+	if (!ok)
+	    break;
+    }
+
+    {
+	std::lock_guard<std::mutex> lock(connections_mutex);
+	clients.erase(std::find(clients.begin(), clients.end(), &client));
+    }
+    self->done = true; // 이후로는 self를 건드리지 않음 (reap_connections가 join하고 지움)
+}
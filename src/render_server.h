@@ -0,0 +1,134 @@
+#ifndef RENDER_SERVER_H
+#define RENDER_SERVER_H
+
+// 씬을 메모리에 올려둔 채로 렌더 요청을 받는 서버 (RaytracingNextWeekend --serve)
+// 프로세스 시작 / OBJ 파싱 / BVH 빌드는 씬마다 처음 한 번만 하고, 이후 요청은 바로 렌더 시작
+//
+// 프로토콜 (Unix domain socket, 요청 / 응답 헤더는 한 줄 텍스트):
+//   list                              -> scenes <이름> ...
+//   load <씬>                          -> loaded <씬> <불러오는 데 걸린 초>
+//   shutdown                          -> bye (서버 종료)
+//   render <씬> [key=value ...]        -> begin <width> <height> <타일 수>
+//                                         tile <x> <y> <w> <h> + w*h*3 바이트   (mode=tiles, 기본)
+//                                         image <w> <h> + w*h*3 바이트          (mode=image)
+//                                         done <렌더 초> <씬 불러온 초>
+//   실패하면 error <메시지>
+//   key: width, aspect, spp, depth, seed, vfov, lookfrom=x,y,z, lookat=x,y,z, tile, mode=tiles|image
+//   (lod_mesh의 LOD는 씬을 불러올 때 씬 함수의 카메라로 고른 것을 그대로 씀, lod_mesh.h)
+//   픽셀은 감마 변환한 8비트 RGB (ppm과 같은 값), 위 -> 아래
+//
+// 렌더 스레드는 서버 전체가 하나의 풀을 같이 쓰고, 진행 중인 요청 중 지금까지 렌더 시간을 가장 적게 쓴 요청에 다음 타일을 줌
+// -> 동시에 들어온 요청들이 spp / 씬 복잡도와 관계없이 스레드 시간을 같은 비율로 나눠 씀
+//    (먼저 온 큰 요청이 나중 요청을 막지 않음)
+
+#include "rtWeekend.h"
+#include "interval.h"
+#include "aabb.h"
+#include "hittable.h"
+#include "hittable_list.h"
+#include "camera.h"
+#include "render_session.h"
+#include "local_socket.h"
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <thread>
+
+// main.cpp의 sceneN과 같은 모양: world를 채우고 카메라 위치 등을 설정
+typedef std::function<void(hittable_list&, camera&)> scene_builder;
+
+struct server_options {
+    std::string socket_path = default_socket_path();
+    int threads = 0;     // 렌더 스레드 수 (0이면 논리 코어 수)
+    int tile_size = 32;  // 요청에 tile이 없을 때
+};
+
+class render_server {
+public:
+    // defaults: 요청이 덮어쓰지 않은 카메라 설정 (씬 함수가 그 위에 위치 등을 설정)
+    render_server(const camera& defaults, const server_options& options);
+    ~render_server();
+
+    render_server(const render_server&) = delete;
+    render_server& operator=(const render_server&) = delete;
+
+    void add_scene(const std::string& name, scene_builder builder);
+
+    // 씬을 미리 불러둠 (아니면 그 씬의 첫 요청 때 불러옴)
+    bool preload(const std::string& name, std::string& error);
+
+    // 소켓을 열고 stop()이 불릴 때까지 요청 처리 (소켓을 못 열면 false)
+    bool run();
+    void stop();
+
+private:
+    // 불러온 씬: arena가 world보다 나중에 해제되게 먼저 선언
+    struct loaded_scene {
+	std::unique_ptr<scene_arena> arena;
+	hittable_list world;   // 월드 BVH 하나
+	camera settings;       // 씬 함수가 설정한 카메라
+	double load_seconds = 0;
+    };
+
+    struct render_job {
+	explicit render_job(const camera& cam) : cam(cam) {}
+
+	camera cam;
+	camera::tile_frame frame;
+	const hittable* world = nullptr;
+	bool stream_tiles = true;
+	int next_tile = 0;     // 다음에 나눠줄 타일 (jobs_mutex)
+	double used_seconds = 0; // 이 요청에 쓴 렌더 스레드 시간 (jobs_mutex)
+
+	std::mutex mutex;      // 아래 멤버
+	std::condition_variable changed;
+	std::deque<render_tile> finished; // 연결 스레드가 아직 보내지 않은 타일
+	std::vector<color> image;         // mode=image일 때 전체 이미지
+	int tiles_done = 0;
+    };
+
+    camera defaults;
+    server_options options;
+    local_socket listener;
+    std::atomic<bool> stopping{ false };
+
+    // 씬 하나: 처음 요청한 스레드가 once 안에서 불러오고, 같은 씬을 요청한 다른 스레드는 끝날 때까지 기다림
+    struct scene_slot {
+	std::once_flag once;
+	std::unique_ptr<loaded_scene> scene;
+    };
+
+    std::mutex scenes_mutex; // builders / scenes 맵 (씬을 불러오는 동안은 잡지 않음)
+    std::map<std::string, scene_builder> builders;
+    std::map<std::string, std::unique_ptr<scene_slot>> scenes;
+    std::mutex build_mutex;  // 씬 불러오기는 한 번에 하나 (arena / std::rand가 전역)
+
+    // 렌더 스레드 풀 + 아직 나눠줄 타일이 남은 요청
+    std::mutex jobs_mutex;
+    std::condition_variable work_ready;
+    std::vector<std::shared_ptr<render_job>> jobs;
+    std::vector<std::thread> workers;
+
+    // 연결 하나를 처리하는 스레드 (끝나면 done, 다음 연결을 받을 때 join해서 지움)
+    struct connection {
+	std::thread thread;
+	std::atomic<bool> done{ false };
+    };
+
+    std::mutex connections_mutex;
+    std::vector<std::unique_ptr<connection>> connections;
+    std::vector<local_socket*> clients; // stop()에서 막혀 있는 recv를 깨우기 위해
+
+    const loaded_scene* find_scene(const std::string& name, std::string& error);
+    std::unique_ptr<loaded_scene> load_scene(const std::string& name, const scene_builder& builder);
+    void worker_loop();
+    void serve_connection(local_socket client, connection* self);
+    void reap_connections();
+    bool handle_render(local_socket& client, const std::vector<std::string>& args);
+    void cancel_job(const std::shared_ptr<render_job>& job);
+};
+
+#endif
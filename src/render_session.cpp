@@ -0,0 +1,136 @@
+#include "render_session.h"
+
+render_session::render_session(shared_ptr<hittable> world, const camera& settings,
+    std::unique_ptr<scene_arena> arena, int tile_size)
+    : arena(std::move(arena)), world(std::move(world)), next_settings(settings), tile_size(std::max(1, tile_size))
+{
+}
+
+render_session::~render_session() {
+    cancel();
+    if (worker.joinable())
+	worker.join();
+}
+
+void render_session::set_tile_callback(tile_callback new_callback) {
+    std::lock_guard<std::mutex> lock(mutex);
+    callback = std::move(new_callback);
+}
+
+bool render_session::start() {
+    if (state.load() == int(render_state::running))
+	return false;
+    if (worker.joinable())
+	worker.join();
+
+    // 이미지 크기는 initialize()에서 정해지므로 미리 한 번 계산해서 framebuffer를 맞춰둠
+    active = std::make_unique<camera>(next_settings);
+    int w = active->image_width;
+    int h = std::max(1, int(w / active->aspect_ratio));
+    {
+	std::lock_guard<std::mutex> lock(mutex);
+	width = w;
+	height = h;
+	framebuffer.assign(size_t(w) * h, color(0, 0, 0));
+    }
+    launch(((w + tile_size - 1) / tile_size) * ((h + tile_size - 1) / tile_size), false);
+    return true;
+}
+
+bool render_session::start_edit(const scene_edit& edit, shared_ptr<hittable> new_world) {
+    if (state.load() != int(render_state::finished) || !active)
+	return false;
+    if (worker.joinable())
+	worker.join();
+
+    if (new_world)
+	world = std::move(new_world);
+    pending_edit = edit;
+    launch(int(active->affected_tiles(frame, edit).size()), true);
+    return true;
+}
+
+void render_session::launch(int tiles, bool incremental) {
+    tiles_total = tiles;
+    tiles_done = 0;
+    finished_seconds = 0;
+    cancel_requested = false;
+    start_time = std::chrono::steady_clock::now();
+    state = int(render_state::running);
+
+    worker = std::thread(&render_session::run, this, incremental);
+}
+
+void render_session::cancel() {
+    cancel_requested = true;
+}
+
+void render_session::wait() {
+    std::unique_lock<std::mutex> lock(mutex);
+    finished.wait(lock, [&] { return state.load() != int(render_state::running); });
+}
+
+render_progress render_session::progress() const {
+    render_progress p;
+    p.state = render_state(state.load());
+    p.tiles_done = tiles_done.load();
+    p.tiles_total = tiles_total;
+    if (p.state == render_state::running) {
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start_time;
+	p.elapsed_seconds = elapsed.count();
+    }
+    else {
+	p.elapsed_seconds = finished_seconds.load();
+    }
+    return p;
+}
+
+bool render_session::poll_tile(render_tile& tile) {
+    return tiles.pop(tile);
+}
+
+std::vector<color> render_session::image() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return framebuffer;
+}
+
+void render_session::run(bool incremental) {
+    auto on_tile = [&](int x, int y, int w, int h, const std::vector<color>& pixels) {
+	render_tile tile;
+	tile.x = x;
+	tile.y = y;
+	tile.width = w;
+	tile.height = h;
+	tile.pixels = pixels;
+
+	tile_callback current;
+	{
+	    // 타일끼리 겹치지 않지만 image()가 동시에 읽을 수 있으므로 잠금 안에서 복사
+	    std::lock_guard<std::mutex> lock(mutex);
+	    for (int row = 0; row < h; row++)
+		std::copy(pixels.begin() + size_t(row) * w, pixels.begin() + size_t(row + 1) * w,
+		    framebuffer.begin() + size_t(y + row) * width + x);
+	    current = callback;
+	}
+
+	// 콜백은 잠금 밖에서 (콜백 안에서 image() / progress()를 불러도 되게)
+	tiles_done++;
+	if (current)
+	    current(tile);
+	else
+	    tiles.push(std::move(tile));
+    };
+
+    // 편집 후에는 영향받은 타일만 지우고 다시 렌더 (나머지 framebuffer 픽셀은 그대로)
+    bool completed = incremental
+	? active->rerender_tiles(*world, frame, pending_edit, cancel_requested, on_tile)
+	: active->render_tiles(*world, frame, tile_size, cancel_requested, on_tile);
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start_time;
+    finished_seconds = elapsed.count();
+    {
+	std::lock_guard<std::mutex> lock(mutex);
+	state = int(completed ? render_state::finished : render_state::cancelled);
+    }
+    finished.notify_all();
+}
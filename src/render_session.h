@@ -0,0 +1,159 @@
+#ifndef RENDER_SESSION_H
+#define RENDER_SESSION_H
+
+// 다른 프로그램에 렌더러를 넣어서 쓰기 위한 API (rt_render 라이브러리)
+// 미리 만든 씬을 가지고 렌더를 시작 / 중단 / 상태 조회하고, 끝난 타일을 바로 받아볼 수 있음
+// 라이브러리 안에서는 파일을 쓰거나 다른 프로세스를 실행하지 않음 (저장 / 표시는 호출하는 쪽에서)
+//
+// 사용법:
+//   render_session session(world, cam);                       // world: BVH까지 만든 씬
+//   session.set_tile_callback([](const render_tile& t) {...}); // 렌더 스레드에서 호출
+//   session.start();                                          // 바로 리턴, 렌더는 백그라운드
+//   while (session.poll_tile(tile)) ...                        // 콜백 대신 큐로 받을 수도 있음
+//   session.progress(); session.cancel(); session.wait();
+//   std::vector<color> pixels = session.image();
+//   session.start_edit(edit);                                 // 씬을 고친 뒤 영향받는 타일만 다시 렌더
+
+#include "rtWeekend.h"
+#include "interval.h"
+#include "aabb.h"
+#include "hittable.h"
+#include "camera.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+// 끝난 타일 (선형 RGB 픽셀 평균, 감마 변환 전)
+struct render_tile {
+    int x = 0, y = 0;          // 이미지에서 타일 왼쪽 위 픽셀
+    int width = 0, height = 0;
+    std::vector<color> pixels; // width * height개, 위 -> 아래
+};
+
+enum class render_state { idle, running, finished, cancelled };
+
+struct render_progress {
+    render_state state = render_state::idle;
+    int tiles_done = 0;
+    int tiles_total = 0;
+    double elapsed_seconds = 0;
+};
+
+// 여러 생산자(렌더 스레드) / 소비자 하나 lock-free 큐 (Vyukov MPSC)
+// push는 노드 하나를 head와 바꿔치기(exchange)만 하므로 렌더 스레드끼리 기다리지 않음
+// pop은 소비자 스레드 하나에서만 호출
+template <typename T>
+class mpsc_queue {
+public:
+    mpsc_queue() : head(new node()), tail(head.load()) {}
+
+    ~mpsc_queue() {
+	T value;
+	while (pop(value)) {}
+	delete tail;
+    }
+
+    mpsc_queue(const mpsc_queue&) = delete;
+    mpsc_queue& operator=(const mpsc_queue&) = delete;
+
+    void push(T value) {
+	node* n = new node();
+	n->value = std::move(value);
+	node* previous = head.exchange(n, std::memory_order_acq_rel);
+	previous->next.store(n, std::memory_order_release);
+    }
+
+    // 꺼낼 값이 없으면 false (push가 절반만 끝난 값도 아직 없는 것으로 봄)
+    bool pop(T& value) {
+	node* next = tail->next.load(std::memory_order_acquire);
+	if (!next)
+	    return false;
+	value = std::move(next->value);
+	delete tail;
+	tail = next; // 값을 꺼낸 노드가 새 stub
+	return true;
+    }
+
+private:
+    struct node {
+	std::atomic<node*> next{ nullptr };
+	T value;
+    };
+
+    std::atomic<node*> head; // 생산자가 붙이는 쪽
+    node* tail;              // 소비자가 꺼내는 쪽 (stub)
+};
+
+class render_session {
+public:
+    typedef std::function<void(const render_tile&)> tile_callback;
+
+    // world: 렌더할 씬 (세션이 참조를 가짐)
+    // arena: world를 arena_make_shared로 만들었다면 그 arena (세션이 world보다 오래 유지)
+    render_session(shared_ptr<hittable> world, const camera& settings,
+	std::unique_ptr<scene_arena> arena = nullptr, int tile_size = 32);
+    ~render_session(); // 렌더 중이면 중단하고 기다림
+
+    render_session(const render_session&) = delete;
+    render_session& operator=(const render_session&) = delete;
+
+    // 다음 start()에 사용할 카메라 설정 (렌더 중에 바꿔도 진행 중인 렌더에는 영향 없음)
+    camera& settings() { return next_settings; }
+
+    // 끝난 타일마다 렌더 스레드에서 호출 (여러 스레드에서 동시에 불릴 수 있으므로 짧게 끝내야 함)
+    // 콜백이 없으면 타일을 큐에 넣어두고 poll_tile()로 꺼냄
+    void set_tile_callback(tile_callback callback);
+
+    // 백그라운드에서 렌더 시작 (이미 렌더 중이면 false)
+    bool start();
+    // 씬을 편집한 뒤 영향받는 타일만 다시 렌더 (tile_dependencies.h)
+    // 마지막 start()와 같은 카메라 설정을 쓰고, 나머지 타일은 이전 결과를 그대로 둠
+    // world가 있으면 편집한 씬으로 바꿈 (물체를 옮겨서 BVH를 다시 만든 경우 등, 같은 arena에 만든 것)
+    // 마지막 렌더가 끝까지 가지 않았거나 렌더 중이면 false
+    bool start_edit(const scene_edit& edit, shared_ptr<hittable> world = nullptr);
+    // 중단 요청: 진행 중인 타일만 끝내고 멈춤 (바로 리턴, 끝나기를 기다리려면 wait())
+    void cancel();
+    // 렌더가 끝날 때까지 기다림 (진행 중이 아니면 바로 리턴)
+    void wait();
+
+    render_progress progress() const;
+    // 콜백이 없을 때 끝난 타일 하나 꺼내기 (소비자 스레드 하나에서만 호출)
+    bool poll_tile(render_tile& tile);
+    // 지금까지 끝난 타일로 채운 이미지 (아직 안 끝난 픽셀은 0)
+    std::vector<color> image() const;
+    int image_width() const { return width; }
+    int image_height() const { return height; }
+
+private:
+    // 선언 순서 = 해제 역순: arena가 world보다 나중에 해제됨
+    std::unique_ptr<scene_arena> arena;
+    shared_ptr<hittable> world;
+    camera next_settings;
+    int tile_size;
+
+    std::thread worker;
+    std::atomic<bool> cancel_requested{ false };
+    std::atomic<int> state{ int(render_state::idle) };
+    std::atomic<int> tiles_done{ 0 };
+    int tiles_total = 0;
+    std::unique_ptr<camera> active;  // 진행 중 / 마지막 렌더의 카메라
+    camera::tile_frame frame;        // 마지막 렌더의 누적 버퍼 + 타일 의존성 (start_edit에서 재사용)
+    scene_edit pending_edit;
+    std::chrono::steady_clock::time_point start_time;
+    std::atomic<double> finished_seconds{ 0 };
+
+    mutable std::mutex mutex; // framebuffer, callback, done
+    std::condition_variable finished;
+    tile_callback callback;
+    std::vector<color> framebuffer;
+    int width = 0, height = 0;
+    mpsc_queue<render_tile> tiles;
+
+    void launch(int tiles, bool incremental);
+    void run(bool incremental);
+};
+
+#endif
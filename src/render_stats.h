@@ -0,0 +1,219 @@
+﻿#ifndef RENDER_STATS_H
+#define RENDER_STATS_H
+
+// 레이/순회 통계 카운터
+// RT_ENABLE_STATS가 정의된 빌드(Debug)에서만 동작
+// 정의되지 않으면 RT_STAT_* 매크로가 모두 비어 있어 릴리즈 빌드에서는 비용이 없음
+// RT_ENABLE_HEATMAP(-DRT_HEATMAP=ON)만 정의하면 BVH 순회 비용 heatmap용 카운터(아래)만 켜짐
+//
+// 카운터는 스레드마다 따로 가지고(thread_local) 렌더가 끝난 뒤 한 번에 합산
+// -> 렌더 중에는 atomic 연산이나 락 없이 증가만 함
+
+#include <cstdint>
+
+enum stat_counter {
+    stat_primary_rays,        // 카메라에서 나간 레이
+    stat_secondary_rays,      // 산란으로 생긴 레이
+    stat_shadow_rays,         // 광원(환경 맵) 직접 샘플링의 가림 검사 레이
+    stat_bvh_nodes_visited,   // 방문한 BVH 노드 (bvh_node + mesh_bvh_node)
+    stat_box_tests,           // aabb::hit 호출
+    stat_sphere_tests,        // primitive별 교차 검사
+    stat_quad_tests,
+    stat_triangle_tests,
+    stat_mesh_triangle_tests,
+    stat_counter_count
+};
+
+// BVH 순회 비용 heatmap(camera::primary_ray_cost)에 들어가는 카운터: 방문한 노드 + primitive 검사
+constexpr bool is_traversal_cost(stat_counter counter) {
+    return counter == stat_bvh_nodes_visited
+	|| (counter >= stat_sphere_tests && counter <= stat_mesh_triangle_tests);
+}
+
+#if defined(RT_ENABLE_STATS) || defined(RT_ENABLE_HEATMAP)
+#define RT_TRAVERSAL_COST 1
+
+// 현재 스레드의 순회 비용 측정 상태
+// 렌더 중에는 counting 플래그를 읽는 비용만 내고, 측정 레이를 추적하는 동안만 cost를 올림
+struct traversal_cost_state {
+    bool counting = false;
+    uint64_t cost = 0;
+};
+
+inline traversal_cost_state& traversal_cost() {
+    thread_local traversal_cost_state state;
+    return state;
+}
+
+template <stat_counter counter>
+inline void add_traversal_cost(uint64_t n) {
+    if constexpr (is_traversal_cost(counter)) {
+	traversal_cost_state& state = traversal_cost();
+	if (state.counting)
+	    state.cost += n;
+    }
+}
+
+#endif
+
+#ifdef RT_ENABLE_STATS
+
+#include <mutex>
+#include <iomanip>
+
+// 경로 길이 히스토그램 크기, 마지막 칸은 그 이상을 모두 포함
+const int stat_max_path_length = 32;
+
+struct ray_stats {
+    uint64_t counters[stat_counter_count] = {};
+    uint64_t path_length[stat_max_path_length + 1] = {};
+
+    void record_path(int length) {
+	if (length > stat_max_path_length) length = stat_max_path_length;
+	if (length < 0) length = 0;
+	path_length[length]++;
+    }
+
+    void add(const ray_stats& other) {
+	for (int i = 0; i < stat_counter_count; i++)
+	    counters[i] += other.counters[i];
+	for (int i = 0; i <= stat_max_path_length; i++)
+	    path_length[i] += other.path_length[i];
+    }
+
+    void clear() { *this = ray_stats(); }
+};
+
+class render_stats {
+private:
+    // 살아있는 스레드의 카운터 목록과, 종료된 스레드의 카운터 합
+    struct registry {
+	std::mutex lock;
+	std::vector<ray_stats*> live;
+	ray_stats retired;
+    };
+
+    static registry& get_registry() {
+	static registry reg;
+	return reg;
+    }
+
+    // 스레드가 처음 카운터를 쓸 때 등록되고, 스레드가 끝나면 합계에 더해짐
+    struct thread_slot {
+	ray_stats stats;
+
+	thread_slot() {
+	    auto& reg = get_registry();
+	    std::lock_guard<std::mutex> guard(reg.lock);
+	    reg.live.push_back(&stats);
+	}
+
+	~thread_slot() {
+	    auto& reg = get_registry();
+	    std::lock_guard<std::mutex> guard(reg.lock);
+	    reg.retired.add(stats);
+	    reg.live.erase(std::find(reg.live.begin(), reg.live.end(), &stats));
+	}
+    };
+
+    static const char* counter_name(int counter) {
+	static const char* names[stat_counter_count] = {
+	    "Primary rays", "Secondary rays", "Shadow rays", "BVH nodes visited", "Box tests",
+	    "Sphere tests", "Quad tests", "Triangle tests", "Mesh triangle tests"
+	};
+	return names[counter];
+    }
+public:
+    // 현재 스레드의 카운터
+    static ray_stats& local() {
+	thread_local thread_slot slot;
+	return slot.stats;
+    }
+
+    // 모든 스레드의 카운터 합산
+    // 렌더 루프가 끝난 뒤(다른 스레드가 카운터를 쓰지 않을 때) 호출해야 함
+    static ray_stats collect() {
+	auto& reg = get_registry();
+	std::lock_guard<std::mutex> guard(reg.lock);
+	ray_stats total = reg.retired;
+	for (auto* stats : reg.live)
+	    total.add(*stats);
+	return total;
+    }
+
+    static void reset() {
+	auto& reg = get_registry();
+	std::lock_guard<std::mutex> guard(reg.lock);
+	reg.retired.clear();
+	for (auto* stats : reg.live)
+	    stats->clear();
+    }
+
+    // 합계, 레이 당 평균, Mrays/sec, 경로 길이 히스토그램 출력
+    static void report(std::ostream& out, double render_seconds) {
+	ray_stats total = collect();
+	uint64_t rays = total.counters[stat_primary_rays] + total.counters[stat_secondary_rays];
+	double per_ray = rays > 0 ? 1.0 / double(rays) : 0.0;
+
+	out << "\nRAY STATS\n";
+	for (int i = 0; i < stat_counter_count; i++) {
+	    out << counter_name(i) << ": " << total.counters[i];
+	    if (i >= stat_bvh_nodes_visited)
+		out << " (" << std::fixed << std::setprecision(2)
+		    << total.counters[i] * per_ray << " / ray)" << std::defaultfloat;
+	    out << "\n";
+	}
+
+	if (render_seconds > 0)
+	    out << "Mrays/sec: " << std::fixed << std::setprecision(3)
+		<< rays / render_seconds * 1e-6 << std::defaultfloat << "\n";
+
+	// 경로 길이 = 경로 하나에서 추적한 레이 개수
+	uint64_t paths = 0;
+	double length_sum = 0;
+	for (int i = 0; i <= stat_max_path_length; i++) {
+	    paths += total.path_length[i];
+	    length_sum += double(i) * total.path_length[i];
+	}
+	if (paths == 0) return;
+
+	out << "Path length (mean " << std::fixed << std::setprecision(2)
+	    << length_sum / paths << std::defaultfloat << ")\n";
+	for (int i = 0; i <= stat_max_path_length; i++) {
+	    if (total.path_length[i] == 0) continue;
+	    out << "  " << std::setw(3) << i << (i == stat_max_path_length ? "+" : " ") << ": "
+		<< total.path_length[i] << " (" << std::fixed << std::setprecision(1)
+		<< 100.0 * total.path_length[i] / paths << "%)" << std::defaultfloat << "\n";
+	}
+    }
+};
+
+#define RT_STAT_INC(counter) (render_stats::local().counters[stat_##counter]++, add_traversal_cost<stat_##counter>(1))
+#define RT_STAT_ADD(counter, n) (render_stats::local().counters[stat_##counter] += (n), add_traversal_cost<stat_##counter>(n))
+#define RT_STAT_PATH_LENGTH(length) (render_stats::local().record_path(length))
+#define RT_STATS_RESET() (render_stats::reset())
+// 통계에 넣지 않을 레이(heatmap 측정용 등)를 추적하기 전후로 현재 스레드의 카운터를 저장 / 복원
+#define RT_STATS_SAVE(name) ray_stats name = render_stats::local()
+#define RT_STATS_RESTORE(name) (render_stats::local() = (name))
+
+#elif defined(RT_ENABLE_HEATMAP)
+
+#define RT_STAT_INC(counter) (add_traversal_cost<stat_##counter>(1))
+#define RT_STAT_ADD(counter, n) (add_traversal_cost<stat_##counter>(n))
+#define RT_STAT_PATH_LENGTH(length) ((void)0)
+#define RT_STATS_RESET() ((void)0)
+#define RT_STATS_SAVE(name) ((void)0)
+#define RT_STATS_RESTORE(name) ((void)0)
+
+#else
+
+#define RT_STAT_INC(counter) ((void)0)
+#define RT_STAT_ADD(counter, n) ((void)0)
+#define RT_STAT_PATH_LENGTH(length) ((void)0)
+#define RT_STATS_RESET() ((void)0)
+#define RT_STATS_SAVE(name) ((void)0)
+#define RT_STATS_RESTORE(name) ((void)0)
+
+#endif
+
+#endif
@@ -0,0 +1,451 @@
+#ifndef RENDER_THREADS_H
+#define RENDER_THREADS_H
+
+// 렌더 스레드 수 / CPU 고정(pinning) / NUMA 배치
+//
+// 기본값(threads = 0, pinning = none)은 OpenMP 기본 스레드 수 + 줄 단위 dynamic 스케줄과 같음
+// pinning을 켜면 스레드마다 CPU 하나에 고정하고, 이미지를 NUMA 노드마다 연속된 줄 묶음(band)으로 나눔
+// -> 각 노드의 스레드는 자기 노드 band의 줄을 먼저 렌더하고, 다 끝나면 다른 band에서 가져옴
+// -> 프레임버퍼도 band 단위로 그 노드의 스레드가 처음 건드려서(first touch) 노드 메모리에 놓임
+//
+// NUMA 노드 정보는 Linux의 /sys/devices/system/node에서 읽고, 다른 플랫폼은 노드 하나로 취급
+// RT_NUMA_NODES=N 환경 변수로 CPU를 N개 노드로 나눈 것처럼 동작시킬 수 있음 (단일 소켓에서 테스트용)
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <new>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#elif defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#endif
+
+// none: OS에 맡김
+// compact: 노드 0의 CPU부터 차례로 채움 (스레드가 적으면 한 소켓에 모임)
+// spread: 노드를 돌아가며 하나씩 배치 (스레드가 적어도 모든 소켓의 메모리 대역폭 사용)
+enum class thread_pinning { none, compact, spread };
+
+inline const char* thread_pinning_name(thread_pinning pinning) {
+    switch (pinning) {
+    case thread_pinning::compact: return "compact";
+    case thread_pinning::spread: return "spread";
+    default: return "none";
+    }
+}
+
+struct thread_options {
+    int threads = 0; // 0이면 OpenMP 기본값 (OMP_NUM_THREADS 또는 논리 코어 수)
+    thread_pinning pinning = thread_pinning::none;
+};
+
+// NUMA 노드별 CPU 목록 (프로세스가 사용할 수 있는 CPU만)
+class numa_topology {
+public:
+    static const numa_topology& system() {
+	static const numa_topology topology = detect();
+	return topology;
+    }
+
+    int node_count() const { return int(nodes.size()); }
+    const std::vector<int>& node_cpus(int node) const { return nodes[node]; }
+
+    int cpu_count() const {
+	int count = 0;
+	for (const auto& cpus : nodes)
+	    count += int(cpus.size());
+	return count;
+    }
+
+    // 스레드 번호 -> 고정할 CPU와 그 CPU의 노드 (none이면 둘 다 -1)
+    void place(int thread, thread_pinning pinning, int& cpu, int& node) const {
+	cpu = -1;
+	node = -1;
+	if (pinning == thread_pinning::none || cpu_count() == 0)
+	    return;
+
+	if (pinning == thread_pinning::spread) {
+	    node = thread % node_count();
+	    const auto& cpus = nodes[node];
+	    cpu = cpus[(thread / node_count()) % cpus.size()];
+	    return;
+	}
+
+	int index = thread % cpu_count();
+	for (node = 0; index >= int(nodes[node].size()); node++)
+	    index -= int(nodes[node].size());
+	cpu = nodes[node][index];
+    }
+
+private:
+    std::vector<std::vector<int>> nodes;
+
+    static numa_topology detect() {
+	numa_topology topology;
+	std::vector<int> allowed = allowed_cpus();
+
+#ifdef __linux__
+	std::ifstream online("/sys/devices/system/node/online");
+	std::string line;
+	if (online && std::getline(online, line)) {
+	    for (int node : parse_cpu_list(line)) {
+		std::ifstream list("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+		std::string cpu_line;
+		if (!list || !std::getline(list, cpu_line))
+		    continue;
+		std::vector<int> cpus;
+		for (int cpu : parse_cpu_list(cpu_line))
+		    if (std::find(allowed.begin(), allowed.end(), cpu) != allowed.end())
+			cpus.push_back(cpu);
+		// 메모리만 있는 노드, cpuset에서 빠진 노드는 제외
+		if (!cpus.empty())
+		    topology.nodes.push_back(cpus);
+	    }
+	}
+#endif
+	if (topology.nodes.empty())
+	    topology.nodes.push_back(allowed);
+
+	// 테스트용: CPU를 N개 노드로 고르게 나눔 (CPU가 N개보다 적으면 같은 CPU를 여러 노드에 둠)
+	if (const char* fake = std::getenv("RT_NUMA_NODES")) {
+	    int count = std::atoi(fake);
+	    if (count > 0) {
+		std::vector<int> cpus;
+		for (const auto& node : topology.nodes)
+		    cpus.insert(cpus.end(), node.begin(), node.end());
+		topology.nodes.assign(count, {});
+		if (int(cpus.size()) < count) {
+		    for (int node = 0; node < count; node++)
+			topology.nodes[node].push_back(cpus[node % cpus.size()]);
+		}
+		else {
+		    for (size_t i = 0; i < cpus.size(); i++)
+			topology.nodes[i * count / cpus.size()].push_back(cpus[i]);
+		}
+	    }
+	}
+	return topology;
+    }
+
+    static std::vector<int> allowed_cpus() {
+	std::vector<int> cpus;
+#ifdef __linux__
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+	    for (int cpu = 0; cpu < CPU_SETSIZE; cpu++)
+		if (CPU_ISSET(cpu, &set))
+		    cpus.push_back(cpu);
+	}
+#endif
+	if (cpus.empty()) {
+	    int count = std::max(1, int(std::thread::hardware_concurrency()));
+	    for (int cpu = 0; cpu < count; cpu++)
+		cpus.push_back(cpu);
+	}
+	return cpus;
+    }
+
+    // "0-3,8-11" 형식
+    static std::vector<int> parse_cpu_list(const std::string& text) {
+	std::vector<int> values;
+	size_t pos = 0;
+	while (pos < text.size()) {
+	    size_t comma = text.find(',', pos);
+	    std::string range = text.substr(pos, comma == std::string::npos ? std::string::npos : comma - pos);
+	    size_t dash = range.find('-');
+	    if (!range.empty() && range[0] != '\n') {
+		int first = std::atoi(range.c_str());
+		int last = dash == std::string::npos ? first : std::atoi(range.c_str() + dash + 1);
+		for (int v = first; v <= last; v++)
+		    values.push_back(v);
+	    }
+	    if (comma == std::string::npos)
+		break;
+	    pos = comma + 1;
+	}
+	return values;
+    }
+};
+
+// 현재 스레드를 cpus 중 하나에서만 돌게 함 (지원하지 않는 플랫폼이면 false)
+inline bool pin_current_thread(const std::vector<int>& cpus) {
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : cpus)
+	CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#elif defined(_WIN32)
+    DWORD_PTR mask = 0;
+    for (int cpu : cpus)
+	if (cpu < int(8 * sizeof(DWORD_PTR)))
+	    mask |= DWORD_PTR(1) << cpu;
+    return mask != 0 && SetThreadAffinityMask(GetCurrentThread(), mask) != 0;
+#else
+    (void)cpus;
+    return false;
+#endif
+}
+
+// 스레드의 CPU affinity를 저장해 두었다가 소멸할 때 되돌림
+// render_team::join()이 렌더 스레드를 고정하기 전에 저장하고, 병렬 구간이 끝나면(스코프를 벗어나면) 복원
+// -> OpenMP 풀의 스레드와 병렬 구간을 연 스레드가 다음 렌더 / 다른 코드에서 CPU 하나에 묶여 있지 않게 함
+class thread_affinity_guard {
+public:
+    thread_affinity_guard() = default;
+    ~thread_affinity_guard() { restore(); }
+
+    thread_affinity_guard(const thread_affinity_guard&) = delete;
+    thread_affinity_guard& operator=(const thread_affinity_guard&) = delete;
+
+    // 현재 affinity 저장 (이미 저장했으면 처음 것을 유지)
+    void save() {
+	if (saved)
+	    return;
+#ifdef __linux__
+	CPU_ZERO(&original);
+	saved = pthread_getaffinity_np(pthread_self(), sizeof(original), &original) == 0;
+#elif defined(_WIN32)
+	// 스레드의 현재 마스크를 읽는 API가 없으므로 프로세스 마스크로 잠깐 바꾸면서 이전 값을 받음
+	DWORD_PTR process_mask, system_mask;
+	if (GetProcessAffinityMask(GetCurrentProcess(), &process_mask, &system_mask)) {
+	    original = SetThreadAffinityMask(GetCurrentThread(), process_mask);
+	    saved = original != 0;
+	}
+#endif
+    }
+
+    void restore() {
+	if (!saved)
+	    return;
+#ifdef __linux__
+	pthread_setaffinity_np(pthread_self(), sizeof(original), &original);
+#elif defined(_WIN32)
+	SetThreadAffinityMask(GetCurrentThread(), original);
+#endif
+	saved = false;
+    }
+
+private:
+    bool saved = false;
+#ifdef __linux__
+    cpu_set_t original;
+#elif defined(_WIN32)
+    DWORD_PTR original = 0;
+#endif
+};
+
+inline int current_thread_index() {
+#ifdef _OPENMP
+    return omp_get_thread_num();
+#else
+    return 0;
+#endif
+}
+
+// 렌더 한 번의 스레드 배치와 줄 분배
+// 사용법:
+//   render_team team(options, image_height);
+//   #pragma omp parallel num_threads(team.size())
+//   {
+//       thread_affinity_guard affinity;      // 구간이 끝나면 원래 affinity로 복원
+//       int band = team.join(affinity);      // CPU 고정 + 이 스레드의 band
+//       for (int j; (j = team.next_row(band)) >= 0; ) ...
+//   }
+//   team.reset();                            // 같은 분배로 다시 돌릴 때
+class render_team {
+public:
+    render_team(const thread_options& options, int rows)
+	: pinning(options.pinning), topology(numa_topology::system())
+    {
+#ifdef _OPENMP
+	thread_count = options.threads > 0 ? options.threads : omp_get_max_threads();
+#else
+	thread_count = 1;
+#endif
+
+	// 노드마다 그 노드에 배치된 스레드 수에 비례하는 줄 묶음
+	// 고정하지 않으면 스레드가 어느 노드에서 돌지 모르므로 band 하나
+	int band_total = pinning == thread_pinning::none ? 1 : topology.node_count();
+	std::vector<int> weight(band_total, 0);
+	for (int t = 0; t < thread_count; t++) {
+	    int cpu, node;
+	    topology.place(t, pinning, cpu, node);
+	    weight[node < 0 ? 0 : node]++;
+	}
+
+	band_count = band_total;
+	bands.reset(new band[band_count]);
+	int begin = 0, assigned = 0;
+	for (int b = 0; b < band_count; b++) {
+	    assigned += weight[b];
+	    int end = b + 1 == band_count ? rows : int(int64_t(rows) * assigned / thread_count);
+	    bands[b].begin = begin;
+	    bands[b].end = end;
+	    begin = end;
+	}
+	reset();
+    }
+
+    int size() const { return thread_count; }
+    bool pinned() const { return pinning != thread_pinning::none; }
+    int bands_total() const { return band_count; }
+    int band_begin(int b) const { return bands[b].begin; }
+    int band_end(int b) const { return bands[b].end; }
+
+    // 병렬 구간 안에서 스레드마다 한 번 호출
+    // pinning이면 원래 affinity를 affinity에 저장하고 CPU에 고정한 뒤 그 CPU의 노드 번호(= band)를 리턴, 아니면 0
+    int join(thread_affinity_guard& affinity) const {
+	int cpu, node;
+	topology.place(current_thread_index(), pinning, cpu, node);
+	if (cpu < 0)
+	    return 0;
+	affinity.save();
+	pin_current_thread({ cpu });
+	return node;
+    }
+
+    // band의 다음 줄 (없으면 steal이 true일 때 다른 band에서 가져옴, 모두 끝나면 -1)
+    int next_row(int home, bool steal = true) {
+	int row = bands[home].take();
+	if (row >= 0 || !steal)
+	    return row;
+	for (int k = 1; k < band_count; k++) {
+	    row = bands[(home + k) % band_count].take();
+	    if (row >= 0)
+		return row;
+	}
+	return -1;
+    }
+
+    void reset() {
+	for (int b = 0; b < band_count; b++)
+	    bands[b].next.store(bands[b].begin, std::memory_order_relaxed);
+    }
+
+private:
+    // 노드마다 다른 캐시 라인에 두어 카운터끼리 false sharing이 없게 함
+    struct alignas(64) band {
+	std::atomic<int> next{ 0 };
+	int begin = 0;
+	int end = 0;
+
+	int take() {
+	    if (next.load(std::memory_order_relaxed) >= end)
+		return -1;
+	    int row = next.fetch_add(1, std::memory_order_relaxed);
+	    return row < end ? row : -1;
+	}
+    };
+
+    thread_pinning pinning;
+    const numa_topology& topology;
+    int thread_count = 1;
+    int band_count = 1;
+    std::unique_ptr<band[]> bands;
+};
+
+// 할당만 하고 값은 채우지 않는 배열
+// Linux는 페이지를 처음 쓰는 스레드의 NUMA 노드에 물리 메모리를 배정하므로(first touch),
+// 각 범위를 그 범위를 렌더할 스레드에서 fill()하면 프레임버퍼가 노드별로 나뉘어 놓임
+// (std::vector는 생성할 때 할당한 스레드가 전부 0으로 채워서 한 노드에 몰림)
+template <typename T>
+class first_touch_buffer {
+    static_assert(std::is_trivially_destructible<T>::value, "소멸자를 부르지 않으므로 trivially destructible만 가능");
+
+public:
+    first_touch_buffer() = default;
+    ~first_touch_buffer() { release(); }
+
+    first_touch_buffer(const first_touch_buffer&) = delete;
+    first_touch_buffer& operator=(const first_touch_buffer&) = delete;
+
+    void allocate(size_t n) {
+	release();
+	count = n;
+	if (n == 0)
+	    return;
+#ifdef __linux__
+	// 익명 mmap 페이지는 처음 쓸 때 물리 메모리가 배정됨 (malloc은 재사용한 힙 메모리일 수 있음)
+	void* p = mmap(nullptr, n * sizeof(T), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (p != MAP_FAILED) {
+	    items = static_cast<T*>(p);
+	    mapped = true;
+	    return;
+	}
+#endif
+	items = static_cast<T*>(::operator new(n * sizeof(T)));
+    }
+
+    // [begin, end)를 value로 채움
+    void fill(size_t begin, size_t end, const T& value) {
+	for (size_t i = begin; i < end; i++)
+	    new (items + i) T(value);
+    }
+
+    T& operator[](size_t i) { return items[i]; }
+    const T& operator[](size_t i) const { return items[i]; }
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    T* begin() { return items; }
+    T* end() { return items + count; }
+    const T* begin() const { return items; }
+    const T* end() const { return items + count; }
+
+private:
+    T* items = nullptr;
+    size_t count = 0;
+    bool mapped = false;
+
+    void release() {
+	if (!items)
+	    return;
+#ifdef __linux__
+	if (mapped)
+	    munmap(items, count * sizeof(T));
+	else
+#endif
+	    ::operator delete(items);
+	items = nullptr;
+	count = 0;
+	mapped = false;
+    }
+};
+
+// 노드마다 그 노드의 CPU에 고정한 스레드에서 build(node)를 차례로 실행
+// build 안에서 만든 씬(arena 블록, BVH 노드, 정점 배열)이 그 노드 메모리에 놓임
+// 씬 생성 코드가 전역 상태(std::rand, 현재 arena)를 쓰므로 동시에 돌리지 않고 하나씩 실행
+template <typename F>
+void run_on_each_numa_node(F&& build) {
+    const numa_topology& topology = numa_topology::system();
+    for (int node = 0; node < topology.node_count(); node++) {
+	std::thread worker([&build, &topology, node]() {
+	    pin_current_thread(topology.node_cpus(node));
+	    build(node);
+	});
+	worker.join();
+    }
+}
+
+#endif
@@ -11,6 +11,7 @@
 #include <chrono>
 #include <vector>
 #include <algorithm>
+#include <type_traits>
 
 // C++ std usings
 
@@ -22,6 +23,15 @@ using std::shared_ptr;
 const double infinity = std::numeric_limits<double>::infinity(); // double 최댓값
 const double pi = 3.1415926535897932385;
 
+// 메시 정점 / BVH bbox / 프레임버퍼를 저장하는 정밀도
+// RT_FLOAT32로 빌드하면 float (메모리 절반, SIMD 레인 두 배)
+// 레이, 구, 쿼드 같은 해석적 도형 계산은 항상 double (반지름 1000인 바닥 구 등)
+#ifdef RT_FLOAT32
+typedef float rt_real;
+#else
+typedef double rt_real;
+#endif
+
 // 유틸리티 함수
 
 // 도 -> 라디안 변환
@@ -46,10 +56,13 @@ inline int random_int(int min, int max) {
 
 // Common Header
 
+#include "simd_kernels.h"
 #include "color.h"
 #include "ray.h"
 #include "vec3.h"
 #include "vec4.h"
 #include "mat4.h"
+#include "render_stats.h"
+#include "arena.h"
 
 #endif
\ No newline at end of file
@@ -0,0 +1,12 @@
+// stb_image 구현부 (rtw_stb_image.h는 선언만 include)
+#ifdef _MSC_VER
+#pragma warning (push, 0)
+#endif
+
+#define STB_IMAGE_IMPLEMENTATION
+#define STBI_FAILURE_USERMSG
+#include "external/stb_image.h"
+
+#ifdef _MSC_VER
+#pragma warning (pop)
+#endif
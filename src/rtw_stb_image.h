@@ -6,7 +6,7 @@
 #pragma warning (push, 0)
 #endif
 
-#define STB_IMAGE_IMPLEMENTATION
+// 구현부는 rtw_stb_image.cpp에서 한 번만 컴파일 (여러 파일에서 include해도 심볼이 겹치지 않게)
 #define STBI_FAILURE_USERMSG
 #include "external/stb_image.h"
 
@@ -44,7 +44,7 @@ public:
 
     ~rtw_image() {
         delete[] bdata;
-        STBI_FREE(fdata);
+        stbi_image_free(fdata);
     }
 
     bool load(const std::string& filename) {
@@ -78,6 +78,19 @@ public:
         return bdata + y * bytes_per_scanline + x * bytes_per_pixel;
     }
 
+    const float* float_pixel_data(int x, int y) const {
+        // Return the address of the three linear RGB floats of the pixel at x,y. Unlike
+        // pixel_data(), values from HDR files are not clamped to [0, 1]. If there is no image
+        // data, returns magenta.
+        static float magenta[] = { 1, 0, 1 };
+        if (fdata == nullptr) return magenta;
+
+        x = clamp(x, 0, image_width);
+        y = clamp(y, 0, image_height);
+
+        return fdata + y * bytes_per_scanline + x * bytes_per_pixel;
+    }
+
 private:
     const int      bytes_per_pixel = 3;
     float* fdata = nullptr;         // Linear floating point pixel data
@@ -0,0 +1,332 @@
+#ifndef SAMPLER_H
+#define SAMPLER_H
+
+// 픽셀 샘플에 쓰는 난수 공급기
+// 픽셀 위치, 렌즈, 시간, 반사 방향 등 샘플 하나가 쓰는 난수를 "차원" 순서대로 하나씩 꺼내 씀
+//
+// random     : 차원마다 독립적인 균일 난수 (예전 방식, 수렴 O(1/sqrt(N)))
+// owen_sobol : 픽셀 / 차원마다 다르게 섞은 Owen-scrambled Sobol (Burley 2020)
+//              앞 N개 샘플이 항상 고르게 퍼져 있어서 같은 spp에서 오차가 훨씬 작음
+// blue_noise : 모든 픽셀이 같은 Owen-scrambled Sobol을 쓰고 픽셀마다 blue noise 값만큼 평행이동
+//              (Georgiev & Fajardo 2016) -> 남는 오차가 고주파 노이즈가 되어 눈에 덜 띔
+
+#include <cstdint>
+#include <memory>
+
+struct sample2 {
+    double u, v; // [0, 1)
+};
+
+class sampler {
+public:
+    virtual ~sampler() = default;
+
+    // 픽셀 (i, j)의 index번째 샘플 시작 (차원을 처음부터 다시 셈)
+    virtual void start_pixel_sample(int i, int j, int index) {}
+
+    virtual double get_1d() = 0;
+    virtual sample2 get_2d() = 0;
+};
+
+class random_sampler : public sampler {
+public:
+    double get_1d() override { return random_double(); }
+    sample2 get_2d() override { return { random_double(), random_double() }; }
+};
+
+// ---------------------------------------------------------------------
+// 정수 해시와 Owen scrambling
+
+inline uint32_t hash_u32(uint32_t x) {
+    x ^= x >> 16;
+    x *= 0x7feb352dU;
+    x ^= x >> 15;
+    x *= 0x846ca68bU;
+    x ^= x >> 16;
+    return x;
+}
+
+inline uint32_t hash_combine(uint32_t seed, uint32_t value) {
+    return seed ^ (hash_u32(value) + 0x9e3779b9U + (seed << 6) + (seed >> 2));
+}
+
+inline uint32_t reverse_bits(uint32_t x) {
+    x = (x << 16) | (x >> 16);
+    x = ((x & 0x00ff00ffU) << 8) | ((x & 0xff00ff00U) >> 8);
+    x = ((x & 0x0f0f0f0fU) << 4) | ((x & 0xf0f0f0f0U) >> 4);
+    x = ((x & 0x33333333U) << 2) | ((x & 0xccccccccU) >> 2);
+    x = ((x & 0x55555555U) << 1) | ((x & 0xaaaaaaaaU) >> 1);
+    return x;
+}
+
+// 각 비트가 자기보다 낮은 비트에만 영향을 받는 해시 (Laine-Karras permutation, Burley 개선판)
+inline uint32_t laine_karras_permutation(uint32_t x, uint32_t seed) {
+    x ^= x * 0x3d20adeaU;
+    x += seed;
+    x *= (seed >> 16) | 1;
+    x ^= x * 0x05526c56U;
+    x ^= x * 0x53a22864U;
+    return x;
+}
+
+// 비트를 뒤집어서 적용하면 상위 비트가 하위 비트를 섞음 = Owen scrambling
+inline uint32_t nested_uniform_scramble(uint32_t x, uint32_t seed) {
+    return reverse_bits(laine_karras_permutation(reverse_bits(x), seed));
+}
+
+// Sobol 수열의 처음 두 차원
+// 0차원은 van der Corput, 1차원은 원시 다항식 x + 1의 방향 벡터
+inline uint32_t sobol_dimension0(uint32_t index) {
+    return reverse_bits(index);
+}
+
+inline uint32_t sobol_dimension1(uint32_t index) {
+    uint32_t result = 0;
+    for (uint32_t v = 1U << 31; index; index >>= 1, v ^= v >> 1)
+	if (index & 1)
+	    result ^= v;
+    return result;
+}
+
+inline double u32_to_unit(uint32_t x) {
+    return x * (1.0 / 4294967296.0); // [0, 1)
+}
+
+// seed마다 다르게 섞은 2D Sobol의 index번째 점
+// 더 높은 차원은 2D 쌍마다 다른 seed로 섞어서 씀 (padding) -> 차원끼리 상관관계 없음
+inline void owen_sobol_2d(uint32_t index, uint32_t seed, uint32_t& x, uint32_t& y) {
+    index = nested_uniform_scramble(index, hash_combine(seed, 0)); // 샘플 순서 섞기
+    x = nested_uniform_scramble(sobol_dimension0(index), hash_combine(seed, 1));
+    y = nested_uniform_scramble(sobol_dimension1(index), hash_combine(seed, 2));
+}
+
+inline uint32_t owen_sobol_1d(uint32_t index, uint32_t seed) {
+    index = nested_uniform_scramble(index, hash_combine(seed, 0));
+    return nested_uniform_scramble(sobol_dimension0(index), hash_combine(seed, 1));
+}
+
+class owen_sobol_sampler : public sampler {
+public:
+    explicit owen_sobol_sampler(uint32_t seed = 0) : seed(seed) {}
+
+    void start_pixel_sample(int i, int j, int index) override {
+	pixel_seed = hash_combine(hash_combine(seed, uint32_t(i)), uint32_t(j));
+	sample_index = uint32_t(index);
+	dimension = 0;
+    }
+
+    double get_1d() override {
+	return u32_to_unit(owen_sobol_1d(sample_index, hash_combine(pixel_seed, dimension++)));
+    }
+
+    sample2 get_2d() override {
+	uint32_t x, y;
+	owen_sobol_2d(sample_index, hash_combine(pixel_seed, dimension++), x, y);
+	return { u32_to_unit(x), u32_to_unit(y) };
+    }
+
+private:
+    uint32_t seed;
+    uint32_t pixel_seed = 0;
+    uint32_t sample_index = 0;
+    uint32_t dimension = 0;
+};
+
+// ---------------------------------------------------------------------
+// Blue noise 마스크 (void-and-cluster, Ulichney 1993)
+// 64x64 타일의 각 픽셀에 0~4095 순위를 매겨서, 어느 순위까지 잘라도 점들이 고르게 퍼지게 함
+// 처음 사용할 때 한 번 만듦 (수십 ms)
+
+class blue_noise_mask {
+public:
+    enum { size = 64 };
+
+    blue_noise_mask() {
+	const int n = size * size;
+
+	// 토러스 위 가우시안 에너지 커널 (sigma = 1.5)
+	std::vector<double> kernel(n);
+	for (int dy = 0; dy < size; dy++)
+	    for (int dx = 0; dx < size; dx++) {
+		int wx = std::min(dx, size - dx);
+		int wy = std::min(dy, size - dy);
+		kernel[dy * size + dx] = std::exp(-(wx * wx + wy * wy) / (2 * 1.5 * 1.5));
+	    }
+
+	std::vector<char> pattern(n, 0);
+	std::vector<double> energy(n, 0.0);
+	auto toggle = [&](int p, bool on) {
+	    pattern[p] = on;
+	    int px = p % size, py = p / size;
+	    double sign = on ? 1.0 : -1.0;
+	    for (int qy = 0; qy < size; qy++) {
+		const double* row = &kernel[((qy - py) & (size - 1)) * size];
+		for (int qx = 0; qx < size; qx++)
+		    energy[qy * size + qx] += sign * row[(qx - px) & (size - 1)];
+	    }
+	};
+	// 점 중 에너지가 가장 큰 곳 (tightest cluster) / 빈 곳 중 에너지가 가장 작은 곳 (largest void)
+	auto tightest_cluster = [&]() {
+	    int best = -1;
+	    for (int p = 0; p < n; p++)
+		if (pattern[p] && (best < 0 || energy[p] > energy[best]))
+		    best = p;
+	    return best;
+	};
+	auto largest_void = [&]() {
+	    int best = -1;
+	    for (int p = 0; p < n; p++)
+		if (!pattern[p] && (best < 0 || energy[p] < energy[best]))
+		    best = p;
+	    return best;
+	};
+
+	// 1. 초기 패턴: 10% 랜덤 점 -> 가장 뭉친 점을 가장 빈 곳으로 옮기기를 더 바뀌지 않을 때까지
+	uint32_t state = 1;
+	int initial_count = n / 10;
+	for (int placed = 0; placed < initial_count;) {
+	    state = hash_u32(state + 0x9e3779b9U);
+	    int p = int(state % uint32_t(n));
+	    if (!pattern[p]) {
+		toggle(p, true);
+		placed++;
+	    }
+	}
+	for (int iteration = 0; iteration < n; iteration++) {
+	    int cluster = tightest_cluster();
+	    toggle(cluster, false);
+	    int hole = largest_void();
+	    toggle(hole, true);
+	    if (hole == cluster)
+		break;
+	}
+
+	std::vector<char> initial_pattern = pattern;
+	std::vector<double> initial_energy = energy;
+	std::vector<int> rank(n);
+
+	// 2. 초기 점들의 순위: 가장 뭉친 점부터 빼면서 뒤 순위를 줌
+	for (int ones = initial_count; ones > 0; ones--) {
+	    int p = tightest_cluster();
+	    toggle(p, false);
+	    rank[p] = ones - 1;
+	}
+
+	// 3. 나머지 순위: 가장 빈 곳부터 채움
+	pattern.swap(initial_pattern);
+	energy.swap(initial_energy);
+	for (int r = initial_count; r < n; r++) {
+	    int p = largest_void();
+	    toggle(p, true);
+	    rank[p] = r;
+	}
+
+	values.resize(n);
+	for (int p = 0; p < n; p++)
+	    values[p] = (rank[p] + 0.5) / n;
+    }
+
+    // 바둑판처럼 반복 (음수 좌표 포함)
+    double value(int x, int y) const {
+	return values[(y & (size - 1)) * size + (x & (size - 1))];
+    }
+
+private:
+    std::vector<double> values;
+};
+
+inline const blue_noise_mask& blue_noise() {
+    static const blue_noise_mask mask;
+    return mask;
+}
+
+class blue_noise_sampler : public sampler {
+public:
+    explicit blue_noise_sampler(uint32_t seed = 0) : seed(seed), mask(blue_noise()) {}
+
+    void start_pixel_sample(int i, int j, int index) override {
+	pixel_x = i;
+	pixel_y = j;
+	sample_index = uint32_t(index);
+	dimension = 0;
+    }
+
+    double get_1d() override {
+	uint32_t d = dimension++;
+	return rotate(u32_to_unit(owen_sobol_1d(sample_index, hash_combine(seed, d))), 2 * d);
+    }
+
+    sample2 get_2d() override {
+	uint32_t d = dimension++;
+	uint32_t x, y;
+	owen_sobol_2d(sample_index, hash_combine(seed, d), x, y);
+	return { rotate(u32_to_unit(x), 2 * d), rotate(u32_to_unit(y), 2 * d + 1) };
+    }
+
+private:
+    uint32_t seed;
+    const blue_noise_mask& mask;
+    int pixel_x = 0, pixel_y = 0;
+    uint32_t sample_index = 0;
+    uint32_t dimension = 0;
+
+    // Cranley-Patterson rotation: 픽셀의 blue noise 값만큼 밀고 [0, 1)로 감음
+    // 성분마다 마스크를 R2 수열만큼 어긋나게 읽어서 성분끼리 상관관계 없게 함
+    double rotate(double value, uint32_t component) const {
+	int dx = int(blue_noise_mask::size * std::fmod(component * 0.7548776662466927, 1.0));
+	int dy = int(blue_noise_mask::size * std::fmod(component * 0.5698402909980532, 1.0));
+	double shifted = value + mask.value(pixel_x + dx, pixel_y + dy);
+	return shifted < 1.0 ? shifted : shifted - 1.0;
+    }
+};
+
+// ---------------------------------------------------------------------
+
+enum class sampler_type { random, owen_sobol, blue_noise };
+
+inline const char* sampler_name(sampler_type type) {
+    switch (type) {
+    case sampler_type::owen_sobol: return "owen_sobol";
+    case sampler_type::blue_noise: return "blue_noise";
+    default: return "random";
+    }
+}
+
+// 스레드마다 하나씩 만들어서 씀 (상태를 가지므로 공유 불가)
+inline std::unique_ptr<sampler> make_sampler(sampler_type type, uint32_t seed = 0) {
+    switch (type) {
+    case sampler_type::owen_sobol: return std::unique_ptr<sampler>(new owen_sobol_sampler(seed));
+    case sampler_type::blue_noise: return std::unique_ptr<sampler>(new blue_noise_sampler(seed));
+    default: return std::unique_ptr<sampler>(new random_sampler());
+    }
+}
+
+// 지금 스레드가 경로를 추적하는 데 쓰는 sampler (camera::ray_color에서 sampler_scope로 지정)
+// hit() / transmittance()로 sampler를 받지 않는 참여 매질(volume.h)이 거리 샘플링에 씀
+inline sampler*& active_sampler() {
+    thread_local sampler* current = nullptr;
+    return current;
+}
+
+// 범위 안에서 s를 현재 sampler로 지정 (끝나면 이전 값으로 되돌림)
+class sampler_scope {
+public:
+    explicit sampler_scope(sampler& s) : previous(active_sampler()) {
+	active_sampler() = &s;
+    }
+    ~sampler_scope() { active_sampler() = previous; }
+
+    sampler_scope(const sampler_scope&) = delete;
+    sampler_scope& operator=(const sampler_scope&) = delete;
+
+private:
+    sampler* previous;
+};
+
+// 현재 sampler의 다음 1D 값 (렌더 밖, 예를 들어 벤치마크에서 직접 부르면 random_double)
+inline double active_sample_1d() {
+    sampler* s = active_sampler();
+    return s ? s->get_1d() : random_double();
+}
+
+#endif
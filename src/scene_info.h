@@ -1,6 +1,8 @@
 ﻿#ifndef SCENE_INFO_H
 #define SCENE_INFO_H
 
+#include <cstddef>
+
 class scene_info {
 public:
     static size_t vertices;
@@ -0,0 +1,58 @@
+﻿// AVX2 커널: double 4개씩 처리
+// GCC/Clang은 -mavx2 -mfma, MSVC는 /arch:AVX2로 컴파일
+#include "../simd_types.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+
+namespace simd_avx2 {
+typedef __m256d vdouble;
+const int vwidth = 4;
+
+static inline vdouble vload(const double* p) { return _mm256_loadu_pd(p); }
+static inline void vstore(double* p, vdouble a) { _mm256_storeu_pd(p, a); }
+static inline vdouble vset(double x) { return _mm256_set1_pd(x); }
+static inline vdouble vadd(vdouble a, vdouble b) { return _mm256_add_pd(a, b); }
+static inline vdouble vsub(vdouble a, vdouble b) { return _mm256_sub_pd(a, b); }
+static inline vdouble vmul(vdouble a, vdouble b) { return _mm256_mul_pd(a, b); }
+static inline vdouble vdiv(vdouble a, vdouble b) { return _mm256_div_pd(a, b); }
+static inline vdouble vmin(vdouble a, vdouble b) { return _mm256_min_pd(a, b); }
+static inline vdouble vmax(vdouble a, vdouble b) { return _mm256_max_pd(a, b); }
+static inline vdouble vsqrt(vdouble a) { return _mm256_sqrt_pd(a); }
+static inline unsigned vgt(vdouble a, vdouble b) { return unsigned(_mm256_movemask_pd(_mm256_cmp_pd(a, b, _CMP_GT_OQ))); }
+static inline unsigned vge(vdouble a, vdouble b) { return unsigned(_mm256_movemask_pd(_mm256_cmp_pd(a, b, _CMP_GE_OQ))); }
+static inline unsigned vle(vdouble a, vdouble b) { return unsigned(_mm256_movemask_pd(_mm256_cmp_pd(a, b, _CMP_LE_OQ))); }
+
+typedef __m256 vfloat;
+const int vwidthf = 8;
+
+static inline vfloat vloadf(const float* p) { return _mm256_loadu_ps(p); }
+static inline void vstoref(float* p, vfloat a) { _mm256_storeu_ps(p, a); }
+static inline vfloat vsetf(float x) { return _mm256_set1_ps(x); }
+static inline vfloat vaddf(vfloat a, vfloat b) { return _mm256_add_ps(a, b); }
+static inline vfloat vsubf(vfloat a, vfloat b) { return _mm256_sub_ps(a, b); }
+static inline vfloat vmulf(vfloat a, vfloat b) { return _mm256_mul_ps(a, b); }
+static inline vfloat vdivf(vfloat a, vfloat b) { return _mm256_div_ps(a, b); }
+static inline unsigned vgtf(vfloat a, vfloat b) { return unsigned(_mm256_movemask_ps(_mm256_cmp_ps(a, b, _CMP_GT_OQ))); }
+static inline unsigned vgef(vfloat a, vfloat b) { return unsigned(_mm256_movemask_ps(_mm256_cmp_ps(a, b, _CMP_GE_OQ))); }
+static inline unsigned vlef(vfloat a, vfloat b) { return unsigned(_mm256_movemask_ps(_mm256_cmp_ps(a, b, _CMP_LE_OQ))); }
+
+#include "simd_kernels.inl"
+}
+
+static const simd_kernels kernels = {
+    "avx2", simd_avx2::vwidth,
+    simd_avx2::intersect_triangles,
+    simd_avx2::intersect_triangles_f32,
+    simd_avx2::intersect_spheres,
+    simd_avx2::perlin_fbm,
+    simd_avx2::linear_to_gamma_bytes,
+};
+
+const simd_kernels* simd_kernels_avx2() { return &kernels; }
+
+#else
+
+const simd_kernels* simd_kernels_avx2() { return nullptr; }
+
+#endif
@@ -0,0 +1,58 @@
+﻿// AVX-512 커널: double 8개씩 처리
+// GCC/Clang은 -mavx512f -mavx512dq, MSVC는 /arch:AVX512로 컴파일
+#include "../simd_types.h"
+
+#if defined(__AVX512F__) && defined(__AVX512DQ__)
+#include <immintrin.h>
+
+namespace simd_avx512 {
+typedef __m512d vdouble;
+const int vwidth = 8;
+
+static inline vdouble vload(const double* p) { return _mm512_loadu_pd(p); }
+static inline void vstore(double* p, vdouble a) { _mm512_storeu_pd(p, a); }
+static inline vdouble vset(double x) { return _mm512_set1_pd(x); }
+static inline vdouble vadd(vdouble a, vdouble b) { return _mm512_add_pd(a, b); }
+static inline vdouble vsub(vdouble a, vdouble b) { return _mm512_sub_pd(a, b); }
+static inline vdouble vmul(vdouble a, vdouble b) { return _mm512_mul_pd(a, b); }
+static inline vdouble vdiv(vdouble a, vdouble b) { return _mm512_div_pd(a, b); }
+static inline vdouble vmin(vdouble a, vdouble b) { return _mm512_min_pd(a, b); }
+static inline vdouble vmax(vdouble a, vdouble b) { return _mm512_max_pd(a, b); }
+static inline vdouble vsqrt(vdouble a) { return _mm512_sqrt_pd(a); }
+static inline unsigned vgt(vdouble a, vdouble b) { return unsigned(_mm512_cmp_pd_mask(a, b, _CMP_GT_OQ)); }
+static inline unsigned vge(vdouble a, vdouble b) { return unsigned(_mm512_cmp_pd_mask(a, b, _CMP_GE_OQ)); }
+static inline unsigned vle(vdouble a, vdouble b) { return unsigned(_mm512_cmp_pd_mask(a, b, _CMP_LE_OQ)); }
+
+typedef __m512 vfloat;
+const int vwidthf = 16;
+
+static inline vfloat vloadf(const float* p) { return _mm512_loadu_ps(p); }
+static inline void vstoref(float* p, vfloat a) { _mm512_storeu_ps(p, a); }
+static inline vfloat vsetf(float x) { return _mm512_set1_ps(x); }
+static inline vfloat vaddf(vfloat a, vfloat b) { return _mm512_add_ps(a, b); }
+static inline vfloat vsubf(vfloat a, vfloat b) { return _mm512_sub_ps(a, b); }
+static inline vfloat vmulf(vfloat a, vfloat b) { return _mm512_mul_ps(a, b); }
+static inline vfloat vdivf(vfloat a, vfloat b) { return _mm512_div_ps(a, b); }
+static inline unsigned vgtf(vfloat a, vfloat b) { return unsigned(_mm512_cmp_ps_mask(a, b, _CMP_GT_OQ)); }
+static inline unsigned vgef(vfloat a, vfloat b) { return unsigned(_mm512_cmp_ps_mask(a, b, _CMP_GE_OQ)); }
+static inline unsigned vlef(vfloat a, vfloat b) { return unsigned(_mm512_cmp_ps_mask(a, b, _CMP_LE_OQ)); }
+
+#include "simd_kernels.inl"
+}
+
+static const simd_kernels kernels = {
+    "avx512", simd_avx512::vwidth,
+    simd_avx512::intersect_triangles,
+    simd_avx512::intersect_triangles_f32,
+    simd_avx512::intersect_spheres,
+    simd_avx512::perlin_fbm,
+    simd_avx512::linear_to_gamma_bytes,
+};
+
+const simd_kernels* simd_kernels_avx512() { return &kernels; }
+
+#else
+
+const simd_kernels* simd_kernels_avx512() { return nullptr; }
+
+#endif
@@ -0,0 +1,326 @@
+﻿// SIMD 커널 본문
+// ISA별 TU(simd_*.cpp)에서 아래 타입과 연산을 정의한 뒤 namespace 안에서 include
+//
+//   vdouble                    double vwidth개를 담는 벡터 타입
+//   vload, vstore, vset        로드 / 스토어 / broadcast
+//   vadd, vsub, vmul, vdiv     사칙연산
+//   vmin, vmax, vsqrt          (NaN이 들어오면 vmax는 두 번째 인자를 리턴)
+//   vgt, vge, vle              비교 결과를 레인별 비트마스크(unsigned)로 리턴
+//   vfloat, vwidthf, v...f     float 버전 (vloadf, vstoref, vsetf, vaddf, vsubf, vmulf, vdivf, vgtf, vgef, vlef)
+//
+// 같은 코드가 ISA마다 다른 폭으로 컴파일되므로 여기서는 std 함수를 쓰지 않음
+
+// 레인 n개가 모두 켜진 마스크
+static inline unsigned lane_mask(int n) {
+    return n >= vwidth ? (1u << vwidth) - 1 : (1u << n) - 1;
+}
+
+static inline unsigned lane_maskf(int n) {
+    return n >= vwidthf ? (1u << vwidthf) - 1 : (1u << n) - 1;
+}
+
+// Möller-Trumbore ray-triangle 교차를 vwidth개 삼각형에 대해 동시에 수행
+// 정면(one-sided) 삼각형만 검사하는 것은 mesh_bvh_node의 스칼라 버전과 같음
+static int intersect_triangles(const triangle_soa& tris, size_t first, int count,
+    const simd_ray& r, double t_min, double t_max, triangle_hit& hit)
+{
+    const vdouble ox = vset(r.ox), oy = vset(r.oy), oz = vset(r.oz);
+    const vdouble dx = vset(r.dx), dy = vset(r.dy), dz = vset(r.dz);
+    const vdouble zero = vset(0.0), one = vset(1.0);
+    const vdouble epsilon = vset(2.2204460492503131e-16); // double epsilon
+    const vdouble tmin = vset(t_min);
+
+    int best = -1;
+    double best_t = t_max;
+    double best_u = 0, best_v = 0;
+
+    for (int base = 0; base < count; base += vwidth) {
+	size_t k = first + base;
+	unsigned valid = lane_mask(count - base);
+
+	vdouble e1x = vload(tris.e1x + k), e1y = vload(tris.e1y + k), e1z = vload(tris.e1z + k);
+	vdouble e2x = vload(tris.e2x + k), e2y = vload(tris.e2y + k), e2z = vload(tris.e2z + k);
+
+	// P = D x E2, det = P dot E1
+	vdouble px = vsub(vmul(dy, e2z), vmul(dz, e2y));
+	vdouble py = vsub(vmul(dz, e2x), vmul(dx, e2z));
+	vdouble pz = vsub(vmul(dx, e2y), vmul(dy, e2x));
+	vdouble det = vadd(vadd(vmul(px, e1x), vmul(py, e1y)), vmul(pz, e1z));
+
+	valid &= vgt(det, epsilon);
+	if (!valid) continue;
+
+	vdouble inv_det = vdiv(one, det);
+	vdouble tx = vsub(ox, vload(tris.v0x + k));
+	vdouble ty = vsub(oy, vload(tris.v0y + k));
+	vdouble tz = vsub(oz, vload(tris.v0z + k));
+
+	vdouble u = vmul(inv_det, vadd(vadd(vmul(px, tx), vmul(py, ty)), vmul(pz, tz)));
+	valid &= vge(u, zero) & vle(u, one);
+	if (!valid) continue;
+
+	// Q = T x E1
+	vdouble qx = vsub(vmul(ty, e1z), vmul(tz, e1y));
+	vdouble qy = vsub(vmul(tz, e1x), vmul(tx, e1z));
+	vdouble qz = vsub(vmul(tx, e1y), vmul(ty, e1x));
+
+	vdouble v = vmul(inv_det, vadd(vadd(vmul(qx, dx), vmul(qy, dy)), vmul(qz, dz)));
+	valid &= vge(v, zero) & vle(vadd(u, v), one);
+	if (!valid) continue;
+
+	vdouble t = vmul(inv_det, vadd(vadd(vmul(qx, e2x), vmul(qy, e2y)), vmul(qz, e2z)));
+	valid &= vge(t, tmin) & vle(t, vset(best_t));
+	if (!valid) continue;
+
+	// 살아남은 레인 중 가장 가까운 것 선택
+	double ts[vwidth], us[vwidth], vs[vwidth];
+	vstore(ts, t);
+	vstore(us, u);
+	vstore(vs, v);
+	for (int lane = 0; lane < vwidth; lane++) {
+	    if (((valid >> lane) & 1) && ts[lane] <= best_t) {
+		best = base + lane;
+		best_t = ts[lane];
+		best_u = us[lane];
+		best_v = vs[lane];
+	    }
+	}
+    }
+
+    if (best >= 0) {
+	hit.t = best_t;
+	hit.u = best_u;
+	hit.v = best_v;
+    }
+    return best;
+}
+
+// float 정점으로 같은 검사 (vwidthf개씩: AVX-512 16개, AVX2 8개)
+// 레이도 float로 바꿔서 계산하므로 t에 float 반올림 오차가 있음 -> 충돌 지점은 호출하는 쪽에서 barycentric으로 복원
+// det > 0만 통과 (패딩 칸의 det = 0 삼각형 제외, double 버전의 epsilon과 같은 역할)
+static int intersect_triangles_f32(const triangle_soa_f32& tris, size_t first, int count,
+    const simd_ray& r, double t_min, double t_max, triangle_hit& hit)
+{
+    const vfloat ox = vsetf(float(r.ox)), oy = vsetf(float(r.oy)), oz = vsetf(float(r.oz));
+    const vfloat dx = vsetf(float(r.dx)), dy = vsetf(float(r.dy)), dz = vsetf(float(r.dz));
+    const vfloat zero = vsetf(0.0f), one = vsetf(1.0f);
+    const vfloat tmin = vsetf(float(t_min));
+
+    int best = -1;
+    float best_t = t_max < 3.4e38 ? float(t_max) : 3.4e38f;
+    float best_u = 0, best_v = 0;
+
+    for (int base = 0; base < count; base += vwidthf) {
+	size_t k = first + base;
+	unsigned valid = lane_maskf(count - base);
+
+	vfloat e1x = vloadf(tris.e1x + k), e1y = vloadf(tris.e1y + k), e1z = vloadf(tris.e1z + k);
+	vfloat e2x = vloadf(tris.e2x + k), e2y = vloadf(tris.e2y + k), e2z = vloadf(tris.e2z + k);
+
+	// P = D x E2, det = P dot E1
+	vfloat px = vsubf(vmulf(dy, e2z), vmulf(dz, e2y));
+	vfloat py = vsubf(vmulf(dz, e2x), vmulf(dx, e2z));
+	vfloat pz = vsubf(vmulf(dx, e2y), vmulf(dy, e2x));
+	vfloat det = vaddf(vaddf(vmulf(px, e1x), vmulf(py, e1y)), vmulf(pz, e1z));
+
+	valid &= vgtf(det, zero);
+	if (!valid) continue;
+
+	vfloat inv_det = vdivf(one, det);
+	vfloat tx = vsubf(ox, vloadf(tris.v0x + k));
+	vfloat ty = vsubf(oy, vloadf(tris.v0y + k));
+	vfloat tz = vsubf(oz, vloadf(tris.v0z + k));
+
+	vfloat u = vmulf(inv_det, vaddf(vaddf(vmulf(px, tx), vmulf(py, ty)), vmulf(pz, tz)));
+	valid &= vgef(u, zero) & vlef(u, one);
+	if (!valid) continue;
+
+	// Q = T x E1
+	vfloat qx = vsubf(vmulf(ty, e1z), vmulf(tz, e1y));
+	vfloat qy = vsubf(vmulf(tz, e1x), vmulf(tx, e1z));
+	vfloat qz = vsubf(vmulf(tx, e1y), vmulf(ty, e1x));
+
+	vfloat v = vmulf(inv_det, vaddf(vaddf(vmulf(qx, dx), vmulf(qy, dy)), vmulf(qz, dz)));
+	valid &= vgef(v, zero) & vlef(vaddf(u, v), one);
+	if (!valid) continue;
+
+	vfloat t = vmulf(inv_det, vaddf(vaddf(vmulf(qx, e2x), vmulf(qy, e2y)), vmulf(qz, e2z)));
+	valid &= vgef(t, tmin) & vlef(t, vsetf(best_t));
+	if (!valid) continue;
+
+	// 살아남은 레인 중 가장 가까운 것 선택
+	float ts[vwidthf], us[vwidthf], vs[vwidthf];
+	vstoref(ts, t);
+	vstoref(us, u);
+	vstoref(vs, v);
+	for (int lane = 0; lane < vwidthf; lane++) {
+	    if (((valid >> lane) & 1) && ts[lane] <= best_t) {
+		best = base + lane;
+		best_t = ts[lane];
+		best_u = us[lane];
+		best_v = vs[lane];
+	    }
+	}
+    }
+
+    if (best >= 0) {
+	hit.t = best_t;
+	hit.u = best_u;
+	hit.v = best_v;
+    }
+    return best;
+}
+
+// vwidth개 구와 동시에 교차 검사
+// 판별식, 가까운 근 -> 범위 밖이면 먼 근 순서는 sphere::hit과 같음
+static int intersect_spheres(const sphere_soa& spheres, size_t first, int count,
+    const simd_ray& r, double time, double t_min, double t_max, double& hit_t)
+{
+    const vdouble ox = vset(r.ox), oy = vset(r.oy), oz = vset(r.oz);
+    const vdouble dx = vset(r.dx), dy = vset(r.dy), dz = vset(r.dz);
+    const vdouble zero = vset(0.0);
+    const vdouble tmin = vset(t_min);
+    const vdouble a = vset(r.dx * r.dx + r.dy * r.dy + r.dz * r.dz);
+    const vdouble inv_a = vset(1.0 / (r.dx * r.dx + r.dy * r.dy + r.dz * r.dz));
+    const bool moving = spheres.mx != nullptr;
+    const vdouble tv = vset(time);
+
+    int best = -1;
+    double best_t = t_max;
+
+    for (int base = 0; base < count; base += vwidth) {
+	size_t k = first + base;
+	unsigned valid = lane_mask(count - base);
+
+	vdouble cx = vload(spheres.cx + k), cy = vload(spheres.cy + k), cz = vload(spheres.cz + k);
+	if (moving) {
+	    cx = vadd(cx, vmul(tv, vload(spheres.mx + k)));
+	    cy = vadd(cy, vmul(tv, vload(spheres.my + k)));
+	    cz = vadd(cz, vmul(tv, vload(spheres.mz + k)));
+	}
+	vdouble rad = vload(spheres.radius + k);
+
+	// oc = C - Q, h = d dot oc, c = |oc|^2 - r^2
+	vdouble ocx = vsub(cx, ox), ocy = vsub(cy, oy), ocz = vsub(cz, oz);
+	vdouble h = vadd(vadd(vmul(dx, ocx), vmul(dy, ocy)), vmul(dz, ocz));
+	vdouble c = vsub(vadd(vadd(vmul(ocx, ocx), vmul(ocy, ocy)), vmul(ocz, ocz)), vmul(rad, rad));
+	vdouble disc = vsub(vmul(h, h), vmul(a, c));
+
+	valid &= vge(disc, zero);
+	if (!valid) continue;
+
+	vdouble sqrtd = vsqrt(vmax(disc, zero));
+	vdouble best_tv = vset(best_t);
+	vdouble near_root = vmul(vsub(h, sqrtd), inv_a);
+	vdouble far_root = vmul(vadd(h, sqrtd), inv_a);
+	unsigned near_ok = valid & vgt(near_root, tmin) & vgt(best_tv, near_root);
+	unsigned far_ok = valid & ~near_ok & vgt(far_root, tmin) & vgt(best_tv, far_root);
+	if (!(near_ok | far_ok)) continue;
+
+	double nears[vwidth], fars[vwidth];
+	vstore(nears, near_root);
+	vstore(fars, far_root);
+	for (int lane = 0; lane < vwidth; lane++) {
+	    double t = ((near_ok >> lane) & 1) ? nears[lane] : ((far_ok >> lane) & 1) ? fars[lane] : best_t;
+	    if (t < best_t) {
+		best = base + lane;
+		best_t = t;
+	    }
+	}
+    }
+
+    if (best >= 0)
+	hit_t = best_t;
+    return best;
+}
+
+// 옥타브마다 셀의 8개 꼭짓점 (순서: x + 2y + 4z)을 vwidth개씩 계산 (AVX-512는 한 번, AVX2는 두 번)
+// 축마다 가중치는 꼭짓점 좌표 c가 0이면 1 - s, 1이면 s = (1 - s) + c * (2s - 1)
+// 옥타브 합은 레인별로 모아 두었다가 마지막에 한 번만 더함
+static double perlin_fbm(const perlin_lattice& lattice, double x, double y, double z, int octaves) {
+    static const double corner_x[8] = { 0, 1, 0, 1, 0, 1, 0, 1 };
+    static const double corner_y[8] = { 0, 0, 1, 1, 0, 0, 1, 1 };
+    static const double corner_z[8] = { 0, 0, 0, 0, 1, 1, 1, 1 };
+    const unsigned char* perm = lattice.perm;
+
+    vdouble acc = vset(0.0);
+    double amplitude = 1.0;
+    for (int octave = 0; octave < octaves; octave++) {
+	// floor (std::floor 대신 버림 후 음수 보정)
+	double p[3] = { x, y, z }, f[3];
+	int cell[3];
+	for (int axis = 0; axis < 3; axis++) {
+	    int i = int(p[axis]);
+	    if (p[axis] < i) i--;
+	    f[axis] = p[axis] - i;
+	    cell[axis] = i & 255;
+	}
+
+	// 꼭짓점 gradient 모으기 (perm이 512바이트라 + 1 해도 넘치지 않음)
+	double gx[8], gy[8], gz[8];
+	for (int c = 0; c < 8; c++) {
+	    int h = perm[perm[perm[cell[0] + (c & 1)] + cell[1] + ((c >> 1) & 1)] + cell[2] + (c >> 2)] & 15;
+	    gx[c] = lattice.grad_x[h];
+	    gy[c] = lattice.grad_y[h];
+	    gz[c] = lattice.grad_z[h];
+	}
+
+	// Hermite fade (3t^2 - 2t^3)
+	double s[3];
+	for (int axis = 0; axis < 3; axis++)
+	    s[axis] = f[axis] * f[axis] * (3 - 2 * f[axis]);
+	const vdouble px = vset(f[0]), py = vset(f[1]), pz = vset(f[2]);
+	const vdouble wx0 = vset(amplitude * (1 - s[0])), wx1 = vset(amplitude * (2 * s[0] - 1));
+	const vdouble wy0 = vset(1 - s[1]), wy1 = vset(2 * s[1] - 1);
+	const vdouble wz0 = vset(1 - s[2]), wz1 = vset(2 * s[2] - 1);
+
+	for (int base = 0; base < 8; base += vwidth) {
+	    vdouble cx = vload(corner_x + base), cy = vload(corner_y + base), cz = vload(corner_z + base);
+	    vdouble dot = vadd(vadd(
+		vmul(vload(gx + base), vsub(px, cx)),
+		vmul(vload(gy + base), vsub(py, cy))),
+		vmul(vload(gz + base), vsub(pz, cz)));
+	    vdouble weight = vmul(vmul(
+		vadd(wx0, vmul(cx, wx1)),
+		vadd(wy0, vmul(cy, wy1))),
+		vadd(wz0, vmul(cz, wz1)));
+	    acc = vadd(acc, vmul(weight, dot));
+	}
+
+	x *= 2; y *= 2; z *= 2;
+	amplitude *= 0.5;
+    }
+
+    double lanes[vwidth];
+    vstore(lanes, acc);
+    double sum = 0;
+    for (int lane = 0; lane < vwidth; lane++)
+	sum += lanes[lane];
+    return sum;
+}
+
+// 감마 2 (sqrt) -> [0, 0.999] clamp -> 256배 후 버림
+// color.h의 linear_to_gamma + interval::clamp와 같은 결과
+static void linear_to_gamma_bytes(const double* linear, size_t n, unsigned char* out) {
+    const vdouble zero = vset(0.0), limit = vset(0.999), scale = vset(256.0);
+    double bytes[vwidth];
+
+    size_t i = 0;
+    for (; i + vwidth <= n; i += vwidth) {
+	vdouble g = vmin(vsqrt(vmax(vload(linear + i), zero)), limit);
+	vstore(bytes, vmul(g, scale));
+	for (int lane = 0; lane < vwidth; lane++)
+	    out[i + lane] = (unsigned char)(int)bytes[lane];
+    }
+
+    // 나머지는 0으로 채운 임시 버퍼에서 처리
+    if (i < n) {
+	double rest[vwidth] = {};
+	for (size_t j = i; j < n; j++)
+	    rest[j - i] = linear[j];
+	vdouble g = vmin(vsqrt(vmax(vload(rest), zero)), limit);
+	vstore(bytes, vmul(g, scale));
+	for (size_t j = i; j < n; j++)
+	    out[j] = (unsigned char)(int)bytes[j - i];
+    }
+}
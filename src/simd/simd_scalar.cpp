@@ -0,0 +1,50 @@
+﻿// 기본 커널: 컴파일러 기본 옵션 그대로, 모든 CPU에서 동작
+#include <cmath>
+
+#include "../simd_types.h"
+
+namespace simd_scalar {
+typedef double vdouble;
+const int vwidth = 1;
+
+static inline vdouble vload(const double* p) { return *p; }
+static inline void vstore(double* p, vdouble a) { *p = a; }
+static inline vdouble vset(double x) { return x; }
+static inline vdouble vadd(vdouble a, vdouble b) { return a + b; }
+static inline vdouble vsub(vdouble a, vdouble b) { return a - b; }
+static inline vdouble vmul(vdouble a, vdouble b) { return a * b; }
+static inline vdouble vdiv(vdouble a, vdouble b) { return a / b; }
+static inline vdouble vmin(vdouble a, vdouble b) { return a < b ? a : b; }
+static inline vdouble vmax(vdouble a, vdouble b) { return a > b ? a : b; }
+static inline vdouble vsqrt(vdouble a) { return std::sqrt(a); }
+static inline unsigned vgt(vdouble a, vdouble b) { return a > b ? 1u : 0u; }
+static inline unsigned vge(vdouble a, vdouble b) { return a >= b ? 1u : 0u; }
+static inline unsigned vle(vdouble a, vdouble b) { return a <= b ? 1u : 0u; }
+
+typedef float vfloat;
+const int vwidthf = 1;
+
+static inline vfloat vloadf(const float* p) { return *p; }
+static inline void vstoref(float* p, vfloat a) { *p = a; }
+static inline vfloat vsetf(float x) { return x; }
+static inline vfloat vaddf(vfloat a, vfloat b) { return a + b; }
+static inline vfloat vsubf(vfloat a, vfloat b) { return a - b; }
+static inline vfloat vmulf(vfloat a, vfloat b) { return a * b; }
+static inline vfloat vdivf(vfloat a, vfloat b) { return a / b; }
+static inline unsigned vgtf(vfloat a, vfloat b) { return a > b ? 1u : 0u; }
+static inline unsigned vgef(vfloat a, vfloat b) { return a >= b ? 1u : 0u; }
+static inline unsigned vlef(vfloat a, vfloat b) { return a <= b ? 1u : 0u; }
+
+#include "simd_kernels.inl"
+}
+
+static const simd_kernels kernels = {
+    "scalar", simd_scalar::vwidth,
+    simd_scalar::intersect_triangles,
+    simd_scalar::intersect_triangles_f32,
+    simd_scalar::intersect_spheres,
+    simd_scalar::perlin_fbm,
+    simd_scalar::linear_to_gamma_bytes,
+};
+
+const simd_kernels* simd_kernels_scalar() { return &kernels; }
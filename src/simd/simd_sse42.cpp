@@ -0,0 +1,58 @@
+﻿// SSE4.2 커널: double 2개씩 처리
+// GCC/Clang은 -msse4.2로 컴파일 (MSVC x64는 기본으로 SSE 명령어 사용 가능)
+#include "../simd_types.h"
+
+#if defined(__SSE4_2__) || (defined(_MSC_VER) && defined(_M_X64))
+#include <immintrin.h>
+
+namespace simd_sse42 {
+typedef __m128d vdouble;
+const int vwidth = 2;
+
+static inline vdouble vload(const double* p) { return _mm_loadu_pd(p); }
+static inline void vstore(double* p, vdouble a) { _mm_storeu_pd(p, a); }
+static inline vdouble vset(double x) { return _mm_set1_pd(x); }
+static inline vdouble vadd(vdouble a, vdouble b) { return _mm_add_pd(a, b); }
+static inline vdouble vsub(vdouble a, vdouble b) { return _mm_sub_pd(a, b); }
+static inline vdouble vmul(vdouble a, vdouble b) { return _mm_mul_pd(a, b); }
+static inline vdouble vdiv(vdouble a, vdouble b) { return _mm_div_pd(a, b); }
+static inline vdouble vmin(vdouble a, vdouble b) { return _mm_min_pd(a, b); }
+static inline vdouble vmax(vdouble a, vdouble b) { return _mm_max_pd(a, b); }
+static inline vdouble vsqrt(vdouble a) { return _mm_sqrt_pd(a); }
+static inline unsigned vgt(vdouble a, vdouble b) { return unsigned(_mm_movemask_pd(_mm_cmpgt_pd(a, b))); }
+static inline unsigned vge(vdouble a, vdouble b) { return unsigned(_mm_movemask_pd(_mm_cmpge_pd(a, b))); }
+static inline unsigned vle(vdouble a, vdouble b) { return unsigned(_mm_movemask_pd(_mm_cmple_pd(a, b))); }
+
+typedef __m128 vfloat;
+const int vwidthf = 4;
+
+static inline vfloat vloadf(const float* p) { return _mm_loadu_ps(p); }
+static inline void vstoref(float* p, vfloat a) { _mm_storeu_ps(p, a); }
+static inline vfloat vsetf(float x) { return _mm_set1_ps(x); }
+static inline vfloat vaddf(vfloat a, vfloat b) { return _mm_add_ps(a, b); }
+static inline vfloat vsubf(vfloat a, vfloat b) { return _mm_sub_ps(a, b); }
+static inline vfloat vmulf(vfloat a, vfloat b) { return _mm_mul_ps(a, b); }
+static inline vfloat vdivf(vfloat a, vfloat b) { return _mm_div_ps(a, b); }
+static inline unsigned vgtf(vfloat a, vfloat b) { return unsigned(_mm_movemask_ps(_mm_cmpgt_ps(a, b))); }
+static inline unsigned vgef(vfloat a, vfloat b) { return unsigned(_mm_movemask_ps(_mm_cmpge_ps(a, b))); }
+static inline unsigned vlef(vfloat a, vfloat b) { return unsigned(_mm_movemask_ps(_mm_cmple_ps(a, b))); }
+
+#include "simd_kernels.inl"
+}
+
+static const simd_kernels kernels = {
+    "sse42", simd_sse42::vwidth,
+    simd_sse42::intersect_triangles,
+    simd_sse42::intersect_triangles_f32,
+    simd_sse42::intersect_spheres,
+    simd_sse42::perlin_fbm,
+    simd_sse42::linear_to_gamma_bytes,
+};
+
+const simd_kernels* simd_kernels_sse42() { return &kernels; }
+
+#else
+
+const simd_kernels* simd_kernels_sse42() { return nullptr; }
+
+#endif
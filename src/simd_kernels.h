@@ -0,0 +1,52 @@
+﻿#ifndef SIMD_KERNELS_H
+#define SIMD_KERNELS_H
+
+// ISA별로 컴파일된 hot path 커널 모음
+// 같은 커널 코드(simd/simd_kernels.inl)를 scalar, SSE4.2, AVX2, AVX-512 옵션으로
+// 각각 컴파일해서 한 실행 파일에 모두 넣고, 시작할 때 cpuid로 가장 좋은 것을 고름
+//
+// 커널 TU는 다른 컴파일 옵션으로 빌드되므로 vec3, ray 같은 공용 헤더를 include하지 않음
+// (inline 함수가 ISA별로 여러 벌 생기면 링커가 아무거나 골라 ODR 문제가 생김)
+// -> simd_types.h에 정의된 POD 구조체만 주고 받음
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#include "cpu_features.h"
+#include "simd_types.h"
+
+// CPU가 지원하는 것 중 가장 넓은 커널 선택
+// 환경 변수 RT_SIMD(scalar, sse42, avx2, avx512)로 더 낮은 ISA를 강제할 수 있음
+inline const simd_kernels* select_simd_kernels() {
+    cpu_features features = detect_cpu_features();
+    const char* forced = std::getenv("RT_SIMD");
+
+    struct candidate { const simd_kernels* kernels; bool supported; };
+    candidate candidates[] = {
+	{ simd_kernels_avx512(), features.avx512 },
+	{ simd_kernels_avx2(), features.avx2 },
+	{ simd_kernels_sse42(), features.sse42 },
+	{ simd_kernels_scalar(), true },
+    };
+
+    for (const auto& c : candidates) {
+	if (c.kernels == nullptr || !c.supported)
+	    continue;
+	if (forced && std::strcmp(forced, c.kernels->name) != 0)
+	    continue;
+	return c.kernels;
+    }
+
+    if (forced)
+	std::cerr << "RT_SIMD=" << forced << " 사용 불가, scalar 커널 사용\n";
+    return simd_kernels_scalar();
+}
+
+// 프로그램 전체에서 사용할 커널 (처음 호출될 때 한 번 선택)
+inline const simd_kernels& simd() {
+    static const simd_kernels* kernels = select_simd_kernels();
+    return *kernels;
+}
+
+#endif
@@ -0,0 +1,97 @@
+﻿#ifndef SIMD_TYPES_H
+#define SIMD_TYPES_H
+
+// SIMD 커널과 주고 받는 POD 타입, 커널 테이블 선언
+// ISA별 커널 TU(simd/simd_*.cpp)는 이 헤더만 include함
+// inline 함수가 있는 헤더를 다른 컴파일 옵션의 TU에서 include하면
+// 링커가 AVX로 컴파일된 사본을 고를 수도 있으므로 여기에는 선언만 둠
+
+#include <cstddef>
+
+// 가장 넓은 SIMD 폭 (AVX-512 double 8개)
+// SoA 배열 끝은 이만큼 패딩해서 커널이 범위 밖을 읽어도 안전하게 함
+const int simd_max_width = 8;
+
+// SoA 형식 삼각형 배열
+// 정점 v0와 두 엣지 벡터 e1 = v1 - v0, e2 = v2 - v0
+struct triangle_soa {
+    const double* v0x; const double* v0y; const double* v0z;
+    const double* e1x; const double* e1y; const double* e1z;
+    const double* e2x; const double* e2y; const double* e2z;
+};
+
+// SoA 형식 구 배열
+// 중심은 시간 0의 중심 + time * 이동 벡터, 정적인 구만 있는 범위는 이동 벡터를 nullptr로 넘김
+struct sphere_soa {
+    const double* cx; const double* cy; const double* cz;
+    const double* mx; const double* my; const double* mz; // 이동 벡터 (nullptr 가능)
+    const double* radius;
+};
+
+// float 정점 SoA 배열 (정점 / 엣지 메모리가 double의 절반, SIMD 레인은 두 배)
+struct triangle_soa_f32 {
+    const float* v0x; const float* v0y; const float* v0z;
+    const float* e1x; const float* e1y; const float* e1z;
+    const float* e2x; const float* e2y; const float* e2z;
+};
+
+struct simd_ray {
+    double ox, oy, oz; // 시작점
+    double dx, dy, dz; // 방향
+};
+
+// 삼각형 교차 결과
+struct triangle_hit {
+    double t;
+    double u, v; // barycentric 좌표
+};
+
+// [first, first + count) 삼각형 중 (t_min, t_max) 안에서 가장 가까운 삼각형과 교차 검사
+// count는 simd_max_width 이하
+// 리턴: 가장 가까운 삼각형의 first 기준 오프셋, 없으면 -1
+typedef int (*intersect_triangles_fn)(const triangle_soa& tris, size_t first, int count,
+    const simd_ray& r, double t_min, double t_max, triangle_hit& hit);
+
+// float 정점 버전 (계산도 float), count는 2 * simd_max_width 이하
+// t_max가 float 범위를 넘으면 float 최댓값으로 자름
+typedef int (*intersect_triangles_f32_fn)(const triangle_soa_f32& tris, size_t first, int count,
+    const simd_ray& r, double t_min, double t_max, triangle_hit& hit);
+
+// [first, first + count) 구 중 (t_min, t_max) 안에서 가장 가까운 교차 검사 (sphere::hit과 같은 근 선택)
+// count는 제한 없음 (SIMD 폭 단위로 나눠 검사), time은 레이의 시간
+// 리턴: 가장 가까운 구의 first 기준 오프셋, 없으면 -1 (hit_t에 거리)
+typedef int (*intersect_spheres_fn)(const sphere_soa& spheres, size_t first, int count,
+    const simd_ray& r, double time, double t_min, double t_max, double& hit_t);
+
+// Perlin noise 격자 표
+// perm: 0~255 순열을 두 번 이어 붙인 512바이트, grad_x/y/z: gradient 16개 (해시 하위 4비트로 고름)
+struct perlin_lattice {
+    const unsigned char* perm;
+    const double* grad_x; const double* grad_y; const double* grad_z;
+};
+
+// 점 (x, y, z)에서 주파수를 두 배씩 올리고 진폭을 반씩 줄인 Perlin noise octaves개의 합 (fBm)
+// octaves = 1이면 noise 하나, 옥타브마다 셀의 8개 꼭짓점을 SIMD 레인에 나눠 계산
+typedef double (*perlin_fbm_fn)(const perlin_lattice& lattice, double x, double y, double z, int octaves);
+
+// 선형 공간 RGB 값 n개 -> 감마 2 적용 후 [0, 255] 바이트로 변환
+typedef void (*linear_to_gamma_bytes_fn)(const double* linear, size_t n, unsigned char* out);
+
+struct simd_kernels {
+    const char* name;
+    int width; // double 기준 SIMD 폭
+    intersect_triangles_fn intersect_triangles;
+    intersect_triangles_f32_fn intersect_triangles_f32;
+    intersect_spheres_fn intersect_spheres;
+    perlin_fbm_fn perlin_fbm;
+    linear_to_gamma_bytes_fn linear_to_gamma_bytes;
+};
+
+// 각 ISA 커널 테이블 (simd/simd_*.cpp)
+// 해당 ISA로 컴파일되지 않은 빌드에서는 nullptr 리턴
+const simd_kernels* simd_kernels_scalar();
+const simd_kernels* simd_kernels_sse42();
+const simd_kernels* simd_kernels_avx2();
+const simd_kernels* simd_kernels_avx512();
+
+#endif
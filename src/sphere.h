@@ -10,7 +10,9 @@ private:
     double radius;
     shared_ptr<material> mat;
     aabb bbox;
+    bool is_moving;
 
+public:
     // 구면 좌표계의 좌표를 uv 좌표계의 좌표로 변환
     static void get_sphere_uv(const point3& p, double& u, double& v) {
         // p: 원점이 중심인 단위 구 위의 한 점
@@ -26,12 +28,13 @@ private:
         u = phi / (2 * pi);
         v = theta / pi;
     }
-public:
+
     // 정적인 Sphere
     sphere(const point3& static_center, double radius, shared_ptr<material> mat) 
         : center(static_center, vec3(0, 0, 0)), 
         radius(std::fmax(0, radius)),
-        mat(mat) 
+        mat(mat),
+        is_moving(false)
     {
         auto rvec = vec3(radius, radius, radius);
         //bbox = aabb(center - rvec, center + rvec);
@@ -44,15 +47,62 @@ public:
         shared_ptr<material> mat)
         : center(center1, center2 - center1),
         radius(std::fmax(0, radius)),
-        mat(mat)
+        mat(mat),
+        is_moving(true)
     {
+        // 이동 방향에 음수 성분이 있어도 감싸도록 시작 / 끝 위치의 bbox를 합침
         auto rvec = vec3(radius, radius, radius);
-        bbox = aabb(center1 - rvec, center2 + rvec);
+        aabb box1(center1 - rvec, center1 + rvec);
+        aabb box2(center2 - rvec, center2 + rvec);
+        bbox = aabb(box1, box2);
     }
 
     bool hit(const ray& r, interval ray_t, hit_record& rec) const override {
-        // 구의 중심을 입력받은 레이가 부딪히는 시점의 시각 값으로 구함
-        point3 current_center = center.at(r.time());
+        RT_STAT_INC(sphere_tests);
+
+        // 구의 중심을 입력받은 레이가 부딪히는 시점의 시각 값으로 구함 (정적인 구는 보간 생략)
+        point3 current_center = is_moving ? center.at(r.time()) : center.origin();
+        double root;
+        if (!find_root(r, ray_t, current_center, root))
+            return false;
+
+        // 충돌 정보는 hit_record 객체에 레퍼런스로 전달
+        rec.t = root;
+        rec.p = r.at(rec.t);
+        rec.mat = mat;
+        vec3 outward_normal = (rec.p - current_center) / radius;
+        rec.set_face_normal(r, outward_normal); // 법선 벡터 방향 결정
+        get_sphere_uv(outward_normal, rec.u, rec.v);
+
+        return true; // 충돌 O
+    }
+
+    // 근만 구하고 법선 / uv는 계산하지 않음
+    bool occluded(const ray& r, interval ray_t) const override {
+        RT_STAT_INC(sphere_tests);
+        double root;
+        return find_root(r, ray_t, is_moving ? center.at(r.time()) : center.origin(), root);
+    }
+
+    // 구 바운딩 박스
+    aabb bounding_box() const override {
+        return bbox;
+    }
+
+    // 이동 + 균등 스케일은 중심과 반지름에 직접 적용 (회전은 uv가 바뀌므로 래퍼로 남김)
+    shared_ptr<hittable> bake_transform(const matrix4& m) const override {
+        double scale;
+        if (!m.is_uniform_scale_translation(scale))
+            return nullptr;
+        point3 center1 = m.transform_point(center.origin());
+        if (!is_moving)
+            return arena_make_shared<sphere>(center1, radius * scale, mat);
+        return arena_make_shared<sphere>(center1, m.transform_point(center.at(1)), radius * scale, mat);
+    }
+
+private:
+    // ray_t 안에서 가장 가까운 근 (hit / occluded 공용)
+    bool find_root(const ray& r, const interval& ray_t, const point3& current_center, double& root) const {
         vec3 oc = current_center - r.origin(); // C-Q
         auto a = r.direction().length_squared(); // d dot d == |d|^2
         auto h = dot(r.direction(), oc); // h = d dot (C-Q)
@@ -66,27 +116,13 @@ public:
         auto sqrtd = std::sqrt(discriminant);
 
         // tmin ~ tmax 사이에서 가장 가까운 교차 지점 찾기
-        auto root = (h - sqrtd) / a; // 이차방정식 근의 공식 -> +-라서 실근이 두 개 나오는데, 먼저 -부터 판별
+        root = (h - sqrtd) / a; // 이차방정식 근의 공식 -> +-라서 실근이 두 개 나오는데, 먼저 -부터 판별
         if (!ray_t.surrounds(root)) { // -로 판별한 실근이 범위를 벗어나는 경우
             root = (h + sqrtd) / a; // +로 실근 판별
             if (!ray_t.surrounds(root))
                 return false; // +- 둘 다 범위 벗어나는거면 실근 없음 -> 충돌 X
         }
-
-        // 충돌 정보는 hit_record 객체에 레퍼런스로 전달
-        rec.t = root;
-        rec.p = r.at(rec.t);
-        rec.mat = mat;
-        vec3 outward_normal = (rec.p - current_center) / radius;
-        rec.set_face_normal(r, outward_normal); // 법선 벡터 방향 결정
-        get_sphere_uv(outward_normal, rec.u, rec.v);
-
-        return true; // 충돌 O
-    }
-
-    // 구 바운딩 박스
-    aabb bounding_box() const override {
-        return bbox;
+        return true;
     }
 };
 
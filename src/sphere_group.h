@@ -0,0 +1,283 @@
+#ifndef SPHERE_GROUP_H
+#define SPHERE_GROUP_H
+
+// 구 수천~수만 개를 하나의 primitive로 묶은 그룹
+// 구를 하나씩 sphere 객체로 만들면 BVH 리프마다 가상 함수 호출 + 구 하나 검사이고,
+// sphere::hit은 맞을 때마다 acos/atan2로 uv까지 계산함
+// -> 중심/반지름을 SoA 배열로 모으고 내부 BVH 리프의 구들을 SIMD 커널로 한 번에 검사
+//    법선과 uv는 가장 가까운 구에 대해 마지막에 한 번만 계산
+//
+// 리프마다 움직이는 구가 있는지 표시해서, 정적인 구만 있는 리프는 시간 보간을 하지 않음
+// 사용법: add()로 구를 모두 넣은 뒤 build() 호출
+
+#include "sphere.h"
+
+#include <algorithm>
+#include <cstdint>
+
+// 리프 하나의 최대 구 개수 (AVX-512 기준 커널 안에서 두 번, AVX2 기준 네 번)
+// 구는 박스 검사보다 싸므로 메시 리프(8)보다 크게 잡아 노드 방문을 줄임 (8 -> 16: 10k개에서 약 25% 빠름)
+const int sphere_group_leaf_size = 16;
+
+class sphere_group : public hittable {
+public:
+    // 정적인 구
+    void add(const point3& center, double radius, shared_ptr<material> mat) {
+	add(center, center, radius, mat);
+    }
+
+    // 시간 0에 center1, 시간 1에 center2에 있는 구
+    void add(const point3& center1, const point3& center2, double radius, shared_ptr<material> mat) {
+	pending.push_back({ center1, center2 - center1, std::fmax(0, radius), int(add_material(mat)) });
+    }
+
+    size_t size() const { return spheres; }
+
+    // SoA 배열과 내부 BVH 만들기 (add()로 넣은 구 목록은 비움)
+    void build() {
+	nodes.clear();
+	spheres = 0;
+	if (pending.empty())
+	    return;
+
+	nodes.push_back(node()); // 루트
+	build_node(0, 0, pending.size());
+	bbox = nodes[0].box;
+
+	// BVH 순서대로 SoA 배열 저장
+	// 커널이 리프 끝을 넘어 SIMD 폭만큼 읽을 수 있으므로 0으로 패딩 (패딩 lane은 커널이 마스크로 제외)
+	spheres = pending.size();
+	size_t padded = spheres + simd_max_width;
+	for (auto* array : { &cx, &cy, &cz, &mx, &my, &mz, &radius })
+	    array->assign(padded, 0.0);
+	material_index.resize(spheres);
+	for (size_t i = 0; i < spheres; i++) {
+	    const entry& e = pending[i];
+	    cx[i] = e.center.x(); cy[i] = e.center.y(); cz[i] = e.center.z();
+	    mx[i] = e.motion.x(); my[i] = e.motion.y(); mz[i] = e.motion.z();
+	    radius[i] = e.radius;
+	    material_index[i] = e.mat;
+	}
+	pending.clear();
+	pending.shrink_to_fit();
+
+	static_view = { cx.data(), cy.data(), cz.data(), nullptr, nullptr, nullptr, radius.data() };
+	moving_view = { cx.data(), cy.data(), cz.data(), mx.data(), my.data(), mz.data(), radius.data() };
+    }
+
+    bool hit(const ray& r, interval ray_t, hit_record& rec) const override {
+	if (spheres == 0)
+	    return false;
+
+	const point3& o = r.origin();
+	const vec3& d = r.direction();
+	double inv[3] = { 1.0 / d.x(), 1.0 / d.y(), 1.0 / d.z() };
+	simd_ray sr = { o.x(), o.y(), o.z(), d.x(), d.y(), d.z() };
+
+	uint32_t stack[64];
+	int top = 0;
+
+	RT_STAT_INC(box_tests);
+	if (!slab_hit(nodes[0].box, o, inv, ray_t))
+	    return false;
+	stack[top++] = 0;
+
+	int hit_sphere = -1;
+	while (top > 0) {
+	    const node& n = nodes[stack[--top]];
+	    RT_STAT_INC(bvh_nodes_visited);
+
+	    if (n.count > 0) {
+		RT_STAT_ADD(sphere_tests, n.count);
+		double t;
+		int index = simd().intersect_spheres(n.moving ? moving_view : static_view,
+		    n.first, n.count, sr, r.time(), ray_t.min, ray_t.max, t);
+		if (index >= 0) {
+		    hit_sphere = int(n.first) + index;
+		    ray_t.max = t;
+		}
+		continue;
+	    }
+
+	    // 왼쪽 자식은 바로 다음 노드, 가까운 쪽을 먼저 꺼내도록 나중에 넣음
+	    uint32_t child[2] = { uint32_t(&n - &nodes[0]) + 1, n.right };
+	    double t_enter[2];
+	    bool child_hit[2];
+	    for (int c = 0; c < 2; c++) {
+		RT_STAT_INC(box_tests);
+		child_hit[c] = slab_hit(nodes[child[c]].box, o, inv, ray_t, &t_enter[c]);
+	    }
+
+	    int near = (child_hit[0] && child_hit[1] && t_enter[1] < t_enter[0]) ? 1 : 0;
+	    for (int k = 1; k >= 0; k--) {
+		int c = k == 0 ? near : 1 - near;
+		if (child_hit[c] && top < 64)
+		    stack[top++] = child[c];
+	    }
+	}
+
+	if (hit_sphere < 0)
+	    return false;
+
+	// 법선과 uv는 가장 가까운 구에 대해 한 번만 계산
+	size_t s = size_t(hit_sphere);
+	point3 center = point3(cx[s], cy[s], cz[s]) + r.time() * vec3(mx[s], my[s], mz[s]);
+	rec.t = ray_t.max;
+	rec.p = r.at(rec.t);
+	rec.mat = materials[material_index[s]];
+	vec3 outward_normal = (rec.p - center) / radius[s];
+	rec.set_face_normal(r, outward_normal);
+	sphere::get_sphere_uv(outward_normal, rec.u, rec.v);
+	return true;
+    }
+
+    // 처음 맞은 리프에서 끝 (법선 / uv 계산 없음, 자식 순서 / 구간 축소 없음)
+    bool occluded(const ray& r, interval ray_t) const override {
+	if (spheres == 0)
+	    return false;
+
+	const point3& o = r.origin();
+	const vec3& d = r.direction();
+	double inv[3] = { 1.0 / d.x(), 1.0 / d.y(), 1.0 / d.z() };
+	simd_ray sr = { o.x(), o.y(), o.z(), d.x(), d.y(), d.z() };
+
+	uint32_t stack[64];
+	int top = 0;
+
+	RT_STAT_INC(box_tests);
+	if (!slab_hit(nodes[0].box, o, inv, ray_t))
+	    return false;
+	stack[top++] = 0;
+
+	while (top > 0) {
+	    uint32_t index = stack[--top];
+	    const node& n = nodes[index];
+	    RT_STAT_INC(bvh_nodes_visited);
+
+	    if (n.count > 0) {
+		RT_STAT_ADD(sphere_tests, n.count);
+		double t;
+		if (simd().intersect_spheres(n.moving ? moving_view : static_view,
+		    n.first, n.count, sr, r.time(), ray_t.min, ray_t.max, t) >= 0)
+		    return true;
+		continue;
+	    }
+
+	    uint32_t child[2] = { index + 1, n.right };
+	    for (int c = 0; c < 2; c++) {
+		RT_STAT_INC(box_tests);
+		if (slab_hit(nodes[child[c]].box, o, inv, ray_t) && top < 64)
+		    stack[top++] = child[c];
+	    }
+	}
+	return false;
+    }
+
+    aabb bounding_box() const override {
+	return bbox;
+    }
+
+    size_t memory_bytes() const {
+	return sizeof(*this) + nodes.capacity() * sizeof(node)
+	    + 7 * cx.capacity() * sizeof(double)
+	    + material_index.capacity() * sizeof(uint32_t)
+	    + materials.capacity() * sizeof(shared_ptr<material>);
+    }
+
+private:
+    struct entry {
+	point3 center; // 시간 0의 중심
+	vec3 motion;   // 시간 1까지의 이동
+	double radius;
+	int mat;
+
+	aabb box() const {
+	    vec3 rvec(radius, radius, radius);
+	    return aabb(aabb(center - rvec, center + rvec),
+		aabb(center + motion - rvec, center + motion + rvec));
+	}
+    };
+
+    // count == 0: 내부 노드, 왼쪽 자식은 바로 다음 노드, 오른쪽 자식은 nodes[right]
+    // count > 0: 리프, [first, first + count) 범위의 구
+    struct node {
+	aabb box;
+	uint32_t right = 0;
+	uint32_t first = 0;
+	uint16_t count = 0;
+	bool moving = false;
+    };
+
+    std::vector<entry> pending; // build() 전까지 모아두는 구
+
+    std::vector<node> nodes;
+    std::vector<double> cx, cy, cz;  // 시간 0의 중심
+    std::vector<double> mx, my, mz;  // 이동 벡터
+    std::vector<double> radius;
+    std::vector<uint32_t> material_index;
+    std::vector<shared_ptr<material>> materials; // 같은 머티리얼은 한 번만 저장
+    size_t spheres = 0;
+    sphere_soa static_view = {};
+    sphere_soa moving_view = {};
+    aabb bbox;
+
+    size_t add_material(const shared_ptr<material>& mat) {
+	// 구를 추가할 때 보통 같은 머티리얼을 연달아 쓰므로 마지막 것만 비교
+	if (materials.empty() || materials.back() != mat)
+	    materials.push_back(mat);
+	return materials.size() - 1;
+    }
+
+    // nodes[index]에 [start, end) 범위의 트리를 만듦 (자식은 nodes 뒤에 추가)
+    void build_node(uint32_t index, size_t start, size_t end) {
+	aabb box = pending[start].box();
+	for (size_t i = start + 1; i < end; i++)
+	    box = aabb(box, pending[i].box());
+	nodes[index].box = box;
+
+	size_t size = end - start;
+	if (size <= size_t(sphere_group_leaf_size)) {
+	    nodes[index].first = uint32_t(start);
+	    nodes[index].count = uint16_t(size);
+	    for (size_t i = start; i < end; i++)
+		if (!pending[i].motion.near_zero())
+		    nodes[index].moving = true;
+	    return;
+	}
+
+	// 가장 긴 축의 중심 좌표 기준으로 반으로 나눔
+	int axis = box.get_longest_axis();
+	size_t mid = start + size / 2;
+	std::nth_element(pending.begin() + start, pending.begin() + mid, pending.begin() + end,
+	    [axis](const entry& a, const entry& b) {
+		return a.center[axis] + 0.5 * a.motion[axis] < b.center[axis] + 0.5 * b.motion[axis];
+	    });
+
+	nodes.push_back(node());
+	build_node(uint32_t(nodes.size() - 1), start, mid);
+	uint32_t right = uint32_t(nodes.size());
+	nodes[index].right = right;
+	nodes.push_back(node());
+	build_node(right, mid, end);
+    }
+
+    static bool slab_hit(const aabb& box, const point3& o, const double inv[3],
+	const interval& ray_t, double* t_enter = nullptr)
+    {
+	double t_min = ray_t.min, t_max = ray_t.max;
+	for (int axis = 0; axis < 3; axis++) {
+	    const interval& slab = box.get_axis_interval(axis);
+	    double t0 = (slab.min - o[axis]) * inv[axis];
+	    double t1 = (slab.max - o[axis]) * inv[axis];
+	    if (t0 > t1) std::swap(t0, t1);
+	    if (t0 > t_min) t_min = t0;
+	    if (t1 < t_max) t_max = t1;
+	    if (t_max < t_min)
+		return false;
+	}
+	if (t_enter) *t_enter = t_min;
+	return true;
+    }
+};
+
+#endif
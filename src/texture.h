@@ -2,6 +2,10 @@
 #define TEXTURE_H
 
 #include "rtw_stb_image.h"
+#include "sampler.h"
+
+#include <cstdint>
+#include <vector>
 
 // 텍스처 매핑 핵심 개념
 // 3D 표면점 -> 구면 좌표계 -> 텍스처 좌표계 -> 이미지 좌표계
@@ -40,8 +44,8 @@ public:
 	: inv_scale(1.0 / scale), even(even), odd(odd) { }
 
     checker_texture(double scale, const color& c1, const color& c2)
-	: checker_texture(scale, make_shared<solid_color>(c1), 
-	    make_shared<solid_color>(c2)) { }
+	: checker_texture(scale, arena_make_shared<solid_color>(c1), 
+	    arena_make_shared<solid_color>(c2)) { }
 
     color value(double u, double v, const point3& p) const override {
 	auto xInteger = int(std::floor(inv_scale * p.x()));
@@ -84,4 +88,182 @@ public:
     }
 };
 
+// Perlin gradient noise (improved noise 방식)
+// 정수 격자 꼭짓점마다 gradient를 정하고, 셀 안의 점은 8개 꼭짓점의 gradient dot (점 - 꼭짓점)을 보간
+// - 순열 표는 0~255를 섞은 바이트 256개를 두 번 이어 붙인 512바이트 (L1에 다 들어감)
+//   -> 축마다 & 255 한 번이면 perm[perm[perm[x] + y] + z]로 인덱스가 넘치지 않음
+// - gradient는 난수로 만들지 않고 정육면체 모서리 방향 12개(+ 4개 반복)로 고정, 해시 하위 4비트로 고름
+// - fBm은 꼭짓점 계산과 옥타브 반복을 simd().perlin_fbm 커널이 함 (fBm 하나당 커널 호출 한 번)
+//   옥타브 하나짜리 noise()는 커널 호출 비용이 더 커서 (약 20ns -> 28ns) 인라인 스칼라로 계산
+class perlin {
+public:
+    perlin(uint32_t seed = 1) {
+	for (int i = 0; i < 256; i++)
+	    perm[i] = uint8_t(i);
+
+	// Fisher-Yates 셔플 (seed가 같으면 항상 같은 표)
+	uint32_t state = seed;
+	for (int i = 255; i > 0; i--) {
+	    state = hash_u32(state + 0x9e3779b9U);
+	    int j = int(state % uint32_t(i + 1));
+	    std::swap(perm[i], perm[j]);
+	}
+	for (int i = 0; i < 256; i++)
+	    perm[256 + i] = perm[i];
+    }
+
+    // fBm: 주파수를 두 배씩 올리며 진폭을 반씩 줄인 noise를 octaves번 더함
+    double fbm(const point3& p, int octaves) const {
+	return simd().perlin_fbm(lattice(), p.x(), p.y(), p.z(), octaves);
+    }
+
+    double turb(const point3& p, int depth = 7) const {
+	return std::fabs(fbm(p, depth));
+    }
+
+    // 대략 [-1, 1] 범위의 값
+    double noise(const point3& p) const {
+	double f[3];
+	int cell[3];
+	for (int axis = 0; axis < 3; axis++) {
+	    double floor_p = std::floor(p[axis]);
+	    f[axis] = p[axis] - floor_p;
+	    cell[axis] = int(floor_p) & 255;
+	}
+
+	double s[3];
+	for (int axis = 0; axis < 3; axis++)
+	    s[axis] = f[axis] * f[axis] * (3 - 2 * f[axis]);
+
+	double accum = 0;
+	for (int c = 0; c < 8; c++) {
+	    int i = c & 1, j = (c >> 1) & 1, k = c >> 2;
+	    int h = perm[perm[perm[cell[0] + i] + cell[1] + j] + cell[2] + k] & 15;
+	    double weight = (i ? s[0] : 1 - s[0]) * (j ? s[1] : 1 - s[1]) * (k ? s[2] : 1 - s[2]);
+	    accum += weight * (grad_x[h] * (f[0] - i) + grad_y[h] * (f[1] - j) + grad_z[h] * (f[2] - k));
+	}
+	return accum;
+    }
+
+    // 커널 없이 같은 계산을 하는 스칼라 버전 (벤치마크 비교용)
+    double turb_scalar(const point3& p, int depth = 7) const {
+	double accum = 0;
+	point3 temp_p = p;
+	double weight = 1.0;
+	for (int i = 0; i < depth; i++) {
+	    accum += weight * noise(temp_p);
+	    weight *= 0.5;
+	    temp_p *= 2;
+	}
+	return std::fabs(accum);
+    }
+
+private:
+    static constexpr double grad_x[16] = { 1, -1, 1, -1, 1, -1, 1, -1, 0, 0, 0, 0, 1, 0, -1, 0 };
+    static constexpr double grad_y[16] = { 1, 1, -1, -1, 0, 0, 0, 0, 1, -1, 1, -1, 1, -1, 1, -1 };
+    static constexpr double grad_z[16] = { 0, 0, 0, 0, 1, 1, -1, -1, 1, 1, -1, -1, 0, 1, 0, -1 };
+
+    uint8_t perm[512];
+
+    // perlin이 복사돼도 항상 자기 표를 가리키도록 호출할 때마다 만듦
+    perlin_lattice lattice() const {
+	return { perm, grad_x, grad_y, grad_z };
+    }
+};
+
+// Perlin noise 기반 절차적 텍스처
+// noise: 부드러운 얼룩, turbulence: fBm 절댓값 (구름 / 연기), marble: z 방향 sin 줄무늬를 turbulence로 흔듦
+//
+// 노이즈를 많이 쓰는 장면에서는 bake()로 박스 안을 3D 격자에 미리 계산해 두면
+// value()가 옥타브 7개 대신 float 8개 삼선형 보간으로 끝남 (박스 밖은 그대로 직접 계산)
+class noise_texture : public texture {
+public:
+    enum class pattern { noise, turbulence, marble };
+
+    noise_texture(double scale, pattern kind = pattern::noise, const color& albedo = color(1, 1, 1),
+	uint32_t seed = 1)
+	: noise(seed), scale(scale), kind(kind), albedo(albedo) {}
+
+    color value(double u, double v, const point3& p) const override {
+	return albedo * intensity(p);
+    }
+
+    // box 안을 resolution^3 격자로 샘플링해 캐시 (격자 간격보다 작은 무늬는 뭉개지므로 scale에 맞춰 고를 것)
+    void bake(const aabb& box, int resolution) {
+	res = std::max(2, resolution);
+	bake_box = box;
+	cache.assign(size_t(res) * res * res, 0.0f);
+
+	for (int axis = 0; axis < 3; axis++) {
+	    const interval& extent = box.get_axis_interval(axis);
+	    origin[axis] = extent.min;
+	    cell_size[axis] = extent.size() / (res - 1);
+	    inv_cell[axis] = cell_size[axis] > 0 ? 1.0 / cell_size[axis] : 0;
+	}
+	for (int z = 0; z < res; z++)
+	    for (int y = 0; y < res; y++)
+		for (int x = 0; x < res; x++) {
+		    point3 p(origin[0] + x * cell_size[0], origin[1] + y * cell_size[1], origin[2] + z * cell_size[2]);
+		    cache[(size_t(z) * res + y) * res + x] = float(evaluate(p));
+		}
+    }
+
+    bool baked() const { return !cache.empty(); }
+
+    size_t memory_bytes() const {
+	return sizeof(*this) + cache.capacity() * sizeof(float);
+    }
+
+    // [0, 1] 범위의 밝기 (베이크된 캐시가 있으면 사용)
+    double intensity(const point3& p) const {
+	if (cache.empty())
+	    return evaluate(p);
+
+	int cell[3];
+	double f[3];
+	for (int axis = 0; axis < 3; axis++) {
+	    if (!bake_box.get_axis_interval(axis).contains(p[axis]))
+		return evaluate(p);
+	    double g = (p[axis] - origin[axis]) * inv_cell[axis];
+	    int i = std::min(int(g), res - 2);
+	    cell[axis] = i;
+	    f[axis] = g - i;
+	}
+
+	const float* c = &cache[(size_t(cell[2]) * res + cell[1]) * res + cell[0]];
+	size_t dy = size_t(res), dz = size_t(res) * res;
+	double x00 = c[0] + f[0] * (c[1] - c[0]);
+	double x10 = c[dy] + f[0] * (c[dy + 1] - c[dy]);
+	double x01 = c[dz] + f[0] * (c[dz + 1] - c[dz]);
+	double x11 = c[dz + dy] + f[0] * (c[dz + dy + 1] - c[dz + dy]);
+	double y0 = x00 + f[1] * (x10 - x00);
+	double y1 = x01 + f[1] * (x11 - x01);
+	return y0 + f[2] * (y1 - y0);
+    }
+
+    // 캐시 없이 직접 계산
+    double evaluate(const point3& p) const {
+	switch (kind) {
+	case pattern::turbulence:
+	    return std::fmin(1.0, noise.turb(scale * p));
+	case pattern::marble:
+	    return 0.5 * (1 + std::sin(scale * p.z() + 10 * noise.turb(p)));
+	default:
+	    return 0.5 * (1.0 + noise.noise(scale * p));
+	}
+    }
+
+private:
+    perlin noise;
+    double scale;
+    pattern kind;
+    color albedo;
+
+    // bake() 캐시: res^3개의 float, 격자점 (x, y, z) = origin + (x, y, z) * cell_size
+    std::vector<float> cache;
+    aabb bake_box;
+    int res = 0;
+    double origin[3] = {}, cell_size[3] = {}, inv_cell[3] = {};
+};
+
 #endif
\ No newline at end of file
@@ -0,0 +1,92 @@
+#ifndef TILE_DEPENDENCIES_H
+#define TILE_DEPENDENCIES_H
+
+// 타일별 의존성 추적 -> 씬을 조금 고친 뒤 영향받는 타일만 다시 렌더
+//
+// 타일을 렌더하면서 primary ray와 첫 반사 레이가 맞은 오브젝트 / 재질을 기록해 둠
+// 편집 내용(scene_edit)과 겹치는 타일만 누적 버퍼를 지우고 다시 렌더하고, 나머지 타일은 이전 결과를 그대로 씀
+// 두 번째 반사부터의 간접광 / 그림자 레이는 추적하지 않으므로 그만큼은 근사 (멀리 떨어진 물체의 색 번짐 등은 갱신되지 않음)
+
+#include "hittable.h"
+
+#include <algorithm>
+#include <vector>
+
+// 타일 하나의 렌더 결과에 영향을 준 것들
+struct tile_dependencies {
+    std::vector<const hittable*> objects;   // 월드 BVH 리프 (hit_record::object)
+    std::vector<const material*> materials;
+    bool background = false;                // 배경 / 환경 맵이 보이거나 조명으로 쓰임
+
+    void clear() {
+	objects.clear();
+	materials.clear();
+	background = false;
+	compacted_size = 0;
+    }
+
+    // 같은 오브젝트를 연속으로 맞는 경우가 대부분이라 바로 앞 값만 비교하고 넣은 뒤, 가끔 정렬 + 중복 제거
+    void add(const hit_record& rec) {
+	if (rec.object && (objects.empty() || objects.back() != rec.object))
+	    objects.push_back(rec.object);
+	const material* mat = rec.mat.get();
+	if (mat && (materials.empty() || materials.back() != mat))
+	    materials.push_back(mat);
+	if (objects.size() + materials.size() > 2 * compacted_size + 64)
+	    finish();
+    }
+
+    // 정렬 + 중복 제거 (타일이 끝날 때 호출, contains의 이진 탐색용)
+    void finish() {
+	compact(objects);
+	compact(materials);
+	compacted_size = objects.size() + materials.size();
+    }
+
+    bool contains(const hittable* object) const {
+	return std::binary_search(objects.begin(), objects.end(), object);
+    }
+    bool contains(const material* mat) const {
+	return std::binary_search(materials.begin(), materials.end(), mat);
+    }
+
+private:
+    size_t compacted_size = 0;
+
+    template <typename T>
+    static void compact(std::vector<T>& v) {
+	std::sort(v.begin(), v.end());
+	v.erase(std::unique(v.begin(), v.end()), v.end());
+    }
+};
+
+// 지금 스레드가 렌더 중인 타일의 의존성 기록 (camera::render_tile에서 설정, 나머지 렌더에서는 nullptr)
+inline tile_dependencies*& dependency_recorder() {
+    thread_local tile_dependencies* recorder = nullptr;
+    return recorder;
+}
+
+// 씬 편집 내용
+// 오브젝트를 옮기면 objects에 옮기기 전 오브젝트를, regions에 새 위치의 bbox를 넣음
+// (원래 보이지 않던 타일에 새로 나타나는 부분은 regions를 화면에 투영해서 찾음)
+struct scene_edit {
+    std::vector<const hittable*> objects;   // 바꾸거나 옮긴 오브젝트 (편집 전 월드 BVH 리프)
+    std::vector<const material*> materials; // 바꾼 재질
+    std::vector<aabb> regions;              // 새로 물체가 들어간 영역 (월드 공간)
+    bool background = false;                // 배경 / 환경 맵을 바꿈
+
+    // regions는 화면 위치가 필요하므로 camera::affected_tiles에서 따로 검사
+    bool affects(const tile_dependencies& deps) const {
+	if (background && deps.background)
+	    return true;
+	for (const hittable* object : objects)
+	    if (deps.contains(object))
+		return true;
+	for (const material* mat : materials)
+	    if (deps.contains(mat))
+		return true;
+	return false;
+    }
+};
+
+#endif
@@ -33,6 +33,45 @@ public:
     }
 
     bool hit(const ray& r, interval ray_t, hit_record& rec) const override {
+	RT_STAT_INC(triangle_tests);
+
+	double t;
+	if (!intersect(r, ray_t, t))
+	    return false;
+
+	// rec에 충돌 정보 담아서 리턴
+	rec.t = t;
+	rec.p = r.at(rec.t);
+	rec.mat = mat;
+
+	// 삼각형의 법선 벡터 -> 두 엣지 벡터 외적
+	vec3 outward_normal = unit_vector(cross(v1 - v0, v2 - v0));
+	rec.set_face_normal(r, outward_normal);
+
+	return true;
+    }
+
+    bool occluded(const ray& r, interval ray_t) const override {
+	RT_STAT_INC(triangle_tests);
+	double t;
+	return intersect(r, ray_t, t);
+    }
+
+    aabb bounding_box() const override {
+	return bbox;
+    }
+
+    // affine 변환은 세 정점에 직접 적용
+    // 거울 변환(det < 0)은 감김 방향이 바뀌어 one-sided 검사의 앞뒤가 달라지므로 래퍼로 남김
+    shared_ptr<hittable> bake_transform(const matrix4& m) const override {
+	if (!m.is_affine() || m.determinant3() <= 0)
+	    return nullptr;
+	return arena_make_shared<triangle>(m.transform_point(v0), m.transform_point(v1), m.transform_point(v2), mat);
+    }
+
+private:
+    // Moller-Trumbore 교차 검사, 맞으면 t에 거리 (hit / occluded 공용)
+    bool intersect(const ray& r, const interval& ray_t, double& t) const {
 	// 엣지 벡터 2개
 	vec3 edge1 = v1 - v0;
 	vec3 edge2 = v2 - v0;
@@ -72,28 +111,12 @@ public:
 	if (v < 0 || u + v > 1)
 	    return false;
 
-	double t = inv_det * dot(Q, edge2);
+	t = inv_det * dot(Q, edge2);
 
 	// t의 유효 범위 검사
 	// 교차점의 광선이 시작점보다 뒤에 있는 경우는 (t < 0 or t < ray_t.min)
 	// 유효한 충돌이 아님
-	if (!ray_t.contains(t))
-	    return false;
-
-	// rec에 충돌 정보 담아서 리턴
-	rec.t = t;
-	rec.p = r.at(rec.t);
-	rec.mat = mat;
-
-	// 삼각형의 법선 벡터 -> 두 엣지 벡터 외적
-	vec3 outward_normal = unit_vector(cross(edge1, edge2));
-	rec.set_face_normal(r, outward_normal);
-
-	return true;
-    }
-
-    aabb bounding_box() const override {
-	return bbox;
+	return ray_t.contains(t);
     }
 };
 
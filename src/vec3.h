@@ -1,44 +1,53 @@
 ﻿#ifndef VEC3_H
 #define VEC3_H
 
-class vec3 {
+// 스칼라 타입(double / float)으로 매개화한 3차원 벡터
+// 렌더러 대부분은 vec3 (= basic_vec3<double>)를 쓰고,
+// 메시 정점 / BVH 박스 / 프레임버퍼처럼 메모리 대역폭이 중요한 곳은 float 버전으로 저장할 수 있음
+template <typename T>
+class basic_vec3 {
     public:
-        double e[3];
+        typedef T value_type;
+        T e[3];
 
-        vec3() : e{0, 0, 0} {}
-        vec3(double e0, double e1, double e2) : e{e0, e1, e2} {}
+        basic_vec3() : e{0, 0, 0} {}
+        basic_vec3(T e0, T e1, T e2) : e{e0, e1, e2} {}
 
-        double x() const { return e[0]; }
-        double y() const { return e[1]; }
-        double z() const { return e[2]; }
+        // 다른 정밀도에서 변환 (float -> double은 정확, double -> float은 반올림)
+        template <typename U>
+        explicit basic_vec3(const basic_vec3<U>& v) : e{T(v.e[0]), T(v.e[1]), T(v.e[2])} {}
 
-        vec3 operator-() const { return vec3(-e[0], -e[1], -e[2]); }
-        double operator[](int i) const { return e[i]; }
-        double& operator[](int i) { return e[i]; }
+        T x() const { return e[0]; }
+        T y() const { return e[1]; }
+        T z() const { return e[2]; }
 
-        vec3& operator+=(const vec3& v) {
+        basic_vec3 operator-() const { return basic_vec3(-e[0], -e[1], -e[2]); }
+        T operator[](int i) const { return e[i]; }
+        T& operator[](int i) { return e[i]; }
+
+        basic_vec3& operator+=(const basic_vec3& v) {
             e[0] += v.e[0];
             e[1] += v.e[1];
             e[2] += v.e[2];
             return *this;
         }
 
-        vec3& operator*=(double t) {
+        basic_vec3& operator*=(T t) {
             e[0] *= t;
             e[1] *= t;
             e[2] *= t;
             return *this;
         }
 
-        vec3& operator/=(double t) {
+        basic_vec3& operator/=(T t) {
             return *this *= 1/t;
         }
 
-        double length() const {
+        T length() const {
             return std::sqrt(length_squared());
         }
 
-        double length_squared() const {
+        T length_squared() const {
             return e[0] * e[0] + e[1] * e[1] + e[2] * e[2];
         }
 
@@ -49,83 +58,146 @@ class vec3 {
         }
 
         // 랜덤 방향 벡터 생성
-        static vec3 random() {
-            return vec3(random_double(), random_double(), random_double());
+        static basic_vec3 random() {
+            return basic_vec3(T(random_double()), T(random_double()), T(random_double()));
         }
 
-        static vec3 random(double min, double max) {
-            return vec3(random_double(min, max), random_double(min, max), random_double(min, max));
+        static basic_vec3 random(double min, double max) {
+            return basic_vec3(T(random_double(min, max)), T(random_double(min, max)), T(random_double(min, max)));
         }
 };
 
+using vec3 = basic_vec3<double>;
+using vec3f = basic_vec3<float>;
+
 // point3를 vec3의 alias로 사용
 using point3 = vec3;
 
 // 벡터 유틸리티 함수
-inline std::ostream& operator<<(std::ostream& out, const vec3& v) {
+// 스칼라 인자는 value_type으로 받아서 (템플릿 인자 추론에서 제외) 2 * v처럼 int를 넣어도 변환됨
+template <typename T>
+inline std::ostream& operator<<(std::ostream& out, const basic_vec3<T>& v) {
     return out << v.e[0] << " " << v.e[1] << " " << v.e[2];
 }
 
-inline vec3 operator+(const vec3& u, const vec3& v) {
-    return vec3(u.e[0] + v.e[0], u.e[1] + v.e[1], u.e[2] + v.e[2]);
+template <typename T>
+inline basic_vec3<T> operator+(const basic_vec3<T>& u, const basic_vec3<T>& v) {
+    return basic_vec3<T>(u.e[0] + v.e[0], u.e[1] + v.e[1], u.e[2] + v.e[2]);
 }
 
-inline vec3 operator-(const vec3& u, const vec3& v) {
-    return vec3(u.e[0] - v.e[0], u.e[1] - v.e[1], u.e[2] - v.e[2]);
+template <typename T>
+inline basic_vec3<T> operator-(const basic_vec3<T>& u, const basic_vec3<T>& v) {
+    return basic_vec3<T>(u.e[0] - v.e[0], u.e[1] - v.e[1], u.e[2] - v.e[2]);
 }
 
-inline vec3 operator*(const vec3& u, const vec3& v) {
-    return vec3(u.e[0] * v.e[0], u.e[1] * v.e[1], u.e[2] * v.e[2]);
+template <typename T>
+inline basic_vec3<T> operator*(const basic_vec3<T>& u, const basic_vec3<T>& v) {
+    return basic_vec3<T>(u.e[0] * v.e[0], u.e[1] * v.e[1], u.e[2] * v.e[2]);
 }
 
-inline vec3 operator*(double t, const vec3& v) {
-    return vec3(t * v.e[0], t * v.e[1], t * v.e[2]);
+template <typename T>
+inline basic_vec3<T> operator*(typename basic_vec3<T>::value_type t, const basic_vec3<T>& v) {
+    return basic_vec3<T>(t * v.e[0], t * v.e[1], t * v.e[2]);
 }
 
-inline vec3 operator*(const vec3& v, double t) {
+template <typename T>
+inline basic_vec3<T> operator*(const basic_vec3<T>& v, typename basic_vec3<T>::value_type t) {
     return t * v;
 }
 
-inline vec3 operator/(const vec3& v, double t) {
+template <typename T>
+inline basic_vec3<T> operator/(const basic_vec3<T>& v, typename basic_vec3<T>::value_type t) {
     return (1/t) * v;
 }
 
-inline double dot(const vec3& u, const vec3& v) {
+template <typename T>
+inline T dot(const basic_vec3<T>& u, const basic_vec3<T>& v) {
     return u.e[0] * v.e[0] + u.e[1] * v.e[1] + u.e[2] * v.e[2];
 }
 
-inline vec3 cross(const vec3& u, const vec3& v) {
-    return vec3(u.e[1] * v.e[2] - u.e[2] * v.e[1],
+template <typename T>
+inline basic_vec3<T> cross(const basic_vec3<T>& u, const basic_vec3<T>& v) {
+    return basic_vec3<T>(u.e[1] * v.e[2] - u.e[2] * v.e[1],
                 u.e[2] * v.e[0] - u.e[0] * v.e[2],
                 u.e[0] * v.e[1] - u.e[1] * v.e[0]);
 }
 
-inline vec3 unit_vector(const vec3& v) {
+template <typename T>
+inline basic_vec3<T> unit_vector(const basic_vec3<T>& v) {
     return v / v.length();
 }
 
-// 1x1 직사각형에서 원 범위 안에 들어오는 랜덤 벡터 생성
+// [0, 1)^2 샘플 -> 방향 / 점 (닫힌 형태, 분기 없음)
+// 샘플을 직접 받으므로 stratified / low-discrepancy 샘플러와 같이 쓸 수 있음
+// 예전의 rejection sampling은 샘플마다 난수를 몇 개 쓸지 정해져 있지 않아서 (구: 평균 약 1.9번 시도)
+// 샘플러의 차원 순서가 어긋나고, 예측할 수 없는 분기가 셰이딩 경로 한가운데에 있었음
+
+// 각도 2 * pi * t의 sin, cos (샘플링용 근사, 오차 1e-9 이하)
+// std::sin + std::cos 호출 두 번이 매핑 비용의 대부분이라 분기 없는 다항식으로 대신함
+// [-pi, pi)로 감은 뒤 반각 h = x / 2 ([-pi/2, pi/2))에서 테일러 다항식으로 sin h, cos h를 구하고
+// 배각 공식 sin x = 2 sin h cos h, cos x = cos^2 h - sin^2 h
+inline void sin_cos_2pi(double t, double& sin_value, double& cos_value) {
+    t -= double(int64_t(t + 1024.5)) - 1024; // 가장 가까운 정수 빼기 -> [-0.5, 0.5)
+    double h = pi * t;
+    double h2 = h * h;
+    double s = h * (1 + h2 * (-1.0 / 6 + h2 * (1.0 / 120 + h2 * (-1.0 / 5040
+        + h2 * (1.0 / 362880 + h2 * (-1.0 / 39916800 + h2 * (1.0 / 6227020800.0)))))));
+    double c = 1 + h2 * (-1.0 / 2 + h2 * (1.0 / 24 + h2 * (-1.0 / 720 + h2 * (1.0 / 40320
+        + h2 * (-1.0 / 3628800 + h2 * (1.0 / 479001600 + h2 * (-1.0 / 87178291200.0)))))));
+    sin_value = 2 * s * c;
+    cos_value = c * c - s * s;
+}
+
+// 단위 구 위의 균일한 방향
+// z를 [-1, 1]에서 균일하게 고르면 구 면적도 균일 (아르키메데스의 원통 정리)
+inline vec3 sample_sphere(double u1, double u2) {
+    double z = 1 - 2 * u1;
+    double r = std::sqrt(std::fmax(0.0, 1 - z * z));
+    double sin_phi, cos_phi;
+    sin_cos_2pi(u2, sin_phi, cos_phi);
+    return vec3(r * cos_phi, r * sin_phi, z);
+}
+
+// 단위 원판 위의 균일한 점 (concentric mapping, Shirley & Chiu 1997)
+// 정사각형의 동심 사각형을 동심원으로 보내서 샘플 사이의 거리 비율이 잘 유지됨
+inline vec3 sample_concentric_disk(double u1, double u2) {
+    double a = 2 * u1 - 1;
+    double b = 2 * u2 - 1;
+    // |a| > |b|이면 (a, b), 아니면 (b, a) 쪽 삼각형 -> 분기 대신 0 / 1 가중치로 섞음
+    double x_major = double(a * a > b * b);
+    double r = b + x_major * (a - b);
+    double other = a + x_major * (b - a);
+    // |other| <= |r|이므로 r이 0이면 other도 0 -> 0으로 나누지 않게 분모만 바꿈
+    double ratio = other / (r + double(r == 0));
+    // 각도를 회전 수(2 * pi 단위)로: x_major면 ratio / 8, 아니면 1/4 - ratio / 8
+    double turns = 0.25 - ratio / 8 + x_major * (ratio / 4 - 0.25);
+    double sin_theta, cos_theta;
+    sin_cos_2pi(turns, sin_theta, cos_theta);
+    return vec3(r * cos_theta, r * sin_theta, 0);
+}
+
+// 법선 n 쪽 반구의 cosine 가중 방향 (Malley's method: 원판 위 균일한 점을 반구로 올림)
+// n 주변 직교 기저는 분기 없는 방법으로 만듦 (Duff et al. 2017)
+inline vec3 sample_cosine_hemisphere(const vec3& n, double u1, double u2) {
+    vec3 d = sample_concentric_disk(u1, u2);
+    double z = std::sqrt(std::fmax(0.0, 1 - d.x() * d.x() - d.y() * d.y()));
+
+    double sign = std::copysign(1.0, n.z());
+    double a = -1 / (sign + n.z());
+    double b = n.x() * n.y() * a;
+    vec3 t(1 + sign * n.x() * n.x() * a, sign * b, -sign * n.x());
+    vec3 bt(b, sign + n.y() * n.y() * a, -n.y());
+    return d.x() * t + d.y() * bt + z * n;
+}
+
+// 원판 안의 랜덤한 점
 inline vec3 random_in_unit_disk() {
-    while (true) {
-        auto p = vec3(random_double(-1, 1), random_double(-1, 1), 0);
-        if (p.length_squared() < 1)
-            return p;
-    }
+    return sample_concentric_disk(random_double(), random_double());
 }
 
-// 단위원을 감싸는 큐브 내에서 랜덤한 벡터 생성
-// 단위원 안에 있다면 accept -> normalize
-// 단위원 밖에 있다면 reject
+// 랜덤한 단위 벡터
 inline vec3 random_unit_vector() {
-    while (true) {
-        auto p = vec3::random(-1, 1); // 랜덤 벡터 
-        auto lensq = p.length_squared();
-        // 매우 작은 float는 제곱하면 0이 될 수 있음
-        // 1e-160보다 작은 수는 무시해서 sqrt(0)이 실행되지 않게 함
-        if (1e-160 < lensq && lensq <= 1) { // 벡터가 단위원 안에 있으면
-            return p / sqrt(lensq); // 정규화 (단위 벡터로 만듦)
-        }
-    }
+    return sample_sphere(random_double(), random_double());
 }
 
 // 법선 벡터와의 내적을 통해 올바른 hemisphere에 있는지 확인
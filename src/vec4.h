@@ -17,10 +17,9 @@ public:
     }
 
     // vec3을 vec4로 변환
-    vec4(const vec3& v3) : e{ v3.x(), v3.y(), v3.z(), 0.0 } {}
-
-    // point3을 vec4로 변환
-    vec4(const point3& p3) : e{ p3.x(), p3.y(), p3.z(), 1.0 } {}
+    // point3는 vec3의 alias라서 오버로딩으로 구분할 수 없으므로 w를 직접 받음
+    // 방향 벡터는 w = 0, 점은 w = 1
+    vec4(const vec3& v3, double w = 0.0) : e{ v3.x(), v3.y(), v3.z(), w } {}
 
     double x() const { return e[0]; }
     double y() const { return e[1]; }
@@ -113,4 +112,4 @@ inline vec4 operator/(const vec4& v, double t) {
     return (1 / t) * v;
 }
 
-#endif VEC4_H
\ No newline at end of file
+#endif
\ No newline at end of file
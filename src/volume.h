@@ -0,0 +1,351 @@
+#ifndef VOLUME_H
+#define VOLUME_H
+
+// 참여 매질 (안개, 연기)
+// constant_medium: 닫힌 경계 오브젝트 안을 균일한 밀도로 채움
+// grid_medium:     bbox 안의 3D 밀도 격자 (불균일)
+//
+// 불균일 매질의 거리 샘플링은 밀도 상한(majorant) mu로 가상의 균일 매질을 만들어 지수 분포로 걸음을 떼고
+// sigma / mu 확률로 실제 충돌로 받아들임 (delta tracking)
+// 상한이 실제 밀도보다 클수록 헛걸음이 많아지므로 격자를 거친 블록으로 나눠 블록마다 상한을 따로 두고,
+// 레이가 지나는 블록을 3D DDA로 차례로 방문하면서 상한이 0인 빈 블록은 걸음 없이 건너뜀
+// 그림자 레이는 충돌 한 번 대신 투과율을 추정 (ratio tracking: 걸음마다 1 - sigma / mu를 곱함)
+//
+// 매질도 bbox를 가진 hittable이므로 월드 BVH에 그대로 들어감
+// 난수는 active_sample_1d()로 렌더 중인 경로의 sampler에서 꺼냄 (sampler_seed가 같으면 같은 결과)
+// 산란은 isotropic 머티리얼, 흡수는 albedo에 포함됨
+
+#include "hittable.h"
+#include "material.h"
+
+#include <vector>
+
+// 충돌 지점의 hit_record (법선은 의미 없음)
+inline void set_medium_hit(const ray& r, double t, const shared_ptr<material>& phase_function, hit_record& rec) {
+    rec.t = t;
+    rec.p = r.at(t);
+    rec.normal = vec3(1, 0, 0);
+    rec.front_face = true;
+    rec.offset = 0;
+    rec.mat = phase_function;
+    rec.u = 0;
+    rec.v = 0;
+}
+
+class constant_medium : public hittable {
+public:
+    // density: 단위 길이당 소멸 계수
+    constant_medium(shared_ptr<hittable> boundary, double density, shared_ptr<texture> tex)
+	: boundary(boundary), density(density), neg_inv_density(-1 / density),
+	  phase_function(arena_make_shared<isotropic>(tex))
+    {
+    }
+
+    constant_medium(shared_ptr<hittable> boundary, double density, const color& albedo)
+	: boundary(boundary), density(density), neg_inv_density(-1 / density),
+	  phase_function(arena_make_shared<isotropic>(albedo))
+    {
+    }
+
+    bool hit(const ray& r, interval ray_t, hit_record& rec) const override {
+	double t_enter, t_exit;
+	if (!inside_span(r, ray_t, t_enter, t_exit))
+	    return false;
+
+	// 경계 안 거리 안에서 지수 분포로 충돌 거리 샘플링
+	double ray_length = r.direction().length();
+	double distance_inside = (t_exit - t_enter) * ray_length;
+	double hit_distance = neg_inv_density * std::log(active_sample_1d());
+	if (hit_distance > distance_inside)
+	    return false;
+
+	set_medium_hit(r, t_enter + hit_distance / ray_length, phase_function, rec);
+	return true;
+    }
+
+    // 균일 매질의 투과율은 exp(-density * 거리)로 정확히 계산
+    double transmittance(const ray& r, interval ray_t) const override {
+	double t_enter, t_exit;
+	if (!inside_span(r, ray_t, t_enter, t_exit))
+	    return 1.0;
+	return std::exp(-density * (t_exit - t_enter) * r.direction().length());
+    }
+
+    aabb bounding_box() const override { return boundary->bounding_box(); }
+
+private:
+    shared_ptr<hittable> boundary;
+    double density;
+    double neg_inv_density;
+    shared_ptr<material> phase_function;
+
+    // 레이가 경계 안에 있는 구간 (경계는 볼록하다고 가정, 레이 시작점이 안에 있어도 됨)
+    bool inside_span(const ray& r, const interval& ray_t, double& t_enter, double& t_exit) const {
+	hit_record rec1, rec2;
+	if (!boundary->hit(r, interval::universe, rec1))
+	    return false;
+	if (!boundary->hit(r, interval(rec1.t + 0.0001, infinity), rec2))
+	    return false;
+
+	t_enter = std::fmax(rec1.t, std::fmax(ray_t.min, 0.0));
+	t_exit = std::fmin(rec2.t, ray_t.max);
+	return t_enter < t_exit;
+    }
+};
+
+class grid_medium : public hittable {
+public:
+    // density: nx * ny * nz개 (x가 가장 빠르게 변함), 복셀 중심 값을 삼선형 보간
+    // sigma_scale: 밀도 1의 소멸 계수 (단위 길이당)
+    // block_size: majorant 블록 하나가 덮는 복셀 수 (축마다)
+    grid_medium(const aabb& box, int nx, int ny, int nz, std::vector<float> density,
+	double sigma_scale, shared_ptr<texture> albedo, int block_size = 8)
+	: box(box), nx(nx), ny(ny), nz(nz), density(std::move(density)), sigma_scale(sigma_scale),
+	  phase_function(arena_make_shared<isotropic>(albedo)), block_size(block_size)
+    {
+	build_majorants();
+    }
+
+    grid_medium(const aabb& box, int nx, int ny, int nz, std::vector<float> density,
+	double sigma_scale, const color& albedo, int block_size = 8)
+	: grid_medium(box, nx, ny, nz, std::move(density), sigma_scale,
+	    arena_make_shared<solid_color>(albedo), block_size)
+    {
+    }
+
+    // delta tracking: 첫 번째 실제 충돌
+    bool hit(const ray& r, interval ray_t, hit_record& rec) const override {
+	double ray_length = r.direction().length();
+	double hit_t = 0;
+	bool found = false;
+
+	traverse(r, ray_t, [&](double t, double t_exit, double mu) {
+	    if (mu <= 0)
+		return true; // 빈 블록
+	    double step_scale = 1.0 / (mu * ray_length);
+	    while (true) {
+		t -= std::log(1 - active_sample_1d()) * step_scale;
+		if (t >= t_exit)
+		    return true; // 다음 블록에서 이어서 (지수 분포는 memoryless)
+		if (active_sample_1d() * mu < sigma_at(r.at(t))) {
+		    hit_t = t;
+		    found = true;
+		    return false;
+		}
+	    }
+	});
+
+	if (!found)
+	    return false;
+	set_medium_hit(r, hit_t, phase_function, rec);
+	return true;
+    }
+
+    // ratio tracking: 가상 충돌마다 실제 충돌이 아닐 확률을 곱함
+    // 투과율이 작아지면 Russian roulette로 일찍 끝냄 (기댓값은 유지)
+    double transmittance(const ray& r, interval ray_t) const override {
+	double ray_length = r.direction().length();
+	double result = 1.0;
+
+	traverse(r, ray_t, [&](double t, double t_exit, double mu) {
+	    if (mu <= 0)
+		return true;
+	    double step_scale = 1.0 / (mu * ray_length);
+	    while (true) {
+		t -= std::log(1 - active_sample_1d()) * step_scale;
+		if (t >= t_exit)
+		    return true;
+		result *= 1 - sigma_at(r.at(t)) / mu;
+		if (result < 0.1) {
+		    double survive = std::fmax(result, 0.05);
+		    if (active_sample_1d() >= survive) {
+			result = 0;
+			return false;
+		    }
+		    result /= survive;
+		}
+	    }
+	});
+	return result;
+    }
+
+    aabb bounding_box() const override { return box; }
+
+    size_t memory_bytes() const {
+	return sizeof(*this) + density.capacity() * sizeof(float) + majorants.capacity() * sizeof(double);
+    }
+
+    // 전체 최대 소멸 계수 (블록 majorant 없이 하나만 쓸 때의 상한)
+    double global_majorant() const {
+	double result = 0;
+	for (double m : majorants)
+	    result = std::fmax(result, m);
+	return result;
+    }
+
+private:
+    aabb box;
+    int nx, ny, nz;
+    std::vector<float> density;
+    double sigma_scale;
+    shared_ptr<material> phase_function;
+
+    int block_size;
+    int bx = 0, by = 0, bz = 0;  // 블록 개수
+    std::vector<double> majorants; // 블록마다 sigma 상한 (sigma_scale 포함)
+
+    float voxel(int x, int y, int z) const {
+	return density[(size_t(z) * ny + y) * nx + x];
+    }
+
+    // 월드 좌표의 소멸 계수 (복셀 중심 기준 삼선형 보간, 격자 밖은 가장자리 값)
+    double sigma_at(const point3& p) const {
+	double g[3];
+	int size[3] = { nx, ny, nz };
+	int i0[3], i1[3];
+	double f[3];
+	for (int axis = 0; axis < 3; axis++) {
+	    const interval& slab = box.get_axis_interval(axis);
+	    g[axis] = (p[axis] - slab.min) / slab.size() * size[axis] - 0.5;
+	    double base = std::floor(g[axis]);
+	    f[axis] = g[axis] - base;
+	    int i = int(base);
+	    i0[axis] = std::max(0, std::min(size[axis] - 1, i));
+	    i1[axis] = std::max(0, std::min(size[axis] - 1, i + 1));
+	}
+
+	double c00 = voxel(i0[0], i0[1], i0[2]) * (1 - f[0]) + voxel(i1[0], i0[1], i0[2]) * f[0];
+	double c10 = voxel(i0[0], i1[1], i0[2]) * (1 - f[0]) + voxel(i1[0], i1[1], i0[2]) * f[0];
+	double c01 = voxel(i0[0], i0[1], i1[2]) * (1 - f[0]) + voxel(i1[0], i0[1], i1[2]) * f[0];
+	double c11 = voxel(i0[0], i1[1], i1[2]) * (1 - f[0]) + voxel(i1[0], i1[1], i1[2]) * f[0];
+	double c0 = c00 * (1 - f[1]) + c10 * f[1];
+	double c1 = c01 * (1 - f[1]) + c11 * f[1];
+	return sigma_scale * (c0 * (1 - f[2]) + c1 * f[2]);
+    }
+
+    // 블록 영역 안의 점은 블록 복셀과 양옆 한 칸씩의 복셀로만 보간되므로 그 범위의 최댓값이 상한
+    void build_majorants() {
+	bx = (nx + block_size - 1) / block_size;
+	by = (ny + block_size - 1) / block_size;
+	bz = (nz + block_size - 1) / block_size;
+	majorants.assign(size_t(bx) * by * bz, 0.0);
+
+	for (int k = 0; k < bz; k++)
+	    for (int j = 0; j < by; j++)
+		for (int i = 0; i < bx; i++) {
+		    float m = 0;
+		    for (int z = std::max(0, k * block_size - 1); z <= std::min(nz - 1, (k + 1) * block_size); z++)
+			for (int y = std::max(0, j * block_size - 1); y <= std::min(ny - 1, (j + 1) * block_size); y++)
+			    for (int x = std::max(0, i * block_size - 1); x <= std::min(nx - 1, (i + 1) * block_size); x++)
+				m = std::max(m, voxel(x, y, z));
+		    majorants[(size_t(k) * by + j) * bx + i] = m * sigma_scale;
+		}
+    }
+
+    // 레이가 지나는 majorant 블록을 가까운 순서로 방문 (3D DDA)
+    // 블록마다 f(블록에 들어가는 t, 나가는 t, 상한) 호출, f가 false를 리턴하면 중단
+    template <typename F>
+    void traverse(const ray& r, interval ray_t, F&& f) const {
+	// 블록 격자 좌표계 (블록 하나 = 1)로 레이 변환, t는 그대로
+	int blocks[3] = { bx, by, bz };
+	double o[3], d[3];
+	double t_min = std::fmax(ray_t.min, 0.0), t_max = ray_t.max;
+	for (int axis = 0; axis < 3; axis++) {
+	    const interval& slab = box.get_axis_interval(axis);
+	    int cells = (axis == 0 ? nx : axis == 1 ? ny : nz);
+	    double block_world = slab.size() * block_size / cells;
+	    o[axis] = (r.origin()[axis] - slab.min) / block_world;
+	    d[axis] = r.direction()[axis] / block_world;
+
+	    // 격자 전체 [0, blocks]와의 slab 검사 (마지막 블록은 격자 밖까지 걸칠 수 있음)
+	    double extent = double(cells) / block_size;
+	    double inv = 1.0 / d[axis];
+	    double t0 = (0 - o[axis]) * inv;
+	    double t1 = (extent - o[axis]) * inv;
+	    if (t0 > t1) std::swap(t0, t1);
+	    t_min = std::fmax(t_min, t0);
+	    t_max = std::fmin(t_max, t1);
+	}
+	if (t_min >= t_max)
+	    return;
+
+	int cell[3], step[3];
+	double t_next[3], t_delta[3];
+	for (int axis = 0; axis < 3; axis++) {
+	    double p = o[axis] + t_min * d[axis];
+	    cell[axis] = std::max(0, std::min(blocks[axis] - 1, int(std::floor(p))));
+	    if (d[axis] > 0) {
+		step[axis] = 1;
+		t_next[axis] = (cell[axis] + 1 - o[axis]) / d[axis];
+		t_delta[axis] = 1 / d[axis];
+	    }
+	    else if (d[axis] < 0) {
+		step[axis] = -1;
+		t_next[axis] = (cell[axis] - o[axis]) / d[axis];
+		t_delta[axis] = -1 / d[axis];
+	    }
+	    else {
+		step[axis] = 0;
+		t_next[axis] = infinity;
+		t_delta[axis] = infinity;
+	    }
+	}
+
+	double t = t_min;
+	while (t < t_max) {
+	    int axis = (t_next[0] < t_next[1])
+		? (t_next[0] < t_next[2] ? 0 : 2)
+		: (t_next[1] < t_next[2] ? 1 : 2);
+	    double t_exit = std::fmin(t_next[axis], t_max);
+
+	    double mu = majorants[(size_t(cell[2]) * by + cell[1]) * bx + cell[0]];
+	    if (t_exit > t && !f(t, t_exit, mu))
+		return;
+
+	    t = t_exit;
+	    cell[axis] += step[axis];
+	    if (cell[axis] < 0 || cell[axis] >= blocks[axis])
+		return;
+	    t_next[axis] += t_delta[axis];
+	}
+    }
+};
+
+// 파일 없이 쓰는 간단한 연기 밀도 격자 (n^3): 가우시안 덩어리 blobs개를 합친 뒤 [0, 1]로 자름
+// 덩어리 밖은 정확히 0이라 majorant 블록의 빈 공간 건너뛰기가 잘 드러남
+inline std::vector<float> procedural_smoke(int n, int blobs, uint32_t seed = 1) {
+    std::vector<float> grid(size_t(n) * n * n, 0.0f);
+    uint32_t state = seed;
+    auto next = [&]() {
+	state = hash_u32(state + 0x9e3779b9U);
+	return u32_to_unit(state);
+    };
+
+    for (int b = 0; b < blobs; b++) {
+	double c[3];
+	c[0] = 0.2 + 0.6 * next();
+	c[1] = 0.15 + 0.5 * next();
+	c[2] = 0.2 + 0.6 * next();
+	double radius = 0.06 + 0.1 * next();
+	double peak = 0.5 + next();
+
+	int lo[3], hi[3];
+	for (int axis = 0; axis < 3; axis++) {
+	    lo[axis] = std::max(0, int((c[axis] - 2 * radius) * n));
+	    hi[axis] = std::min(n - 1, int((c[axis] + 2 * radius) * n));
+	}
+	for (int z = lo[2]; z <= hi[2]; z++)
+	    for (int y = lo[1]; y <= hi[1]; y++)
+		for (int x = lo[0]; x <= hi[0]; x++) {
+		    double dx = (x + 0.5) / n - c[0], dy = (y + 0.5) / n - c[1], dz = (z + 0.5) / n - c[2];
+		    double r2 = (dx * dx + dy * dy + dz * dz) / (radius * radius);
+		    if (r2 < 4)
+			grid[(size_t(z) * n + y) * n + x] += float(peak * std::exp(-2 * r2));
+		}
+    }
+    for (auto& value : grid)
+	value = std::min(value, 1.0f);
+    return grid;
+}
+
+#endif